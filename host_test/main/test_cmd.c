@@ -0,0 +1,42 @@
+// 命令注册表参数写入测试：非有限值与超出范围的整数在转换前被拒绝
+#include "unity.h"
+#include "cmd/cmd_registry.h"
+#include <math.h>
+
+static float s_test_float = 1.0f;
+static float s_test_int = 3.0f;
+
+static void test_cmd_register(void)
+{
+    static bool registered = false;
+    if (registered) return;
+    registered = true;
+    cmd_register_param(&(cmd_param_t){ .name = "t_float", .type = CMD_PARAM_FLOAT, .min = 0.0f, .max = 10.0f, .value = &s_test_float });
+    cmd_register_param(&(cmd_param_t){ .name = "t_int", .type = CMD_PARAM_INT, .min = 0.0f, .max = 10.0f, .value = &s_test_int });
+}
+
+TEST_CASE("param write rejects non-finite values", "[cmd]")
+{
+    test_cmd_register();
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, cmd_param_set("t_float", NAN));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, cmd_param_set("t_float", INFINITY));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, cmd_param_set("t_int", NAN));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, cmd_param_set("t_int", -INFINITY));
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, s_test_float);
+    TEST_ASSERT_EQUAL_FLOAT(3.0f, s_test_int);
+
+    char reply[CMD_REPLY_SIZE];
+    cmd_dispatch("set t_float=nan", reply, sizeof(reply));
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, s_test_float);
+}
+
+TEST_CASE("int param is range checked before rounding", "[cmd]")
+{
+    test_cmd_register();
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, cmd_param_set("t_int", 1e20f));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, cmd_param_set("t_int", -1e20f));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, cmd_param_set("t_int", 10.6f));
+    TEST_ASSERT_EQUAL_FLOAT(3.0f, s_test_int);
+    TEST_ASSERT_EQUAL(ESP_OK, cmd_param_set("t_int", 9.6f));
+    TEST_ASSERT_EQUAL_FLOAT(10.0f, s_test_int);
+}
@@ -0,0 +1,47 @@
+// 滤波器整块接口与逐样本接口的一致性测试
+#include "unity.h"
+#include "filter/filter_control.h"
+#include <string.h>
+
+#define TEST_LEN  1000
+
+static float s_in[TEST_LEN];
+static float s_ref[TEST_LEN];
+static float s_out[TEST_LEN];
+
+// 带尖峰的锯齿波，固定种子保证可重复
+static void make_signal(float *x, int len)
+{
+    uint32_t seed = 1;
+    for (int i = 0; i < len; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        x[i] = (float)(i % 17) * 0.25f + (float)(seed >> 20) * 1e-3f;
+        if ((seed >> 28) == 0) x[i] += 50.0f;
+    }
+}
+
+// 分段长度不规则的整块处理（含原地处理）必须与逐样本结果一致，之后逐样本接口接着用也一致
+TEST_CASE("median block matches per-sample path", "[filter]")
+{
+    static const int chunks[] = {1, 2, 7, 64, 65, 130, 3};
+    make_signal(s_in, TEST_LEN);
+    for (int size = 1; size <= FILTER_MEDIAN_MAX; size += 2) {
+        filter_median_t ref, blk;
+        filter_median_init(&ref, size);
+        filter_median_init(&blk, size);
+        for (int i = 0; i < TEST_LEN; ++i) s_ref[i] = filter_median_process(&ref, s_in[i]);
+
+        memcpy(s_out, s_in, sizeof(s_out));
+        int pos = 0;
+        for (int c = 0; pos < TEST_LEN - 100; c = (c + 1) % (int)(sizeof(chunks) / sizeof(chunks[0]))) {
+            int n = chunks[c];
+            filter_median_process_block(&blk, &s_out[pos], &s_out[pos], n);
+            pos += n;
+        }
+        for (; pos < TEST_LEN; ++pos) s_out[pos] = filter_median_process(&blk, s_in[pos]);
+
+        for (int i = 0; i < TEST_LEN; ++i) {
+            TEST_ASSERT_EQUAL_FLOAT(s_ref[i], s_out[i]);
+        }
+    }
+}
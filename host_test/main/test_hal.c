@@ -0,0 +1,50 @@
+// Linux 硬件抽象层测试：INA226 驱动经 I2C HAL 读取仿真被控对象
+#include "unity.h"
+#include "i2c/i2c_control.h"
+#include "i2c_ina226_driver/i2c_ina226_driver.h"
+#include "sim/sim_plant.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#define TEST_SETTLE_MS   500   // 远大于 LC 的衰减时间常数 2RC ≈ 4.4 ms
+#define TEST_POLL_MS     10    // 仿真按真实时间推进，单次最多追赶 SIM_PLANT_MAX_CATCHUP_US，需要持续读取
+
+// 开环 50% 占空比：稳态输出为 D × Vin，电流为 V / R
+TEST_CASE("ina226 driver reads the simulated plant through the i2c hal", "[hal]")
+{
+    i2c_init(I2C_INA226_NUM, GPIO_NUM_NC, GPIO_NUM_NC);
+    TEST_ASSERT_EQUAL(ESP_OK, ina226_init());
+    sim_plant_set_vin(24.0f);
+    sim_plant_set_load(SIM_PLANT_LOAD_OHMS);
+    sim_plant_set_duty(50.0f);
+
+    ina226_data_t data = {0};
+    for (int t = 0; t < TEST_SETTLE_MS; t += TEST_POLL_MS) {
+        vTaskDelay(pdMS_TO_TICKS(TEST_POLL_MS));
+        TEST_ASSERT_EQUAL(ESP_OK, ina226_read_all(&data));
+    }
+    TEST_ASSERT_DOUBLE_WITHIN(0.05, 12.0, data.bus_voltage_v);
+    TEST_ASSERT_DOUBLE_WITHIN(10.0, 12.0 / SIM_PLANT_LOAD_OHMS * 1000.0, data.current_ma);
+
+    sim_plant_set_duty(0.0f);
+}
+
+// 总线上没有的地址返回无应答，并计入该设备的失败次数
+TEST_CASE("i2c hal nacks absent devices", "[hal]")
+{
+    const uint8_t absent = 0x11;
+    uint8_t byte = 0;
+    i2c_init(I2C_NUM_0, GPIO_NUM_NC, GPIO_NUM_NC);
+    TEST_ASSERT_FALSE(i2c_read(I2C_NUM_0, absent, &byte, 1) == ESP_OK);
+
+    i2c_stats_t st;
+    bool found = false;
+    for (int i = 0; i2c_get_stats(i, &st); ++i) {
+        if (st.i2c_num == I2C_NUM_0 && st.addr == absent) {
+            found = true;
+            TEST_ASSERT_EQUAL_UINT32(1, st.transactions);
+            TEST_ASSERT_EQUAL_UINT32(1, st.failures);
+        }
+    }
+    TEST_ASSERT_TRUE(found);
+}
@@ -0,0 +1,11 @@
+// 主机单元测试入口：运行所有 TEST_CASE，失败数作为进程退出码
+#include "unity.h"
+#include <stdlib.h>
+
+void app_main(void)
+{
+    UNITY_BEGIN();
+    unity_run_all_tests();
+    int failures = UNITY_END();
+    exit(failures);
+}
@@ -0,0 +1,82 @@
+// PID 前馈测试：复位后前馈渐入，运行中切换拓扑时闭环输出不跳变
+#include "unity.h"
+#include "pid/pid_control.h"
+
+#define TEST_VIN        24.0f
+#define TEST_SETPOINT   12.0f
+#define TEST_FF_BUCK    50.0f   // buck 前馈 Vref / Vin
+#define TEST_HOLD_TICKS 3000    // 每段闭环运行 3 s
+#define TEST_DUTY_TOL   0.01f   // 积分项移到限幅附近后单精度的舍入不同，两条轨迹有微小差别
+
+// 只保留前馈：测量值等于目标值，误差为 0，比例与积分都不出力
+static void test_pid_setup(pid_handle_t *pid, float *measured, float *duty, float *vin)
+{
+    *measured = TEST_SETPOINT;
+    *duty = 0.0f;
+    *vin = TEST_VIN;
+    pid_init(pid, TEST_SETPOINT, duty, measured);
+    pid->kp = 0.0f;
+    pid->ki = 0.0f;
+    pid_set_feedforward(pid, PID_FF_BUCK, vin);
+}
+
+// 理想 buck 的静态模型：输出电压 = 占空比 × 输入电压
+static void test_pid_closed_loop_tick(pid_handle_t *pid, float *measured, const float *duty, float vin)
+{
+    pid_timer_isr(pid);
+    *measured = *duty / 100.0f * vin;
+}
+
+TEST_CASE("feedforward ramps in after reset", "[pid]")
+{
+    pid_handle_t pid;
+    float measured, duty, vin;
+    test_pid_setup(&pid, &measured, &duty, &vin);
+    const int ramp_ticks = (int)(PID_FF_RAMP_S / pid.period_s + 0.5f);
+
+    for (int i = 0; i < ramp_ticks + 10; ++i) pid_timer_isr(&pid);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-3, TEST_FF_BUCK, duty);
+
+    pid_reset(&pid);
+    pid_timer_isr(&pid);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-3, TEST_FF_BUCK / ramp_ticks, duty);
+    for (int i = 1; i < ramp_ticks / 2; ++i) pid_timer_isr(&pid);
+    TEST_ASSERT_DOUBLE_WITHIN(0.5, TEST_FF_BUCK / 2, duty);
+    for (int i = ramp_ticks / 2; i < ramp_ticks + 10; ++i) pid_timer_isr(&pid);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-3, TEST_FF_BUCK, duty);
+}
+
+// 闭环运行中切换拓扑，前馈跳变约 50%：ki 正常时全部折进积分项，ki 很小时超出积分限幅的部分
+// 与 ki 为 0 时的全部跳变留在不衰减的 ff_bias 中。与不切换的同一闭环逐周期对比，占空比应完全一致
+TEST_CASE("topology switch keeps the closed-loop output constant", "[pid]")
+{
+    static const float kis[] = { PID_KI, 0.1f, 0.0f };
+    for (size_t k = 0; k < sizeof(kis) / sizeof(kis[0]); ++k) {
+        pid_handle_t pid, ref;
+        float measured, duty, vin, ref_measured, ref_duty, ref_vin;
+        test_pid_setup(&pid, &measured, &duty, &vin);
+        test_pid_setup(&ref, &ref_measured, &ref_duty, &ref_vin);
+        pid.kp = ref.kp = PID_KP;
+        pid.ki = ref.ki = kis[k];
+        for (int i = 0; i < TEST_HOLD_TICKS; ++i) {
+            test_pid_closed_loop_tick(&pid, &measured, &duty, vin);
+            test_pid_closed_loop_tick(&ref, &ref_measured, &ref_duty, ref_vin);
+        }
+        TEST_ASSERT_DOUBLE_WITHIN(0.1, TEST_SETPOINT, measured);
+
+        pid_set_feedforward(&pid, PID_FF_NONE, &vin);
+        for (int i = 0; i < TEST_HOLD_TICKS; ++i) {
+            test_pid_closed_loop_tick(&pid, &measured, &duty, vin);
+            test_pid_closed_loop_tick(&ref, &ref_measured, &ref_duty, ref_vin);
+            TEST_ASSERT_DOUBLE_WITHIN(TEST_DUTY_TOL, ref_duty, duty);
+        }
+
+        // 切回原拓扑：之前的余量一并折回，仍然无扰
+        pid_set_feedforward(&pid, PID_FF_BUCK, &vin);
+        for (int i = 0; i < TEST_HOLD_TICKS; ++i) {
+            test_pid_closed_loop_tick(&pid, &measured, &duty, vin);
+            test_pid_closed_loop_tick(&ref, &ref_measured, &ref_duty, ref_vin);
+            TEST_ASSERT_DOUBLE_WITHIN(TEST_DUTY_TOL, ref_duty, duty);
+        }
+    }
+}
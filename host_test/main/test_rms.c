@@ -0,0 +1,162 @@
+// 有效值检波与双精度参考实现的对比测试
+#include "unity.h"
+#include "rms/rms_control.h"
+#include <math.h>
+#include <stdlib.h>
+
+#define TEST_SAMPLES_MAX  8192
+#define TEST_REL_TOL      1e-5
+
+typedef struct {
+    double rms;
+    double ac_rms;
+    double mean;
+    double rectified_avg;
+    double peak;
+} rms_ref_t;
+
+static uint16_t s_codes[TEST_SAMPLES_MAX];
+
+// 双精度两遍法参考值：先求均值再求方差，不受大直流分量下相减抵消的影响
+static rms_ref_t rms_reference(const uint16_t *codes, int count, int32_t offset, double scale)
+{
+    rms_ref_t ref = {0};
+    double sum = 0.0, sq = 0.0, abs_sum = 0.0, peak = 0.0;
+    for (int i = 0; i < count; ++i) {
+        double x = (double)codes[i] - offset;
+        sum += x;
+        sq += x * x;
+        abs_sum += fabs(x);
+        if (fabs(x) > peak) peak = fabs(x);
+    }
+    double mean = sum / count;
+    double var = 0.0;
+    for (int i = 0; i < count; ++i) {
+        double d = (double)codes[i] - offset - mean;
+        var += d * d;
+    }
+    ref.rms = sqrt(sq / count) * scale;
+    ref.ac_rms = sqrt(var / count) * scale;
+    ref.mean = mean * scale;
+    ref.rectified_avg = abs_sum / count * scale;
+    ref.peak = peak * scale;
+    return ref;
+}
+
+// 直流 + 正弦 + 均匀噪声，量化为 16 位码值；噪声用固定种子的线性同余序列以保证可重复
+static void make_codes(uint16_t *codes, int count, double dc, double amp, double period, double noise)
+{
+    uint32_t seed = 12345;
+    for (int i = 0; i < count; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        double n = ((double)(seed >> 8) / (double)(1u << 24) - 0.5) * 2.0 * noise;
+        double v = dc + amp * sin(2.0 * M_PI * i / period) + n;
+        if (v < 0.0) v = 0.0;
+        if (v > 65535.0) v = 65535.0;
+        codes[i] = (uint16_t)lround(v);
+    }
+}
+
+static void assert_close(double expected, float actual)
+{
+    double tol = TEST_REL_TOL * fabs(expected);
+    if (tol < 1e-9) tol = 1e-9;
+    TEST_ASSERT_DOUBLE_WITHIN(tol, expected, (double)actual);
+}
+
+static void assert_matches_reference(const rms_result_t *r, const rms_ref_t *ref)
+{
+    assert_close(ref->rms, r->rms);
+    assert_close(ref->ac_rms, r->ac_rms);
+    assert_close(ref->mean, r->mean);
+    assert_close(ref->rectified_avg, r->rectified_avg);
+    assert_close(ref->peak, r->peak);
+    assert_close(ref->peak / ref->rms, r->crest_factor);
+}
+
+TEST_CASE("window mode matches double reference", "[rms]")
+{
+    const int window = 4000;
+    const int32_t offset = 32768;
+    const float scale = 10.0f / 32768.0f;
+    make_codes(s_codes, window, offset + 1200.0, 20000.0, 97.3, 300.0);
+
+    rms_handle_t rms;
+    rms_init(&rms, &(rms_config_t){ .mode = RMS_MODE_WINDOW, .window = window, .offset = offset, .scale = scale });
+    TEST_ASSERT_EQUAL(1, rms_process_block(&rms, s_codes, window, 1));
+
+    rms_result_t r;
+    rms_get_result(&rms, &r);
+    TEST_ASSERT_EQUAL_UINT32(window, r.samples);
+    TEST_ASSERT_EQUAL_UINT32(1, r.sequence);
+    TEST_ASSERT_FALSE(r.synchronized);
+    rms_ref_t ref = rms_reference(s_codes, window, offset, scale);
+    assert_matches_reference(&r, &ref);
+}
+
+// 大直流上叠加几个码值的交流：单精度 Σx²/n − mean² 在这里会完全失效
+TEST_CASE("ac rms survives large dc offset", "[rms]")
+{
+    const int window = 8192;
+    make_codes(s_codes, window, 60000.0, 3.0, 50.0, 0.0);
+
+    rms_handle_t rms;
+    rms_init(&rms, &(rms_config_t){ .mode = RMS_MODE_WINDOW, .window = window });
+    rms_process_block(&rms, s_codes, window, 1);
+
+    rms_result_t r;
+    rms_get_result(&rms, &r);
+    rms_ref_t ref = rms_reference(s_codes, window, 0, 1.0);
+    TEST_ASSERT_TRUE(ref.ac_rms > 1.0);
+    assert_matches_reference(&r, &ref);
+}
+
+TEST_CASE("zero cross mode settles on whole cycles", "[rms]")
+{
+    const int period = 200;
+    const int cycles = 4;
+    const int32_t offset = 32768;
+    const float sample_rate = 20000.0f;
+    make_codes(s_codes, TEST_SAMPLES_MAX, offset, 15000.0, period, 0.0);
+
+    rms_handle_t rms;
+    rms_init(&rms, &(rms_config_t){
+        .mode = RMS_MODE_ZERO_CROSS, .cycles = cycles, .offset = offset, .scale = 1.0f, .sample_rate_hz = sample_rate,
+    });
+    int first = -1;
+    for (int i = 0; i < TEST_SAMPLES_MAX && first < 0; ++i) {
+        if (rms_process_sample(&rms, s_codes[i])) first = i;
+    }
+    TEST_ASSERT_TRUE(first > 0);
+
+    rms_result_t r;
+    rms_get_result(&rms, &r);
+    TEST_ASSERT_TRUE(r.synchronized);
+    TEST_ASSERT_EQUAL_UINT32(period * cycles, r.samples);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-3, sample_rate / period, r.frequency_hz);
+    // 结算区间为触发样本之前的 cycles 个整周期
+    rms_ref_t ref = rms_reference(&s_codes[first - period * cycles], period * cycles, offset, 1.0);
+    assert_matches_reference(&r, &ref);
+}
+
+TEST_CASE("block stride picks one channel", "[rms]")
+{
+    const int rounds = 1000;
+    const int channels = 3;
+    static uint16_t single[1000];
+    make_codes(single, rounds, 30000.0, 8000.0, 37.0, 50.0);
+    for (int i = 0; i < rounds; ++i) {
+        for (int c = 0; c < channels; ++c) {
+            s_codes[i * channels + c] = c == 1 ? single[i] : 65535;
+        }
+    }
+
+    rms_handle_t rms;
+    rms_init(&rms, &(rms_config_t){ .mode = RMS_MODE_WINDOW, .window = rounds });
+    TEST_ASSERT_EQUAL(1, rms_process_block(&rms, &s_codes[1], rounds * channels - 1, channels));
+
+    rms_result_t r;
+    rms_get_result(&rms, &r);
+    rms_ref_t ref = rms_reference(single, rounds, 0, 1.0);
+    assert_matches_reference(&r, &ref);
+}
@@ -0,0 +1,53 @@
+// UART 行拼接测试：经 Linux UART HAL 的命名管道输入，在行中间注入接收溢出
+#include "unity.h"
+#include "uart/uart_control.h"
+#include "sim/sim_plant.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#define TEST_UART        UART_NUM_1
+#define TEST_SETTLE_MS   50    // 接收任务每个 tick 轮询一次管道
+
+static void test_uart_send(int fd, const char *text)
+{
+    TEST_ASSERT_EQUAL(strlen(text), write(fd, text, strlen(text)));
+    vTaskDelay(pdMS_TO_TICKS(TEST_SETTLE_MS));
+}
+
+static bool test_uart_port_stats(uart_port_stats_t *st)
+{
+    for (int i = 0; uart_get_port_stats(i, st); ++i) {
+        if (st->uart_num == TEST_UART) return true;
+    }
+    return false;
+}
+
+// 溢出前收到的行首与溢出后到达的行尾都不能拼成命令，下一整行照常提交
+TEST_CASE("uart drops the line torn by an rx overflow", "[uart]")
+{
+    uart_init(TEST_UART);
+    char path[96];
+    snprintf(path, sizeof(path), SIM_OUTPUT_DIR "/uart%d.rx", TEST_UART);
+    int fd = open(path, O_WRONLY | O_NONBLOCK);
+    TEST_ASSERT_TRUE(fd >= 0);
+
+    uart_port_stats_t before;
+    TEST_ASSERT_TRUE(test_uart_port_stats(&before));
+    test_uart_send(fd, "set vset=1");
+    hal_uart_sim_overflow(TEST_UART);
+    test_uart_send(fd, "=18\nping\n");
+
+    uart_content_t *line = uart_read();
+    TEST_ASSERT_NOT_NULL(line);
+    TEST_ASSERT_EQUAL_STRING("ping", (const char *)line->data);
+    TEST_ASSERT_NULL(uart_read());
+
+    uart_port_stats_t after;
+    TEST_ASSERT_TRUE(test_uart_port_stats(&after));
+    TEST_ASSERT_EQUAL_UINT32(before.overruns + 1, after.overruns);
+    TEST_ASSERT_EQUAL_UINT32(before.dropped_lines + 1, after.dropped_lines);
+    close(fd);
+}
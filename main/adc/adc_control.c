@@ -0,0 +1,271 @@
+#include "adc_control.h"
+#include "trace/trace_control.h"
+#include <inttypes.h>
+#include <string.h>
+
+static const char *TAG = "ADC_CONT";
+
+static adc_continuous_handle_t s_adc_handle = NULL;
+static uint8_t s_channels[ADC_CONT_CHANNELS_MAX];
+static int s_channel_count = 0;
+static int8_t s_channel_index[SOC_ADC_PATT_LEN_MAX]; // 通道号 -> 采样顺序，-1 表示未使用
+
+static uint32_t s_sample_rate = 0;
+static uint32_t s_periods_per_block = 0;
+static int s_block_size = 0;          // 每块样本数，恰为整数个开关周期
+static uint32_t s_frame_bytes = 0;
+
+static TaskHandle_t s_adc_task = NULL;
+static adc_cont_block_cb_t s_block_cb = NULL;
+static void *s_block_cb_arg = NULL;
+static volatile int64_t s_frame_time_us = 0;
+
+// 实测采样率：帧完成中断累计窗口内的帧数，采集任务在窗口结束后换算
+static portMUX_TYPE s_rate_lock = portMUX_INITIALIZER_UNLOCKED;
+static int64_t s_rate_start_us = 0;
+static int64_t s_rate_last_us = 0;
+static uint32_t s_rate_frames = 0;
+static bool s_rate_warned = false;
+
+static uint16_t s_blocks[2][ADC_CONT_BLOCK_MAX];
+static int s_block_index = 0;
+static int s_block_fill = 0;
+static int64_t s_block_time_us = 0;
+static uint8_t s_frame_buf[ADC_CONT_BLOCK_MAX * SOC_ADC_DIGI_RESULT_BYTES];
+
+static uint16_t s_average[ADC_CONT_CHANNELS_MAX];
+static int64_t s_average_time_us = 0;
+static adc_cont_stats_t s_stats;
+
+esp_err_t adc_cont_init(const adc_cont_config_t *cfg)
+{
+    if (!cfg || !cfg->channels || cfg->channel_count <= 0 || cfg->channel_count > ADC_CONT_CHANNELS_MAX ||
+        cfg->switching_freq_hz == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_adc_handle) return ESP_ERR_INVALID_STATE;
+
+    s_channel_count = cfg->channel_count;
+    memset(s_channel_index, -1, sizeof(s_channel_index));
+    for (int i = 0; i < s_channel_count; ++i) {
+        if (cfg->channels[i] >= SOC_ADC_PATT_LEN_MAX) return ESP_ERR_INVALID_ARG;
+        s_channels[i] = cfg->channels[i];
+        s_channel_index[cfg->channels[i]] = i;
+    }
+
+    // 采样率取 f_sw × 每周期采样数 × 通道数；超过 ADC 上限时减少每周期采样数
+    uint32_t spp = cfg->samples_per_period ? cfg->samples_per_period : 1;
+    uint64_t rate = (uint64_t)cfg->switching_freq_hz * spp * s_channel_count;
+    while (rate > SOC_ADC_SAMPLE_FREQ_THRES_HIGH && spp > 1) {
+        spp--;
+        rate = (uint64_t)cfg->switching_freq_hz * spp * s_channel_count;
+    }
+    // 隔 N 个周期采一个点时每次都落在同一相位，块平均不是周期平均，不提供这种配置
+    if (rate > SOC_ADC_SAMPLE_FREQ_THRES_HIGH) {
+        ESP_LOGE(TAG, "Switching frequency %" PRIu32 " Hz too high for period-synchronous sampling", cfg->switching_freq_hz);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    if (rate < SOC_ADC_SAMPLE_FREQ_THRES_LOW) {
+        ESP_LOGE(TAG, "Sample rate %" PRIu64 " Hz below ADC minimum", rate);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    s_sample_rate = (uint32_t)rate;
+
+    // 每块由整数个开关周期组成，块平均时开关纹波正好抵消
+    int rounds = (ADC_CONT_BLOCK_MAX / s_channel_count) / spp * spp;
+    if (rounds == 0) return ESP_ERR_INVALID_SIZE;
+    s_block_size = rounds * s_channel_count;
+    s_periods_per_block = rounds / spp;
+    s_frame_bytes = s_block_size * SOC_ADC_DIGI_RESULT_BYTES;
+
+    adc_continuous_handle_cfg_t handle_cfg = {
+        .max_store_buf_size = s_frame_bytes * ADC_CONT_POOL_FRAMES,
+        .conv_frame_size = s_frame_bytes,
+    };
+    esp_err_t ret = adc_continuous_new_handle(&handle_cfg, &s_adc_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create ADC handle: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    adc_digi_pattern_config_t pattern[ADC_CONT_CHANNELS_MAX] = {0};
+    for (int i = 0; i < s_channel_count; ++i) {
+        pattern[i].atten = ADC_CONT_ATTEN;
+        pattern[i].channel = s_channels[i];
+        pattern[i].unit = ADC_UNIT_1;
+        pattern[i].bit_width = ADC_CONT_BIT_WIDTH;
+    }
+    adc_continuous_config_t dig_cfg = {
+        .pattern_num = s_channel_count,
+        .adc_pattern = pattern,
+        .sample_freq_hz = s_sample_rate,
+        .conv_mode = ADC_CONV_SINGLE_UNIT_1,
+        .format = ADC_DIGI_OUTPUT_FORMAT_TYPE2,
+    };
+    ret = adc_continuous_config(s_adc_handle, &dig_cfg);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to configure ADC: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    memset(&s_stats, 0, sizeof(s_stats));
+    ESP_LOGI(TAG, "ADC continuous initialized: %d channels, %" PRIu32 " Hz, %d samples/block (%" PRIu32 " periods)",
+             s_channel_count, s_sample_rate, s_block_size, s_periods_per_block);
+    return ESP_OK;
+}
+
+// DMA 帧完成中断：记录完成时刻并唤醒采集任务
+static bool IRAM_ATTR adc_cont_on_conv_done(adc_continuous_handle_t handle, const adc_continuous_evt_data_t *edata, void *arg)
+{
+    int64_t now = esp_timer_get_time();
+    s_frame_time_us = now;
+    portENTER_CRITICAL_ISR(&s_rate_lock);
+    if (s_rate_start_us == 0) {
+        s_rate_start_us = now;
+        s_rate_frames = 0;
+    } else {
+        s_rate_frames++;
+    }
+    s_rate_last_us = now;
+    portEXIT_CRITICAL_ISR(&s_rate_lock);
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(s_adc_task, &woken);
+    return woken == pdTRUE;
+}
+
+static bool IRAM_ATTR adc_cont_on_pool_ovf(adc_continuous_handle_t handle, const adc_continuous_evt_data_t *edata, void *arg)
+{
+    s_stats.pool_overflows++;
+    return false;
+}
+
+static void adc_cont_finish_block(void)
+{
+    const uint16_t *done = s_blocks[s_block_index];
+    uint32_t sum[ADC_CONT_CHANNELS_MAX] = {0};
+    for (int i = 0; i < s_block_size; ++i) {
+        sum[i % s_channel_count] += done[i];
+    }
+    int rounds = s_block_size / s_channel_count;
+    for (int ch = 0; ch < s_channel_count; ++ch) {
+        s_average[ch] = (uint16_t)((sum[ch] + rounds / 2) / rounds);
+    }
+    s_average_time_us = s_block_time_us;
+
+    // 交换缓冲区后再回调，回调期间新样本写入另一块
+    s_block_index ^= 1;
+    s_block_fill = 0;
+    s_stats.blocks++;
+    TRACE_BEGIN_ARG(ADC_BLOCK, s_block_size);
+    if (s_block_cb) s_block_cb(done, s_block_size, s_channel_count, s_average_time_us, s_block_cb_arg);
+    TRACE_END(ADC_BLOCK);
+}
+
+// 窗口内完成的帧数 × 每帧样本数 / 时长即实际采样率，与标称值比较得到偏差
+static void adc_cont_update_rate(void)
+{
+    portENTER_CRITICAL(&s_rate_lock);
+    int64_t span = s_rate_last_us - s_rate_start_us;
+    uint32_t frames = s_rate_frames;
+    bool done = s_rate_start_us != 0 && span >= ADC_CONT_RATE_WINDOW_US;
+    if (done) {
+        s_rate_start_us = s_rate_last_us;
+        s_rate_frames = 0;
+    }
+    portEXIT_CRITICAL(&s_rate_lock);
+    if (!done) return;
+
+    uint64_t samples = (uint64_t)frames * (s_frame_bytes / SOC_ADC_DIGI_RESULT_BYTES);
+    s_stats.measured_rate_hz = (uint32_t)((samples * 1000000 + span / 2) / span);
+    s_stats.rate_error_ppm = (int32_t)(((int64_t)s_stats.measured_rate_hz - s_sample_rate) * 1000000 / s_sample_rate);
+    if (!adc_cont_synchronized() && !s_rate_warned) {
+        s_rate_warned = true;
+        ESP_LOGW(TAG, "Sample rate %" PRIu32 " Hz deviates %" PRId32 " ppm from %" PRIu32 " Hz, block averages are not period averages",
+                 s_stats.measured_rate_hz, s_stats.rate_error_ppm, s_sample_rate);
+    }
+}
+
+static void adc_cont_task(void *arg)
+{
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        adc_cont_update_rate();
+        uint32_t len = 0;
+        while (adc_continuous_read(s_adc_handle, s_frame_buf, s_frame_bytes, &len, 0) == ESP_OK) {
+            int count = len / SOC_ADC_DIGI_RESULT_BYTES;
+            // 帧中第一个样本的时刻由帧完成时刻倒推
+            int64_t frame_start_us = s_frame_time_us - (int64_t)count * 1000000 / s_sample_rate;
+            for (int i = 0; i < count; ++i) {
+                const adc_digi_output_data_t *p = (const adc_digi_output_data_t *)&s_frame_buf[i * SOC_ADC_DIGI_RESULT_BYTES];
+                int idx = p->type2.channel < SOC_ADC_PATT_LEN_MAX ? s_channel_index[p->type2.channel] : -1;
+                // 样本必须按通道顺序到达，错位时丢弃当前半轮并从下一轮开头重新对齐
+                if (idx != s_block_fill % s_channel_count) {
+                    s_stats.resyncs++;
+                    s_block_fill -= s_block_fill % s_channel_count;
+                    if (idx != 0) continue;
+                }
+                if (s_block_fill == 0) {
+                    s_block_time_us = frame_start_us + (int64_t)i * 1000000 / s_sample_rate;
+                }
+                s_blocks[s_block_index][s_block_fill++] = p->type2.data;
+                s_stats.samples++;
+                if (s_block_fill == s_block_size) adc_cont_finish_block();
+            }
+        }
+    }
+}
+
+esp_err_t adc_cont_start(adc_cont_block_cb_t cb, void *arg)
+{
+    if (!s_adc_handle) return ESP_ERR_INVALID_STATE;
+    s_block_cb = cb;
+    s_block_cb_arg = arg;
+    s_block_index = 0;
+    s_block_fill = 0;
+    portENTER_CRITICAL(&s_rate_lock);
+    s_rate_start_us = 0;
+    portEXIT_CRITICAL(&s_rate_lock);
+    if (!s_adc_task) {
+        xTaskCreatePinnedToCore(adc_cont_task, "adc_cont", ADC_CONT_TASK_STACK_SIZE, NULL, ADC_CONT_TASK_PRIORITY, &s_adc_task, APP_CORE_CONTROL);
+        adc_continuous_evt_cbs_t cbs = {
+            .on_conv_done = adc_cont_on_conv_done,
+            .on_pool_ovf = adc_cont_on_pool_ovf,
+        };
+        ESP_ERROR_CHECK(adc_continuous_register_event_callbacks(s_adc_handle, &cbs, NULL));
+    }
+    return adc_continuous_start(s_adc_handle);
+}
+
+void adc_cont_stop(void)
+{
+    if (s_adc_handle) adc_continuous_stop(s_adc_handle);
+}
+
+uint16_t adc_cont_get_average(int index, int64_t *timestamp_us)
+{
+    if (index < 0 || index >= s_channel_count) return 0;
+    if (timestamp_us) *timestamp_us = s_average_time_us;
+    return s_average[index];
+}
+
+uint32_t adc_cont_sample_rate(void)
+{
+    return s_sample_rate;
+}
+
+uint32_t adc_cont_periods_per_block(void)
+{
+    return s_periods_per_block;
+}
+
+bool adc_cont_synchronized(void)
+{
+    if (s_stats.measured_rate_hz == 0) return false;
+    int32_t err = s_stats.rate_error_ppm;
+    return (err < 0 ? -err : err) <= ADC_CONT_SYNC_PPM;
+}
+
+void adc_cont_get_stats(adc_cont_stats_t *stats)
+{
+    if (stats) *stats = s_stats;
+}
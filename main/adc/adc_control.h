@@ -0,0 +1,71 @@
+// ESP32 片上 ADC 连续采样（DMA）模块头文件
+// 采样率设为开关频率的整数倍，每块覆盖整数个（标称）开关周期，块平均近似为周期平均值
+// ADC 由自己的时钟分频驱动，不与 PWM 硬件同步：实际采样率只能逼近 f_sw × 每周期采样数，采样相位会缓慢漂移。
+// 运行中按 DMA 帧完成时刻实测采样率，误差超过 ADC_CONT_SYNC_PPM 时 adc_cont_synchronized 返回 false，
+// 此时块平均会残留纹波，谐波分析的频点也会泄漏；开关频率高到每周期一个样本都超出 ADC 上限时直接拒绝
+
+#pragma once
+
+#include "global_params.h"
+#include "esp_log.h"
+#include "esp_err.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#if CONFIG_IDF_TARGET_LINUX
+// Linux 主机构建由 adc_control_linux.c 按仿真被控对象合成样本，沿用 ESP32-P4 的 ADC 参数
+#define SOC_ADC_DIGI_MAX_BITWIDTH      12
+#define SOC_ADC_SAMPLE_FREQ_THRES_HIGH 83333
+#define SOC_ADC_SAMPLE_FREQ_THRES_LOW  611
+#else
+#include "esp_adc/adc_continuous.h"
+#include "soc/soc_caps.h"
+#endif
+
+#define ADC_CONT_CHANNELS_MAX    4
+#define ADC_CONT_BLOCK_MAX       256   // 每块样本数上限（按通道交错），双缓冲
+#define ADC_CONT_ATTEN           ADC_ATTEN_DB_12
+#define ADC_CONT_BIT_WIDTH       SOC_ADC_DIGI_MAX_BITWIDTH
+#define ADC_CONT_FULL_SCALE      ((1 << ADC_CONT_BIT_WIDTH) - 1)
+#define ADC_CONT_POOL_FRAMES     4     // 驱动内部缓存可容纳的帧数
+#define ADC_CONT_TASK_STACK_SIZE 4096
+#define ADC_CONT_TASK_PRIORITY   (configMAX_PRIORITIES - 4)  // 低于控制任务，DMA 缓存可容忍数个周期的延迟
+#define ADC_CONT_RATE_WINDOW_US  1000000   // 实测采样率的统计窗口
+#define ADC_CONT_SYNC_PPM        1000      // 实测采样率与标称值的允许偏差
+
+typedef struct {
+    const uint8_t *channels;      // ADC1 通道号，按采样顺序排列
+    int channel_count;
+    uint32_t switching_freq_hz;   // 被测变换器的开关频率
+    uint32_t samples_per_period;  // 每个开关周期每通道期望的采样数，超出 ADC 上限时自动降低
+} adc_cont_config_t;
+
+// 一块样本采满后在采集任务中调用：samples 按通道顺序交错，块在下一块采满前有效
+typedef void (*adc_cont_block_cb_t)(const uint16_t *samples, int count, int channel_count, int64_t first_timestamp_us, void *arg);
+
+typedef struct {
+    uint32_t blocks;
+    uint32_t samples;
+    uint32_t pool_overflows;   // 采集任务来不及取走，驱动丢弃的帧
+    uint32_t resyncs;          // 通道顺序错位后丢弃的半轮样本
+    uint32_t measured_rate_hz; // 最近一个统计窗口实测的总采样率，0 表示尚未测得
+    int32_t rate_error_ppm;    // 实测采样率相对标称值 f_sw × 每周期采样数 × 通道数的偏差
+} adc_cont_stats_t;
+
+// 开关频率过高、每周期一个样本也超出 ADC 上限时返回 ESP_ERR_NOT_SUPPORTED，而不是退化为隔周期采样
+esp_err_t adc_cont_init(const adc_cont_config_t *cfg);
+esp_err_t adc_cont_start(adc_cont_block_cb_t cb, void *arg);
+void adc_cont_stop(void);
+
+// 最近一块中第 index 个通道的平均值（原始码值）及该块的起始时刻
+uint16_t adc_cont_get_average(int index, int64_t *timestamp_us);
+// 实际配置的总采样率（所有通道合计）与每块覆盖的开关周期数
+uint32_t adc_cont_sample_rate(void);
+uint32_t adc_cont_periods_per_block(void);
+// 已测得实测采样率且偏差不超过 ADC_CONT_SYNC_PPM；为 false 时块平均与谐波结果只能作为近似值
+bool adc_cont_synchronized(void);
+void adc_cont_get_stats(adc_cont_stats_t *stats);
@@ -0,0 +1,167 @@
+#include "adc_control.h"
+#include "sim/sim_plant.h"
+#include "trace/trace_control.h"
+#include <inttypes.h>
+#include <math.h>
+#include <string.h>
+
+// Linux 主机构建：按实际流逝的时间合成样本块，每个通道都是经分压后的仿真输出电压
+// 叠加开关频率处的纹波，采样率与分块规则与硬件实现一致
+
+#define ADC_CONT_SIM_DIVIDER  11.0f   // 与 main.c 中分压比一致
+#define ADC_CONT_SIM_VREF     3.3f
+
+static const char *TAG = "ADC_CONT";
+
+static bool s_initialized = false;
+static int s_channel_count = 0;
+static uint32_t s_sample_rate = 0;
+static uint32_t s_periods_per_block = 0;
+static uint32_t s_switching_hz = 0;
+static int s_block_size = 0;
+
+static TaskHandle_t s_adc_task = NULL;
+static volatile bool s_running = false;
+static adc_cont_block_cb_t s_block_cb = NULL;
+static void *s_block_cb_arg = NULL;
+
+static uint16_t s_block[ADC_CONT_BLOCK_MAX];
+static uint16_t s_average[ADC_CONT_CHANNELS_MAX];
+static int64_t s_average_time_us = 0;
+static adc_cont_stats_t s_stats;
+
+esp_err_t adc_cont_init(const adc_cont_config_t *cfg)
+{
+    if (!cfg || !cfg->channels || cfg->channel_count <= 0 || cfg->channel_count > ADC_CONT_CHANNELS_MAX ||
+        cfg->switching_freq_hz == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_initialized) return ESP_ERR_INVALID_STATE;
+    s_channel_count = cfg->channel_count;
+
+    uint32_t spp = cfg->samples_per_period ? cfg->samples_per_period : 1;
+    uint64_t rate = (uint64_t)cfg->switching_freq_hz * spp * s_channel_count;
+    while (rate > SOC_ADC_SAMPLE_FREQ_THRES_HIGH && spp > 1) {
+        spp--;
+        rate = (uint64_t)cfg->switching_freq_hz * spp * s_channel_count;
+    }
+    // 隔 N 个周期采一个点时每次都落在同一相位，块平均不是周期平均，不提供这种配置
+    if (rate > SOC_ADC_SAMPLE_FREQ_THRES_HIGH) {
+        ESP_LOGE(TAG, "Switching frequency %" PRIu32 " Hz too high for period-synchronous sampling", cfg->switching_freq_hz);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    if (rate < SOC_ADC_SAMPLE_FREQ_THRES_LOW) {
+        ESP_LOGE(TAG, "Sample rate %" PRIu64 " Hz below ADC minimum", rate);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    s_sample_rate = (uint32_t)rate;
+
+    int rounds = (ADC_CONT_BLOCK_MAX / s_channel_count) / spp * spp;
+    if (rounds == 0) return ESP_ERR_INVALID_SIZE;
+    s_block_size = rounds * s_channel_count;
+    s_periods_per_block = rounds / spp;
+    s_switching_hz = cfg->switching_freq_hz;
+
+    memset(&s_stats, 0, sizeof(s_stats));
+    // 仿真样本按标称采样率合成，没有时钟误差
+    s_stats.measured_rate_hz = s_sample_rate;
+    s_initialized = true;
+    ESP_LOGI(TAG, "Simulated ADC continuous: %d channels, %" PRIu32 " Hz, %d samples/block",
+             s_channel_count, s_sample_rate, s_block_size);
+    return ESP_OK;
+}
+
+static void adc_cont_synthesize(int64_t t0_us)
+{
+    float v, i;
+    sim_plant_get(&v, &i);
+    float ripple = sim_plant_ripple_v() * 0.5f;
+    float lsb = ADC_CONT_SIM_VREF / ADC_CONT_FULL_SCALE;
+    uint32_t sum[ADC_CONT_CHANNELS_MAX] = {0};
+    for (int n = 0; n < s_block_size; ++n) {
+        double t = (t0_us + (double)n * 1e6 / s_sample_rate) * 1e-6;
+        float x = (v + ripple * sinf(2.0f * (float)M_PI * (float)fmod(t * s_switching_hz, 1.0))) / ADC_CONT_SIM_DIVIDER;
+        int code = (int)lroundf(x / lsb);
+        if (code < 0) code = 0;
+        if (code > ADC_CONT_FULL_SCALE) code = ADC_CONT_FULL_SCALE;
+        s_block[n] = (uint16_t)code;
+        sum[n % s_channel_count] += code;
+    }
+    int rounds = s_block_size / s_channel_count;
+    for (int ch = 0; ch < s_channel_count; ++ch) {
+        s_average[ch] = (uint16_t)((sum[ch] + rounds / 2) / rounds);
+    }
+    s_average_time_us = t0_us;
+    s_stats.blocks++;
+    s_stats.samples += s_block_size;
+}
+
+static void adc_cont_task(void *arg)
+{
+    int64_t block_us = (int64_t)s_block_size * 1000000 / s_sample_rate;
+    int64_t next_us = esp_timer_get_time();
+    while (1) {
+        vTaskDelay(1);
+        if (!s_running) {
+            next_us = esp_timer_get_time();
+            continue;
+        }
+        // 跟上实际时间，落后过多时丢弃并计入溢出，与硬件驱动缓存溢出的行为一致
+        int64_t now = esp_timer_get_time();
+        if (now - next_us > block_us * ADC_CONT_POOL_FRAMES) {
+            s_stats.pool_overflows++;
+            next_us = now - block_us;
+        }
+        while (next_us + block_us <= now) {
+            adc_cont_synthesize(next_us);
+            TRACE_BEGIN_ARG(ADC_BLOCK, s_block_size);
+            if (s_block_cb) s_block_cb(s_block, s_block_size, s_channel_count, next_us, s_block_cb_arg);
+            TRACE_END(ADC_BLOCK);
+            next_us += block_us;
+        }
+    }
+}
+
+esp_err_t adc_cont_start(adc_cont_block_cb_t cb, void *arg)
+{
+    if (!s_initialized) return ESP_ERR_INVALID_STATE;
+    s_block_cb = cb;
+    s_block_cb_arg = arg;
+    if (!s_adc_task) {
+        xTaskCreatePinnedToCore(adc_cont_task, "adc_cont", ADC_CONT_TASK_STACK_SIZE, NULL, ADC_CONT_TASK_PRIORITY, &s_adc_task, APP_CORE_CONTROL);
+    }
+    s_running = true;
+    return ESP_OK;
+}
+
+void adc_cont_stop(void)
+{
+    s_running = false;
+}
+
+uint16_t adc_cont_get_average(int index, int64_t *timestamp_us)
+{
+    if (index < 0 || index >= s_channel_count) return 0;
+    if (timestamp_us) *timestamp_us = s_average_time_us;
+    return s_average[index];
+}
+
+uint32_t adc_cont_sample_rate(void)
+{
+    return s_sample_rate;
+}
+
+uint32_t adc_cont_periods_per_block(void)
+{
+    return s_periods_per_block;
+}
+
+bool adc_cont_synchronized(void)
+{
+    return s_initialized;
+}
+
+void adc_cont_get_stats(adc_cont_stats_t *stats)
+{
+    if (stats) *stats = s_stats;
+}
@@ -0,0 +1,130 @@
+#include "bench_control.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if CONFIG_IDF_TARGET_LINUX
+#include <time.h>
+#else
+#include "esp_cpu.h"
+#include "esp_private/esp_clk.h"
+#endif
+
+static const char *TAG = "BENCH";
+
+typedef struct {
+    const char *name;
+    bench_fn_t fn;
+    void *arg;
+    int samples;
+} bench_case_t;
+
+static bench_case_t s_cases[BENCH_CASES_MAX];
+static int s_case_count = 0;
+static uint32_t s_cycles[BENCH_ITERATIONS_MAX];
+static uint32_t s_us[BENCH_ITERATIONS_MAX];
+
+static inline uint32_t bench_cycle_count(void)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec);
+#else
+    return esp_cpu_get_cycle_count();
+#endif
+}
+
+static uint32_t bench_cycles_per_s(void)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    return 1000000000u;
+#else
+    return esp_clk_cpu_freq();
+#endif
+}
+
+static int bench_compare_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// 排序后按最近秩法取分位数
+static bench_dist_t bench_distribution(uint32_t *samples, int n)
+{
+    qsort(samples, n, sizeof(samples[0]), bench_compare_u32);
+    bench_dist_t d = {
+        .min = samples[0],
+        .median = samples[(n - 1) / 2],
+        .p99 = samples[(n * 99 + 99) / 100 - 1],
+    };
+    return d;
+}
+
+esp_err_t bench_register(const char *name, bench_fn_t fn, void *arg)
+{
+    return bench_register_block(name, fn, arg, 0);
+}
+
+esp_err_t bench_register_block(const char *name, bench_fn_t fn, void *arg, int samples)
+{
+    if (!name || !fn || samples < 0) return ESP_ERR_INVALID_ARG;
+    if (s_case_count >= BENCH_CASES_MAX) return ESP_ERR_NO_MEM;
+    s_cases[s_case_count++] = (bench_case_t){ name, fn, arg, samples };
+    return ESP_OK;
+}
+
+static void bench_run_case(const bench_case_t *c, int iterations, bench_result_t *result)
+{
+    for (int i = 0; i < BENCH_WARMUP; ++i) c->fn(c->arg);
+    for (int i = 0; i < iterations; ++i) {
+        int64_t t0 = esp_timer_get_time();
+        uint32_t c0 = bench_cycle_count();
+        c->fn(c->arg);
+        uint32_t c1 = bench_cycle_count();
+        int64_t t1 = esp_timer_get_time();
+        s_cycles[i] = c1 - c0;   // 无符号相减，计数器回绕一次也正确
+        s_us[i] = (uint32_t)(t1 - t0);
+    }
+    result->name = c->name;
+    result->iterations = iterations;
+    result->cycles = bench_distribution(s_cycles, iterations);
+    result->us = bench_distribution(s_us, iterations);
+    result->samples_per_s = (c->samples > 0 && result->cycles.median > 0)
+                          ? (uint32_t)((uint64_t)c->samples * bench_cycles_per_s() / result->cycles.median) : 0;
+}
+
+esp_err_t bench_run(const char *name, int iterations, bench_result_t *result)
+{
+    if (!name || !result || iterations <= 0) return ESP_ERR_INVALID_ARG;
+    if (iterations > BENCH_ITERATIONS_MAX) iterations = BENCH_ITERATIONS_MAX;
+    for (int i = 0; i < s_case_count; ++i) {
+        if (strcmp(s_cases[i].name, name) == 0) {
+            bench_run_case(&s_cases[i], iterations, result);
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+void bench_run_all(int iterations)
+{
+    if (iterations <= 0) iterations = CONFIG_APP_BENCHMARK_ITERATIONS;
+    if (iterations > BENCH_ITERATIONS_MAX) iterations = BENCH_ITERATIONS_MAX;
+    ESP_LOGI(TAG, "Running %d benchmarks x %d iterations", s_case_count, iterations);
+    for (int i = 0; i < s_case_count; ++i) {
+        bench_result_t r;
+        bench_run_case(&s_cases[i], iterations, &r);
+        // 直接 printf，不带日志前缀，便于脚本解析
+        printf("BENCH name=%s n=%d cyc_min=%" PRIu32 " cyc_med=%" PRIu32 " cyc_p99=%" PRIu32 " us_min=%" PRIu32 " us_med=%" PRIu32 " us_p99=%" PRIu32,
+               r.name, r.iterations,
+               r.cycles.min, r.cycles.median, r.cycles.p99,
+               r.us.min, r.us.median, r.us.p99);
+        if (r.samples_per_s) printf(" sps=%" PRIu32, r.samples_per_s);
+        printf("\n");
+    }
+    fflush(stdout);
+}
@@ -0,0 +1,46 @@
+// 热路径微基准模块头文件
+// 每个用例重复执行 N 次，逐次用 CPU 周期计数器与 esp_timer 计时，输出最小值/中位数/P99
+// 结果每个用例一行，格式为 "BENCH name=... n=... cyc_min=... cyc_med=... cyc_p99=... us_min=... us_med=... us_p99=..."，
+// 按块处理样本的用例再附加 "sps=..."（按周期中位数折算的每秒样本数），可用 tools/bench_compare.py 对比两次运行的结果
+// Linux 主机构建下没有周期计数器，cyc_* 字段为纳秒
+
+#pragma once
+
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <stdint.h>
+
+#define BENCH_CASES_MAX       16
+#define BENCH_ITERATIONS_MAX  1000
+#define BENCH_WARMUP          3     // 正式计时前的预热次数，排除首次执行的缓存缺失
+
+#ifndef CONFIG_APP_BENCHMARK_ITERATIONS
+#define CONFIG_APP_BENCHMARK_ITERATIONS 200
+#endif
+
+typedef void (*bench_fn_t)(void *arg);
+
+typedef struct {
+    uint32_t min;
+    uint32_t median;
+    uint32_t p99;
+} bench_dist_t;
+
+typedef struct {
+    const char *name;
+    int iterations;
+    bench_dist_t cycles;
+    bench_dist_t us;
+    uint32_t samples_per_s;  // 每次调用处理的样本数 / 周期中位数折算的时间，非块用例为 0
+} bench_result_t;
+
+// 注册一个用例，name 的生命周期须覆盖整个程序
+esp_err_t bench_register(const char *name, bench_fn_t fn, void *arg);
+// 注册按块处理样本的用例：fn 每次调用处理 samples 个样本，结果额外给出每秒样本数
+esp_err_t bench_register_block(const char *name, bench_fn_t fn, void *arg, int samples);
+// 运行单个用例；iterations 超过 BENCH_ITERATIONS_MAX 时截断
+esp_err_t bench_run(const char *name, int iterations, bench_result_t *result);
+// 依次运行所有用例并逐行打印结果
+void bench_run_all(int iterations);
@@ -0,0 +1,302 @@
+#include "cmd_registry.h"
+#include "trace/trace_control.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+
+static const char *TAG = "cmd_registry";
+
+typedef struct {
+    char name[CMD_NAME_MAX];
+    uint8_t name_len;
+    bool is_param;
+    cmd_param_t param;
+    cmd_handler_t handler;
+} cmd_entry_t;
+
+static cmd_entry_t cmd_entries[CMD_ENTRIES_MAX];
+static int cmd_entry_count = 0;
+// 开放寻址哈希表，保存 entry 下标 + 1，0 表示空槽；注册时建立，查找时只读
+static uint8_t cmd_hash_table[CMD_HASH_SIZE];
+static cmd_handler_t cmd_fallback = NULL;
+
+// FNV-1a
+static uint32_t cmd_hash(const char *name, size_t len)
+{
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; ++i) {
+        h ^= (uint8_t)name[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static cmd_entry_t *cmd_lookup(const char *name, size_t len)
+{
+    if (len == 0 || len >= CMD_NAME_MAX) return NULL;
+    uint32_t slot = cmd_hash(name, len) & (CMD_HASH_SIZE - 1);
+    for (int probe = 0; probe < CMD_HASH_SIZE; ++probe) {
+        uint8_t idx = cmd_hash_table[slot];
+        if (idx == 0) return NULL;
+        cmd_entry_t *entry = &cmd_entries[idx - 1];
+        if (entry->name_len == len && memcmp(entry->name, name, len) == 0) {
+            return entry;
+        }
+        slot = (slot + 1) & (CMD_HASH_SIZE - 1);
+    }
+    return NULL;
+}
+
+static esp_err_t cmd_insert(const char *name, cmd_entry_t **out)
+{
+    size_t len = strlen(name);
+    if (len == 0 || len >= CMD_NAME_MAX) return ESP_ERR_INVALID_ARG;
+    if (cmd_entry_count >= CMD_ENTRIES_MAX) return ESP_ERR_NO_MEM;
+    if (cmd_lookup(name, len)) return ESP_ERR_INVALID_STATE;
+
+    cmd_entry_t *entry = &cmd_entries[cmd_entry_count];
+    memcpy(entry->name, name, len + 1);
+    entry->name_len = (uint8_t)len;
+    uint32_t slot = cmd_hash(name, len) & (CMD_HASH_SIZE - 1);
+    while (cmd_hash_table[slot] != 0) {
+        slot = (slot + 1) & (CMD_HASH_SIZE - 1);
+    }
+    cmd_hash_table[slot] = (uint8_t)(cmd_entry_count + 1);
+    cmd_entry_count++;
+    *out = entry;
+    return ESP_OK;
+}
+
+esp_err_t cmd_register_param(const cmd_param_t *param)
+{
+    if (!param || !param->name || (!param->value && !param->getter)) return ESP_ERR_INVALID_ARG;
+    cmd_entry_t *entry = NULL;
+    esp_err_t ret = cmd_insert(param->name, &entry);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to register param %s: %s", param->name, esp_err_to_name(ret));
+        return ret;
+    }
+    entry->is_param = true;
+    entry->param = *param;
+    return ESP_OK;
+}
+
+esp_err_t cmd_register_command(const char *name, cmd_handler_t handler)
+{
+    if (!name || !handler) return ESP_ERR_INVALID_ARG;
+    cmd_entry_t *entry = NULL;
+    esp_err_t ret = cmd_insert(name, &entry);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to register command %s: %s", name, esp_err_to_name(ret));
+        return ret;
+    }
+    entry->is_param = false;
+    entry->handler = handler;
+    return ESP_OK;
+}
+
+void cmd_register_fallback(cmd_handler_t handler)
+{
+    cmd_fallback = handler;
+}
+
+static float cmd_param_read(const cmd_param_t *param)
+{
+    return param->value ? *param->value : param->getter(param->ctx);
+}
+
+static esp_err_t cmd_param_write(const cmd_param_t *param, float value)
+{
+    // NaN 与任何数比较都为假，会绕过下面的范围检查，一路流进 PID、PWM 与保存的配置
+    if (!isfinite(value)) return ESP_ERR_INVALID_ARG;
+    if (param->type == CMD_PARAM_INT) {
+        // 先按浮点检查范围（留出舍入余量）再取整，超出 int32_t 的浮点转整数是未定义行为
+        if (value < param->min - 1.0f || value > param->max + 1.0f) return ESP_ERR_INVALID_ARG;
+        value = (float)(int32_t)(value + (value >= 0 ? 0.5f : -0.5f));
+    }
+    if (param->type == CMD_PARAM_BOOL) value = (value != 0.0f) ? 1.0f : 0.0f;
+    if (value < param->min || value > param->max) return ESP_ERR_INVALID_ARG;
+    if (param->setter) {
+        esp_err_t ret = param->setter(param->ctx, value);
+        if (ret != ESP_OK) return ret;
+    }
+    if (param->value) *param->value = value;
+    return ESP_OK;
+}
+
+esp_err_t cmd_param_set(const char *name, float value)
+{
+    cmd_entry_t *entry = cmd_lookup(name, strlen(name));
+    if (!entry || !entry->is_param) return ESP_ERR_NOT_FOUND;
+    return cmd_param_write(&entry->param, value);
+}
+
+esp_err_t cmd_param_get(const char *name, float *value)
+{
+    cmd_entry_t *entry = cmd_lookup(name, strlen(name));
+    if (!entry || !entry->is_param || !value) return ESP_ERR_NOT_FOUND;
+    *value = cmd_param_read(&entry->param);
+    return ESP_OK;
+}
+
+// 追加格式化内容，reply 写满后静默截断
+static void cmd_append(char *reply, size_t reply_size, size_t *pos, const char *fmt, ...)
+    __attribute__((format(printf, 4, 5)));
+static void cmd_append(char *reply, size_t reply_size, size_t *pos, const char *fmt, ...)
+{
+    if (*pos >= reply_size) return;
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(reply + *pos, reply_size - *pos, fmt, ap);
+    va_end(ap);
+    if (n > 0) *pos += n;
+}
+
+static void cmd_append_param(char *reply, size_t reply_size, size_t *pos, const cmd_entry_t *entry)
+{
+    float value = cmd_param_read(&entry->param);
+    if (entry->param.type == CMD_PARAM_FLOAT) {
+        cmd_append(reply, reply_size, pos, "%s=%g ", entry->name, value);
+    } else {
+        cmd_append(reply, reply_size, pos, "%s=%d ", entry->name, (int)value);
+    }
+}
+
+static const char *cmd_skip_spaces(const char *p)
+{
+    while (*p == ' ' || *p == '\t') p++;
+    return p;
+}
+
+static size_t cmd_token_len(const char *p, const char *delims)
+{
+    size_t len = 0;
+    while (p[len] && !strchr(delims, p[len])) len++;
+    return len;
+}
+
+static void cmd_do_set(const char *args, char *reply, size_t reply_size)
+{
+    size_t pos = 0;
+    int ok = 0;
+    const char *p = cmd_skip_spaces(args);
+    while (*p) {
+        size_t name_len = cmd_token_len(p, "= \t");
+        cmd_entry_t *entry = cmd_lookup(p, name_len);
+        const char *eq = p + name_len;
+        if (*eq != '=') {
+            cmd_append(reply, reply_size, &pos, "ERR %.*s: expected name=value ", (int)name_len, p);
+            break;
+        }
+        char *end = NULL;
+        float value = strtof(eq + 1, &end);
+        if (end == eq + 1) {
+            cmd_append(reply, reply_size, &pos, "ERR %.*s: bad value ", (int)name_len, p);
+        } else if (!entry || !entry->is_param) {
+            cmd_append(reply, reply_size, &pos, "ERR %.*s: unknown ", (int)name_len, p);
+        } else {
+            esp_err_t ret = cmd_param_write(&entry->param, value);
+            if (ret == ESP_OK) {
+                ok++;
+            } else {
+                cmd_append(reply, reply_size, &pos, "ERR %s: %s [%g,%g] ", entry->name,
+                           ret == ESP_ERR_INVALID_ARG ? "out of range" : esp_err_to_name(ret),
+                           entry->param.min, entry->param.max);
+            }
+        }
+        p = end ? end : eq + 1;
+        p = cmd_skip_spaces(p + cmd_token_len(p, " \t"));
+    }
+    cmd_append(reply, reply_size, &pos, "OK %d", ok);
+}
+
+static void cmd_do_get(const char *args, char *reply, size_t reply_size)
+{
+    size_t pos = 0;
+    const char *p = cmd_skip_spaces(args);
+    if (*p == '\0' || *p == '*') {
+        for (int i = 0; i < cmd_entry_count; ++i) {
+            if (cmd_entries[i].is_param) cmd_append_param(reply, reply_size, &pos, &cmd_entries[i]);
+        }
+        return;
+    }
+    while (*p) {
+        size_t len = cmd_token_len(p, " \t");
+        cmd_entry_t *entry = cmd_lookup(p, len);
+        if (entry && entry->is_param) {
+            cmd_append_param(reply, reply_size, &pos, entry);
+        } else {
+            cmd_append(reply, reply_size, &pos, "%.*s=? ", (int)len, p);
+        }
+        p = cmd_skip_spaces(p + len);
+    }
+}
+
+static void cmd_do_help(const char *args, char *reply, size_t reply_size)
+{
+    size_t pos = 0;
+    cmd_append(reply, reply_size, &pos, "set get help ");
+    for (int i = 0; i < cmd_entry_count; ++i) {
+        if (!cmd_entries[i].is_param) cmd_append(reply, reply_size, &pos, "%s ", cmd_entries[i].name);
+    }
+}
+
+void cmd_dispatch(const char *line, char *reply, size_t reply_size)
+{
+    if (!line || !reply || reply_size == 0) return;
+    reply[0] = '\0';
+    const char *p = cmd_skip_spaces(line);
+    if (*p == '\0') return;
+
+    // 命令名以空格或冒号结束，冒号形式用于兼容 "V:12" 这类旧命令
+    size_t len = cmd_token_len(p, " \t:");
+    const char *args = p[len] ? p + len + 1 : p + len;
+    if (len == 3 && memcmp(p, "set", 3) == 0) {
+        cmd_do_set(args, reply, reply_size);
+        return;
+    }
+    if (len == 3 && memcmp(p, "get", 3) == 0) {
+        cmd_do_get(args, reply, reply_size);
+        return;
+    }
+    if (len == 4 && memcmp(p, "help", 4) == 0) {
+        cmd_do_help(args, reply, reply_size);
+        return;
+    }
+    cmd_entry_t *entry = cmd_lookup(p, len);
+    if (entry && !entry->is_param) {
+        entry->handler(args, reply, reply_size);
+    } else if (cmd_fallback) {
+        cmd_fallback(p, reply, reply_size);
+    } else {
+        snprintf(reply, reply_size, "ERR unknown command");
+    }
+}
+
+static void cmd_task(void *arg)
+{
+    static char reply[CMD_REPLY_SIZE];
+    uart_set_notify_task(xTaskGetCurrentTaskHandle());
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        uart_content_t *cmd;
+        while ((cmd = uart_read()) != NULL) {
+            ESP_LOGI(TAG, "Received command: %s", cmd->data);
+            TRACE_BEGIN(UART_CMD);
+            cmd_dispatch((const char *)cmd->data, reply, sizeof(reply));
+            TRACE_END(UART_CMD);
+            size_t len = strlen(reply);
+            if (len > 0) {
+                uart_write(cmd->uart_num, (const uint8_t *)reply, len);
+                uart_write(cmd->uart_num, (const uint8_t *)"\r\n", 2);
+            }
+        }
+    }
+}
+
+void cmd_service_start(void)
+{
+    xTaskCreatePinnedToCore(cmd_task, "cmd", CMD_TASK_STACK_SIZE, NULL, CMD_TASK_PRIORITY, NULL, APP_CORE_UI);
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "uart/uart_control.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define CMD_ENTRIES_MAX      48
+#define CMD_HASH_SIZE        128   // 必须为 2 的幂，且不小于 CMD_ENTRIES_MAX 的两倍
+#define CMD_NAME_MAX         16
+#define CMD_REPLY_SIZE       512
+#define CMD_TASK_STACK_SIZE  4096
+#define CMD_TASK_PRIORITY    4
+
+typedef enum {
+    CMD_PARAM_FLOAT,
+    CMD_PARAM_INT,
+    CMD_PARAM_BOOL,
+} cmd_param_type_t;
+
+// 参数访问器：ctx 为注册时传入的上下文（一般是模块句柄）
+typedef float (*cmd_param_getter_t)(void *ctx);
+typedef esp_err_t (*cmd_param_setter_t)(void *ctx, float value);
+
+// 命令处理函数：args 为命令名之后的内容，结果写入 reply
+typedef void (*cmd_handler_t)(const char *args, char *reply, size_t reply_size);
+
+typedef struct {
+    const char *name;
+    cmd_param_type_t type;
+    float min;
+    float max;
+    float *value;               // 非 NULL 时直接读写该变量
+    cmd_param_getter_t getter;  // value 为 NULL 时使用
+    cmd_param_setter_t setter;  // 可选，写入前已完成范围检查
+    void *ctx;
+} cmd_param_t;
+
+// 注册参数/命令，须在 cmd_service_start 之前完成；name 的生命周期须覆盖整个程序
+esp_err_t cmd_register_param(const cmd_param_t *param);
+esp_err_t cmd_register_command(const char *name, cmd_handler_t handler);
+// 未匹配到任何命令时调用，可用于兼容旧的命令格式
+void cmd_register_fallback(cmd_handler_t handler);
+
+esp_err_t cmd_param_set(const char *name, float value);
+esp_err_t cmd_param_get(const char *name, float *value);
+
+// 解析并执行一行命令，支持：
+//   set a=1 b=2   批量设置参数
+//   get a b / get *  查询参数
+//   <command> [args] 已注册的命令
+void cmd_dispatch(const char *line, char *reply, size_t reply_size);
+
+// 启动命令任务：等待 UART 完整行，分发后把结果写回来源端口
+void cmd_service_start(void);
\ No newline at end of file
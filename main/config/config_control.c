@@ -0,0 +1,300 @@
+#include "config_control.h"
+#include "pid/pid_control.h"
+#include "i2c_ina226_driver/i2c_ina226_driver.h"
+#include "nvs.h"
+#include "nvs_flash.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "CONFIG";
+
+typedef enum {
+    APP_CONFIG_FIELD_FLOAT,
+    APP_CONFIG_FIELD_U32,
+    APP_CONFIG_FIELD_U8,
+} app_config_field_type_t;
+
+typedef struct {
+    const char *param;       // 命令注册表中的参数名
+    uint16_t offset;
+    app_config_field_type_t type;
+} app_config_field_t;
+
+static const app_config_field_t s_fields[] = {
+    { "duty_min", offsetof(app_config_t, duty_min),    APP_CONFIG_FIELD_FLOAT },
+    { "duty_max", offsetof(app_config_t, duty_max),    APP_CONFIG_FIELD_FLOAT },
+    { "kp",       offsetof(app_config_t, kp),          APP_CONFIG_FIELD_FLOAT },
+    { "ki",       offsetof(app_config_t, ki),          APP_CONFIG_FIELD_FLOAT },
+    { "kd",       offsetof(app_config_t, kd),          APP_CONFIG_FIELD_FLOAT },
+    { "vset",     offsetof(app_config_t, vset),        APP_CONFIG_FIELD_FLOAT },
+    { "freq",     offsetof(app_config_t, pwm_freq_hz), APP_CONFIG_FIELD_U32 },
+    { "ina_avg",  offsetof(app_config_t, ina_avg),     APP_CONFIG_FIELD_U8 },
+    { "ina_ct",   offsetof(app_config_t, ina_ct),      APP_CONFIG_FIELD_U8 },
+    { "prot_oc",  offsetof(app_config_t, oc_limit_a),  APP_CONFIG_FIELD_FLOAT },
+    { "prot_ov",  offsetof(app_config_t, ov_limit_v),  APP_CONFIG_FIELD_FLOAT },
+    { "vin",      offsetof(app_config_t, vin),         APP_CONFIG_FIELD_FLOAT },
+    { "ff",       offsetof(app_config_t, ff_topology), APP_CONFIG_FIELD_U8 },
+};
+#define APP_CONFIG_FIELD_COUNT  (sizeof(s_fields) / sizeof(s_fields[0]))
+
+// NVS 中的存储格式：头部 + app_config_t，整体作为一个 blob 写入，NVS 保证单个 blob 的写入是原子的
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;           // 负载字节数
+    uint32_t crc32;          // 负载的 CRC-32
+} app_config_header_t;
+
+typedef struct {
+    app_config_header_t header;
+    app_config_t config;
+} app_config_blob_t;
+
+static app_config_source_t s_source = APP_CONFIG_SOURCE_DEFAULT;
+static bool s_nvs_ready = false;
+
+static uint32_t app_config_crc32(const uint8_t *data, size_t len)
+{
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < len; ++i) {
+        crc ^= data[i];
+        for (int b = 0; b < 8; ++b) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+        }
+    }
+    return ~crc;
+}
+
+static float app_config_field_get(const app_config_t *cfg, const app_config_field_t *f)
+{
+    const uint8_t *p = (const uint8_t *)cfg + f->offset;
+    switch (f->type) {
+        case APP_CONFIG_FIELD_FLOAT: return *(const float *)p;
+        case APP_CONFIG_FIELD_U32:   return (float)*(const uint32_t *)p;
+        case APP_CONFIG_FIELD_U8:    return (float)*p;
+    }
+    return 0.0f;
+}
+
+static void app_config_field_set(app_config_t *cfg, const app_config_field_t *f, float value)
+{
+    uint8_t *p = (uint8_t *)cfg + f->offset;
+    switch (f->type) {
+        case APP_CONFIG_FIELD_FLOAT: *(float *)p = value; break;
+        case APP_CONFIG_FIELD_U32:   *(uint32_t *)p = (uint32_t)(value + 0.5f); break;
+        case APP_CONFIG_FIELD_U8:    *p = (uint8_t)(value + 0.5f); break;
+    }
+}
+
+void app_config_defaults(app_config_t *cfg)
+{
+    if (!cfg) return;
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->vset = APP_CONFIG_DEFAULT_VSET;
+    cfg->kp = PID_KP;
+    cfg->ki = PID_KI;
+    cfg->kd = PID_KD;
+    cfg->duty_min = INPUT_LIMIT_MIN;
+    cfg->duty_max = INPUT_LIMIT_MAX;
+    cfg->pwm_freq_hz = APP_CONFIG_DEFAULT_PWM_FREQ_HZ;
+    cfg->ina_avg = (INA226_CONFIG_VALUE >> INA226_CONFIG_AVG_SHIFT) & 0x7;
+    cfg->ina_ct = (INA226_CONFIG_VALUE >> INA226_CONFIG_CT_SHIFT) & 0x7;
+    cfg->oc_limit_a = APP_CONFIG_DEFAULT_OC_LIMIT_A;
+    cfg->ov_limit_v = APP_CONFIG_DEFAULT_OV_LIMIT_V;
+    cfg->vin = APP_CONFIG_DEFAULT_VIN;
+    cfg->ff_topology = PID_FF_BUCK;
+}
+
+static esp_err_t app_config_nvs_init(void)
+{
+    if (s_nvs_ready) return ESP_OK;
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        // 分区格式不兼容，只能整体擦除
+        ESP_LOGW(TAG, "NVS partition needs erase: %s", esp_err_to_name(ret));
+        ret = nvs_flash_erase();
+        if (ret == ESP_OK) ret = nvs_flash_init();
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "NVS init failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    s_nvs_ready = true;
+    return ESP_OK;
+}
+
+static esp_err_t app_config_read(app_config_t *cfg)
+{
+    esp_err_t ret = app_config_nvs_init();
+    if (ret != ESP_OK) return ret;
+
+    nvs_handle_t handle;
+    ret = nvs_open(APP_CONFIG_NAMESPACE, NVS_READONLY, &handle);
+    if (ret != ESP_OK) return ret == ESP_ERR_NVS_NOT_FOUND ? ESP_ERR_NOT_FOUND : ret;
+
+    app_config_blob_t blob;
+    size_t len = sizeof(blob);
+    ret = nvs_get_blob(handle, APP_CONFIG_KEY, &blob, &len);
+    nvs_close(handle);
+    if (ret == ESP_ERR_NVS_NOT_FOUND) return ESP_ERR_NOT_FOUND;
+    // 比当前结构体还大的只可能来自更新的固件
+    if (ret == ESP_ERR_NVS_INVALID_LENGTH) return ESP_ERR_INVALID_VERSION;
+    if (ret != ESP_OK) return ret;
+
+    if (len < sizeof(blob.header) || blob.header.magic != APP_CONFIG_MAGIC ||
+        blob.header.size != len - sizeof(blob.header)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (app_config_crc32((const uint8_t *)&blob.config, blob.header.size) != blob.header.crc32) {
+        return ESP_ERR_INVALID_CRC;
+    }
+    if (blob.header.version > APP_CONFIG_VERSION) return ESP_ERR_INVALID_VERSION;
+
+    app_config_defaults(cfg);
+    memcpy(cfg, &blob.config, blob.header.size);
+    return blob.header.version == APP_CONFIG_VERSION && blob.header.size == sizeof(*cfg) ? ESP_OK : ESP_ERR_NOT_FINISHED;
+}
+
+esp_err_t app_config_load(app_config_t *cfg)
+{
+    if (!cfg) return ESP_ERR_INVALID_ARG;
+    app_config_t loaded;
+    esp_err_t ret = app_config_read(&loaded);
+    if (ret == ESP_OK || ret == ESP_ERR_NOT_FINISHED) {
+        *cfg = loaded;
+        s_source = ret == ESP_OK ? APP_CONFIG_SOURCE_NVS : APP_CONFIG_SOURCE_MIGRATED;
+        ESP_LOGI(TAG, "Config loaded from NVS%s", ret == ESP_OK ? "" : " (older version, new fields defaulted)");
+        return ESP_OK;
+    }
+    app_config_defaults(cfg);
+    if (ret == ESP_ERR_NOT_FOUND) {
+        s_source = APP_CONFIG_SOURCE_DEFAULT;
+        ESP_LOGI(TAG, "No saved config, using defaults");
+    } else {
+        s_source = APP_CONFIG_SOURCE_INVALID;
+        ESP_LOGW(TAG, "Saved config rejected (%s), using defaults", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+esp_err_t app_config_save(const app_config_t *cfg)
+{
+    if (!cfg) return ESP_ERR_INVALID_ARG;
+    esp_err_t ret = app_config_nvs_init();
+    if (ret != ESP_OK) return ret;
+
+    app_config_blob_t blob = {
+        .header = {
+            .magic = APP_CONFIG_MAGIC,
+            .version = APP_CONFIG_VERSION,
+            .size = sizeof(app_config_t),
+        },
+        .config = *cfg,
+    };
+    blob.header.crc32 = app_config_crc32((const uint8_t *)&blob.config, sizeof(blob.config));
+
+    nvs_handle_t handle;
+    ret = nvs_open(APP_CONFIG_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret != ESP_OK) return ret;
+    ret = nvs_set_blob(handle, APP_CONFIG_KEY, &blob, sizeof(blob));
+    if (ret == ESP_OK) ret = nvs_commit(handle);
+    nvs_close(handle);
+    if (ret == ESP_OK) s_source = APP_CONFIG_SOURCE_NVS;
+    return ret;
+}
+
+esp_err_t app_config_erase(void)
+{
+    esp_err_t ret = app_config_nvs_init();
+    if (ret != ESP_OK) return ret;
+    nvs_handle_t handle;
+    ret = nvs_open(APP_CONFIG_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret != ESP_OK) return ret;
+    ret = nvs_erase_key(handle, APP_CONFIG_KEY);
+    if (ret == ESP_ERR_NVS_NOT_FOUND) ret = ESP_OK;
+    if (ret == ESP_OK) ret = nvs_commit(handle);
+    nvs_close(handle);
+    return ret;
+}
+
+int app_config_apply(const app_config_t *cfg)
+{
+    if (!cfg) return 0;
+    int failed = 0;
+    for (size_t i = 0; i < APP_CONFIG_FIELD_COUNT; ++i) {
+        const app_config_field_t *f = &s_fields[i];
+        float value = app_config_field_get(cfg, f);
+        float current;
+        if (cmd_param_get(f->param, &current) == ESP_OK && current == value) continue;
+        esp_err_t ret = cmd_param_set(f->param, value);
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "Failed to apply %s=%g: %s", f->param, value, esp_err_to_name(ret));
+            failed++;
+        }
+    }
+    return failed;
+}
+
+void app_config_capture(app_config_t *cfg)
+{
+    if (!cfg) return;
+    for (size_t i = 0; i < APP_CONFIG_FIELD_COUNT; ++i) {
+        float value;
+        if (cmd_param_get(s_fields[i].param, &value) == ESP_OK) app_config_field_set(cfg, &s_fields[i], value);
+    }
+}
+
+app_config_source_t app_config_source(void)
+{
+    return s_source;
+}
+
+static const char *app_config_source_name(app_config_source_t source)
+{
+    switch (source) {
+        case APP_CONFIG_SOURCE_NVS:      return "nvs";
+        case APP_CONFIG_SOURCE_MIGRATED: return "migrated";
+        case APP_CONFIG_SOURCE_INVALID:  return "invalid";
+        default:                         return "default";
+    }
+}
+
+// cfg：save 保存当前运行值，load 重新读取并下发，default 下发默认值（不保存），erase 删除已保存的配置
+static void cmd_config(const char *args, char *reply, size_t reply_size)
+{
+    while (*args == ' ') args++;
+    app_config_t cfg;
+    esp_err_t ret = ESP_OK;
+    if (strncmp(args, "save", 4) == 0) {
+        app_config_defaults(&cfg);
+        app_config_capture(&cfg);
+        ret = app_config_save(&cfg);
+    } else if (strncmp(args, "load", 4) == 0) {
+        ret = app_config_load(&cfg);
+        if (ret == ESP_OK) app_config_apply(&cfg);
+    } else if (strncmp(args, "default", 7) == 0) {
+        app_config_defaults(&cfg);
+        app_config_apply(&cfg);
+    } else if (strncmp(args, "erase", 5) == 0) {
+        ret = app_config_erase();
+    } else {
+        int len = snprintf(reply, reply_size, "src=%s v=%d", app_config_source_name(s_source), APP_CONFIG_VERSION);
+        app_config_defaults(&cfg);
+        app_config_capture(&cfg);
+        for (size_t i = 0; i < APP_CONFIG_FIELD_COUNT && len > 0 && (size_t)len < reply_size; ++i) {
+            len += snprintf(reply + len, reply_size - len, " %s=%g", s_fields[i].param, app_config_field_get(&cfg, &s_fields[i]));
+        }
+        return;
+    }
+    if (ret == ESP_OK) {
+        snprintf(reply, reply_size, "OK");
+    } else {
+        snprintf(reply, reply_size, "ERR %s", esp_err_to_name(ret));
+    }
+}
+
+void app_config_register_commands(void)
+{
+    cmd_register_command("cfg", cmd_config);
+}
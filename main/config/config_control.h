@@ -0,0 +1,66 @@
+// 配置存储模块头文件：把 PID 参数、输出限幅、前馈、目标电压、PWM 频率、INA226 采样与保护阈值保存在 NVS
+// 上电时只读一次整块配置到内存，校验魔数、版本与 CRC-32，任何一项不对就回退到默认值，不会带着坏配置启动
+// 字段与命令注册表中的参数一一对应，下发与保存都经过注册表，范围检查和 setter 只有一份
+
+#pragma once
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "cmd/cmd_registry.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define APP_CONFIG_NAMESPACE            "app"
+#define APP_CONFIG_KEY                  "cfg"
+#define APP_CONFIG_MAGIC                0x47464350u   // "PCFG"
+// 新版本只在 app_config_t 末尾追加字段并加一；旧版本的配置读入后缺少的字段保持默认值
+#define APP_CONFIG_VERSION              3
+
+#define APP_CONFIG_DEFAULT_VSET         10.0f
+#define APP_CONFIG_DEFAULT_PWM_FREQ_HZ  20000
+#define APP_CONFIG_DEFAULT_OC_LIMIT_A   3.0f
+#define APP_CONFIG_DEFAULT_OV_LIMIT_V   20.0f
+#define APP_CONFIG_DEFAULT_VIN          24.0f
+
+typedef struct {
+    float vset;              // 目标母线电压 (V)
+    float kp;
+    float ki;
+    float kd;
+    float duty_min;          // PID 输出下限 (%)
+    float duty_max;          // PID 输出上限 (%)
+    uint32_t pwm_freq_hz;
+    uint8_t ina_avg;         // INA226 平均次数编码
+    uint8_t ina_ct;          // INA226 转换时间编码
+    // 版本 2
+    float oc_limit_a;        // 过流保护阈值
+    float ov_limit_v;        // 过压保护阈值
+    // 版本 3
+    float vin;               // 前馈使用的输入电压 (V)
+    uint8_t ff_topology;     // pid_ff_topology_t
+} app_config_t;
+
+// 配置来源，可用 "cfg" 命令查看
+typedef enum {
+    APP_CONFIG_SOURCE_DEFAULT,     // NVS 中没有配置
+    APP_CONFIG_SOURCE_NVS,
+    APP_CONFIG_SOURCE_MIGRATED,    // 由旧版本配置补齐默认值得到
+    APP_CONFIG_SOURCE_INVALID,     // NVS 中的配置损坏或版本过新，已使用默认值
+} app_config_source_t;
+
+void app_config_defaults(app_config_t *cfg);
+
+// 初始化 NVS 并读取配置；失败时 cfg 为默认值，返回值说明原因，调用方可以照常启动
+esp_err_t app_config_load(app_config_t *cfg);
+esp_err_t app_config_save(const app_config_t *cfg);
+esp_err_t app_config_erase(void);
+
+// 经命令注册表逐项写入参数，与当前值相同的跳过；须在各模块注册参数之后调用，返回写入失败的项数
+int app_config_apply(const app_config_t *cfg);
+// 从命令注册表读回当前运行值
+void app_config_capture(app_config_t *cfg);
+
+app_config_source_t app_config_source(void);
+
+// 注册 "cfg" 命令：cfg（查看）/ cfg save / cfg load / cfg default / cfg erase
+void app_config_register_commands(void);
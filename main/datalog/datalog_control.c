@@ -0,0 +1,372 @@
+#include "datalog_control.h"
+#include "esp_partition.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 后台任务擦写 flash 时，控制环与中断仍在另一个核心上从 flash 取指；
+// 没有自动挂起时擦写期间缓存被关闭，控制环会被卡住一整次扇区擦除（几十毫秒）
+#if !CONFIG_IDF_TARGET_LINUX && !CONFIG_SPI_FLASH_AUTO_SUSPEND
+#error "datalog requires CONFIG_SPI_FLASH_AUTO_SUSPEND, otherwise flash erase stalls the control loop"
+#endif
+
+static const char *TAG = "DATALOG";
+
+typedef struct {
+    datalog_block_header_t header;
+    uint8_t payload[DATALOG_BLOCK_SIZE - sizeof(datalog_block_header_t)];
+} datalog_block_t;
+
+static const esp_partition_t *s_partition = NULL;
+static uint32_t s_sectors = 0;
+
+// 内存块池：free_ring 由后台任务归还、控制任务取用，full_ring 方向相反，都是单生产者单消费者
+static datalog_block_t s_pool[DATALOG_POOL_BLOCKS];
+static uint8_t s_free_storage[DATALOG_POOL_BLOCKS];
+static uint8_t s_full_storage[DATALOG_POOL_BLOCKS];
+static ring_buffer_t s_free_ring;
+static ring_buffer_t s_full_ring;
+static int s_current = -1;          // 控制任务正在填充的块
+static volatile bool s_flush_request = false;
+static volatile bool s_recording = false;
+
+// 以下只由后台任务修改
+static TaskHandle_t s_datalog_task = NULL;
+static datalog_block_t s_index_block;
+static uint32_t s_next_sector = 0;
+static uint32_t s_next_sequence = 0;
+static uint16_t s_session = 0;
+static datalog_stats_t s_stats;
+static volatile bool s_erase_request = false;
+
+static uint16_t datalog_crc16(const uint8_t *data, size_t len)
+{
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; ++i) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int b = 0; b < 8; ++b) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static size_t datalog_payload_size(const datalog_block_header_t *h)
+{
+    size_t elem = (h->type == DATALOG_BLOCK_INDEX) ? sizeof(datalog_index_entry_t) : sizeof(datalog_sample_t);
+    return (size_t)h->count * elem;
+}
+
+static bool datalog_read_header(uint32_t sector, datalog_block_header_t *h)
+{
+    if (esp_partition_read(s_partition, (size_t)sector * DATALOG_BLOCK_SIZE, h, sizeof(*h)) != ESP_OK) return false;
+    return h->magic == DATALOG_MAGIC && h->version == DATALOG_VERSION &&
+           datalog_payload_size(h) <= DATALOG_BLOCK_SIZE - sizeof(*h);
+}
+
+// 扇区按写入顺序循环使用，找到序号最大的有效块即可确定写入位置
+static void datalog_scan(void)
+{
+    bool found = false;
+    uint32_t newest_seq = 0, newest_sector = 0;
+    uint16_t newest_session = 0;
+    for (uint32_t s = 0; s < s_sectors; ++s) {
+        datalog_block_header_t h;
+        if (!datalog_read_header(s, &h)) continue;
+        if (!found || (int32_t)(h.sequence - newest_seq) > 0) {
+            found = true;
+            newest_seq = h.sequence;
+            newest_sector = s;
+            newest_session = h.session;
+        }
+    }
+    if (found) {
+        s_next_sector = (newest_sector + 1) % s_sectors;
+        s_next_sequence = newest_seq + 1;
+        s_session = newest_session + 1;
+        s_stats.newest_sequence = newest_seq;
+    } else {
+        s_next_sector = 0;
+        s_next_sequence = 0;
+        s_session = 0;
+    }
+}
+
+// 擦除并写入一个扇区，返回写入位置
+static esp_err_t datalog_write_block(datalog_block_t *block, uint32_t *sector)
+{
+    block->header.magic = DATALOG_MAGIC;
+    block->header.version = DATALOG_VERSION;
+    block->header.session = s_session;
+    block->header.sequence = s_next_sequence;
+    block->header.crc16 = datalog_crc16(block->payload, datalog_payload_size(&block->header));
+
+    int64_t t0 = esp_timer_get_time();
+    size_t offset = (size_t)s_next_sector * DATALOG_BLOCK_SIZE;
+    esp_err_t ret = esp_partition_erase_range(s_partition, offset, DATALOG_BLOCK_SIZE);
+    if (ret == ESP_OK) {
+        // 只写有效部分，未用的尾部保持擦除状态
+        size_t len = sizeof(block->header) + datalog_payload_size(&block->header);
+        ret = esp_partition_write(s_partition, offset, block, (len + 15) & ~(size_t)15);
+    }
+    uint32_t elapsed = (uint32_t)(esp_timer_get_time() - t0);
+    if (elapsed > s_stats.max_write_us) s_stats.max_write_us = elapsed;
+    if (ret != ESP_OK) {
+        s_stats.write_errors++;
+        return ret;
+    }
+    *sector = s_next_sector;
+    s_stats.newest_sequence = s_next_sequence;
+    s_stats.blocks_written++;
+    s_next_sequence++;
+    s_next_sector = (s_next_sector + 1) % s_sectors;
+    return ESP_OK;
+}
+
+static void datalog_index_add(const datalog_block_t *block, uint32_t sector)
+{
+    const datalog_sample_t *samples = (const datalog_sample_t *)block->payload;
+    uint16_t vmin = 0xFFFF, vmax = 0;
+    for (int i = 0; i < block->header.count; ++i) {
+        if (samples[i].bus_voltage_mv < vmin) vmin = samples[i].bus_voltage_mv;
+        if (samples[i].bus_voltage_mv > vmax) vmax = samples[i].bus_voltage_mv;
+    }
+    datalog_index_entry_t *entries = (datalog_index_entry_t *)s_index_block.payload;
+    entries[s_index_block.header.count++] = (datalog_index_entry_t){
+        .sequence = block->header.sequence,
+        .sector = sector,
+        .first_timestamp_us = block->header.first_timestamp_us,
+        .count = block->header.count,
+        .v_min_mv = vmin,
+        .v_max_mv = vmax,
+    };
+    if (s_index_block.header.count < DATALOG_INDEX_INTERVAL) return;
+
+    s_index_block.header.type = DATALOG_BLOCK_INDEX;
+    s_index_block.header.first_timestamp_us = entries[0].first_timestamp_us;
+    uint32_t index_sector;
+    datalog_write_block(&s_index_block, &index_sector);
+    s_index_block.header.count = 0;
+}
+
+static void datalog_task(void *arg)
+{
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (s_erase_request) {
+            ESP_LOGI(TAG, "Erasing %" PRIu32 " sectors", s_sectors);
+            esp_partition_erase_range(s_partition, 0, (size_t)s_sectors * DATALOG_BLOCK_SIZE);
+            s_next_sector = 0;
+            s_index_block.header.count = 0;
+            s_stats.newest_sequence = s_next_sequence - 1;
+            s_erase_request = false;
+        }
+        uint8_t idx;
+        while (ring_pop(&s_full_ring, &idx)) {
+            datalog_block_t *block = &s_pool[idx];
+            uint32_t sector;
+            if (datalog_write_block(block, &sector) == ESP_OK) {
+                datalog_index_add(block, sector);
+            }
+            ring_push(&s_free_ring, &idx);
+        }
+    }
+}
+
+esp_err_t datalog_init(void)
+{
+    s_partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, DATALOG_PARTITION_LABEL);
+    if (!s_partition) {
+        ESP_LOGW(TAG, "Partition \"%s\" not found, logging disabled", DATALOG_PARTITION_LABEL);
+        return ESP_ERR_NOT_FOUND;
+    }
+    s_sectors = s_partition->size / DATALOG_BLOCK_SIZE;
+    memset(&s_stats, 0, sizeof(s_stats));
+    datalog_scan();
+
+    ring_init(&s_free_ring, s_free_storage, sizeof(uint8_t), DATALOG_POOL_BLOCKS);
+    ring_init(&s_full_ring, s_full_storage, sizeof(uint8_t), DATALOG_POOL_BLOCKS);
+    for (uint8_t i = 0; i < DATALOG_POOL_BLOCKS; ++i) {
+        ring_push(&s_free_ring, &i);
+    }
+    s_index_block.header.count = 0;
+
+    xTaskCreatePinnedToCore(datalog_task, "datalog", DATALOG_TASK_STACK_SIZE, NULL, DATALOG_TASK_PRIORITY, &s_datalog_task, APP_CORE_UI);
+    ESP_LOGI(TAG, "Datalog: %" PRIu32 " sectors (%" PRIu32 " samples/block), session %u, next sequence %" PRIu32,
+             s_sectors, (uint32_t)DATALOG_SAMPLES_PER_BLOCK, s_session, s_next_sequence);
+    return ESP_OK;
+}
+
+void datalog_set_recording(bool enable)
+{
+    if (!s_datalog_task) return;
+    if (!enable) s_flush_request = true;
+    s_recording = enable;
+}
+
+static void datalog_submit_current(void)
+{
+    uint8_t idx = (uint8_t)s_current;
+    ring_push(&s_full_ring, &idx);
+    s_current = -1;
+    xTaskNotifyGive(s_datalog_task);
+}
+
+void datalog_push(int64_t timestamp_us, float bus_voltage_v, float current_a, float duty_percent)
+{
+    if (!s_datalog_task) return;
+    if (s_flush_request) {
+        s_flush_request = false;
+        if (s_current >= 0 && s_pool[s_current].header.count > 0) datalog_submit_current();
+    }
+    if (!s_recording) return;
+
+    if (s_current < 0) {
+        uint8_t idx;
+        if (!ring_pop(&s_free_ring, &idx)) {
+            s_stats.samples_dropped++;
+            return;
+        }
+        s_current = idx;
+        s_pool[idx].header.type = DATALOG_BLOCK_DATA;
+        s_pool[idx].header.count = 0;
+        s_pool[idx].header.first_timestamp_us = timestamp_us;
+    }
+    datalog_block_t *block = &s_pool[s_current];
+    datalog_sample_t *sample = &((datalog_sample_t *)block->payload)[block->header.count++];
+    sample->offset_us = (uint32_t)(timestamp_us - block->header.first_timestamp_us);
+    sample->bus_voltage_mv = (uint16_t)app_clamp_fixed(bus_voltage_v * 1000.0f, 0.0f, UINT16_MAX);
+    sample->current_01ma = (int16_t)app_clamp_fixed(current_a * 10000.0f, INT16_MIN, INT16_MAX);
+    sample->duty_001 = (uint16_t)app_clamp_fixed(duty_percent * 100.0f, 0.0f, UINT16_MAX);
+    if (block->header.count >= DATALOG_SAMPLES_PER_BLOCK) datalog_submit_current();
+}
+
+void datalog_request_flush(void)
+{
+    s_flush_request = true;
+}
+
+void datalog_get_stats(datalog_stats_t *stats)
+{
+    if (!stats) return;
+    *stats = s_stats;
+    stats->recording = s_recording;
+    stats->sectors = s_sectors;
+    stats->session = s_session;
+}
+
+// 由序号定位扇区：块按序号连续写在相邻扇区，以最新的块为基准往回推
+static bool datalog_find_block(uint32_t sequence, uint32_t *sector, datalog_block_header_t *h)
+{
+    uint32_t newest = s_next_sequence - 1;
+    uint32_t back = newest - sequence;
+    if (s_next_sequence == 0 || back >= s_sectors) return false;
+    *sector = (s_next_sector + s_sectors - 1 - back) % s_sectors;
+    return datalog_read_header(*sector, h) && h->sequence == sequence;
+}
+
+static void datalog_print_index(const datalog_block_header_t *h, uint32_t sector)
+{
+    static datalog_index_entry_t entries[DATALOG_INDEX_INTERVAL];
+    size_t len = datalog_payload_size(h);
+    if (esp_partition_read(s_partition, (size_t)sector * DATALOG_BLOCK_SIZE + sizeof(*h), entries, len) != ESP_OK) return;
+    for (int i = 0; i < h->count; ++i) {
+        printf("LOGIDX %u %" PRIu32 " %" PRId64 " %u %u %u\n", h->session, entries[i].sequence,
+               entries[i].first_timestamp_us, entries[i].count, entries[i].v_min_mv, entries[i].v_max_mv);
+    }
+}
+
+// log index [n]：从最新往回找 n 个索引块并输出其中的条目，每个条目对应一个数据块
+static int datalog_cmd_index(int wanted)
+{
+    int printed = 0;
+    for (uint32_t back = 0; back < s_sectors && back < s_next_sequence && printed < wanted; ++back) {
+        uint32_t sector = (s_next_sector + s_sectors - 1 - back) % s_sectors;
+        datalog_block_header_t h;
+        if (!datalog_read_header(sector, &h) || h.type != DATALOG_BLOCK_INDEX) continue;
+        datalog_print_index(&h, sector);
+        printed++;
+    }
+    return printed;
+}
+
+// log export <seq> [n]：输出连续 n 个数据块的样本，每行 "LOG 会话 时刻us 电压mV 电流0.1mA 占空比0.01%"
+static int datalog_cmd_export(uint32_t sequence, int blocks)
+{
+    static datalog_sample_t samples[DATALOG_SAMPLES_PER_BLOCK];
+    int exported = 0;
+    for (int n = 0; n < blocks; ++n, ++sequence) {
+        uint32_t sector;
+        datalog_block_header_t h;
+        if (!datalog_find_block(sequence, &sector, &h)) break;
+        if (h.type != DATALOG_BLOCK_DATA) continue;
+        size_t len = datalog_payload_size(&h);
+        if (esp_partition_read(s_partition, (size_t)sector * DATALOG_BLOCK_SIZE + sizeof(h), samples, len) != ESP_OK) break;
+        if (datalog_crc16((const uint8_t *)samples, len) != h.crc16) {
+            printf("LOGERR %" PRIu32 " crc\n", sequence);
+            continue;
+        }
+        for (int i = 0; i < h.count; ++i) {
+            printf("LOG %u %" PRId64 " %u %d %u\n", h.session, h.first_timestamp_us + samples[i].offset_us,
+                   samples[i].bus_voltage_mv, samples[i].current_01ma, samples[i].duty_001);
+        }
+        exported++;
+    }
+    fflush(stdout);
+    return exported;
+}
+
+static void cmd_log(const char *args, char *reply, size_t reply_size)
+{
+    if (!s_datalog_task) {
+        snprintf(reply, reply_size, "ERR no datalog partition");
+        return;
+    }
+    while (*args == ' ') args++;
+    if (strncmp(args, "on", 2) == 0) {
+        datalog_set_recording(true);
+        snprintf(reply, reply_size, "OK log on");
+    } else if (strncmp(args, "off", 3) == 0) {
+        datalog_set_recording(false);
+        snprintf(reply, reply_size, "OK log off");
+    } else if (strncmp(args, "flush", 5) == 0) {
+        datalog_request_flush();
+        snprintf(reply, reply_size, "OK flush requested");
+    } else if (strncmp(args, "erase", 5) == 0) {
+        if (s_recording) {
+            snprintf(reply, reply_size, "ERR stop logging first");
+            return;
+        }
+        s_erase_request = true;
+        xTaskNotifyGive(s_datalog_task);
+        snprintf(reply, reply_size, "OK erasing");
+    } else if (strncmp(args, "index", 5) == 0) {
+        int n = atoi(args + 5);
+        snprintf(reply, reply_size, "OK %d index blocks", datalog_cmd_index(n > 0 ? n : 1));
+    } else if (strncmp(args, "export", 6) == 0) {
+        char *end = NULL;
+        unsigned long seq = strtoul(args + 6, &end, 10);
+        if (end == args + 6) {
+            snprintf(reply, reply_size, "ERR usage: log export <seq> [blocks]");
+            return;
+        }
+        int n = atoi(end);
+        snprintf(reply, reply_size, "OK %d blocks", datalog_cmd_export((uint32_t)seq, n > 0 ? n : 1));
+    } else {
+        datalog_stats_t st;
+        datalog_get_stats(&st);
+        snprintf(reply, reply_size,
+                 "on=%d session=%u newest=%" PRIu32 " written=%" PRIu32 " sectors=%" PRIu32
+                 " dropped=%" PRIu32 " errors=%" PRIu32 " max_write=%" PRIu32 "us",
+                 st.recording, st.session, st.newest_sequence, st.blocks_written,
+                 st.sectors, st.samples_dropped, st.write_errors, st.max_write_us);
+    }
+}
+
+void datalog_register_commands(void)
+{
+    cmd_register_command("log", cmd_log);
+}
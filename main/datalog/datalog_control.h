@@ -0,0 +1,85 @@
+// 数据记录模块头文件：把电压/电流/占空比样本长时间记录到 flash 的 datalog 分区
+// 样本先攒进内存块，块满后交给后台任务整块写入；分区当作循环日志按扇区顺序擦写，各扇区磨损均匀
+// 控制环只做一次内存拷贝，擦写延迟全部由后台任务承担
+// 每写满 DATALOG_INDEX_INTERVAL 个数据块追加一个索引块，记录这些块的序号、时间与电压范围，用于快速定位
+
+#pragma once
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "cmd/cmd_registry.h"
+#include "ring/ring_buffer.h"
+#include "global_params.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define DATALOG_PARTITION_LABEL   "datalog"
+#define DATALOG_BLOCK_SIZE        4096    // 与 flash 扇区大小一致，一块一次擦写
+#define DATALOG_POOL_BLOCKS       4       // 内存块数量，必须为 2 的幂
+#define DATALOG_INDEX_INTERVAL    64      // 每多少个数据块写一个索引块
+#define DATALOG_MAGIC             0x474C5450u   // "PTLG"
+#define DATALOG_VERSION           1
+#define DATALOG_TASK_STACK_SIZE   4096
+#define DATALOG_TASK_PRIORITY     (tskIDLE_PRIORITY + 2)
+
+typedef enum {
+    DATALOG_BLOCK_DATA = 1,
+    DATALOG_BLOCK_INDEX = 2,
+} datalog_block_type_t;
+
+// 块头，小端序，主机端按相同布局解析
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint32_t sequence;             // 全局递增的块序号，上电后从分区中最新的块接着往下编
+    uint16_t session;              // 每次上电加一，区分不同的运行
+    uint8_t type;                  // datalog_block_type_t
+    uint8_t version;
+    uint16_t count;                // 样本数或索引条目数
+    uint16_t crc16;                // 负载的 CRC-16/CCITT-FALSE
+    int64_t first_timestamp_us;    // 块内第一个样本的 esp_timer 时刻
+} datalog_block_header_t;
+
+// 一个样本 10 字节，时间为相对块头 first_timestamp_us 的偏移
+typedef struct __attribute__((packed)) {
+    uint32_t offset_us;
+    uint16_t bus_voltage_mv;
+    int16_t current_01ma;          // 0.1 mA/bit
+    uint16_t duty_001;             // 0.01 %/bit
+} datalog_sample_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t sequence;
+    uint32_t sector;
+    int64_t first_timestamp_us;
+    uint16_t count;
+    uint16_t v_min_mv;
+    uint16_t v_max_mv;
+    uint16_t reserved;
+} datalog_index_entry_t;
+
+#define DATALOG_SAMPLES_PER_BLOCK ((DATALOG_BLOCK_SIZE - sizeof(datalog_block_header_t)) / sizeof(datalog_sample_t))
+
+typedef struct {
+    bool recording;
+    uint32_t sectors;              // 分区扇区数
+    uint32_t newest_sequence;      // 最近写入的块序号
+    uint32_t blocks_written;       // 本次上电写入的块数
+    uint32_t samples_dropped;      // 内存块用尽而丢弃的样本
+    uint32_t write_errors;
+    uint32_t max_write_us;         // 单块擦除 + 写入的最长耗时
+    uint16_t session;
+} datalog_stats_t;
+
+// 查找分区并扫描已有日志，从最新的块之后继续；分区不存在时返回 ESP_ERR_NOT_FOUND
+esp_err_t datalog_init(void);
+void datalog_set_recording(bool enable);
+// 放入一个样本，不阻塞，只能由一个任务调用（控制任务）
+void datalog_push(int64_t timestamp_us, float bus_voltage_v, float current_a, float duty_percent);
+// 请求把未满的内存块写出，由下一次 datalog_push 提交
+void datalog_request_flush(void);
+void datalog_get_stats(datalog_stats_t *stats);
+
+// 注册 "log" 命令：log on|off|flush|erase|index [n]|export <seq> [n]，不带参数时输出状态
+void datalog_register_commands(void);
@@ -0,0 +1,284 @@
+#include "filter_control.h"
+#include <math.h>
+#include <string.h>
+#if FILTER_USE_ESP_DSP
+#include "dsps_biquad.h"
+#endif
+
+// RBJ 公式的公共部分：按 a0 归一化后写入系数
+static void filter_biquad_set(filter_biquad_t *bq, float b0, float b1, float b2, float a0, float a1, float a2)
+{
+    bq->coef[0] = b0 / a0;
+    bq->coef[1] = b1 / a0;
+    bq->coef[2] = b2 / a0;
+    bq->coef[3] = a1 / a0;
+    bq->coef[4] = a2 / a0;
+    bq->w[0] = 0.0f;
+    bq->w[1] = 0.0f;
+}
+
+void filter_biquad_lowpass(filter_biquad_t *bq, float fc, float fs, float q)
+{
+    float w0 = 2.0f * (float)M_PI * fc / fs;
+    float cw = cosf(w0), alpha = sinf(w0) / (2.0f * q);
+    filter_biquad_set(bq, (1.0f - cw) / 2.0f, 1.0f - cw, (1.0f - cw) / 2.0f, 1.0f + alpha, -2.0f * cw, 1.0f - alpha);
+}
+
+void filter_biquad_highpass(filter_biquad_t *bq, float fc, float fs, float q)
+{
+    float w0 = 2.0f * (float)M_PI * fc / fs;
+    float cw = cosf(w0), alpha = sinf(w0) / (2.0f * q);
+    filter_biquad_set(bq, (1.0f + cw) / 2.0f, -(1.0f + cw), (1.0f + cw) / 2.0f, 1.0f + alpha, -2.0f * cw, 1.0f - alpha);
+}
+
+void filter_biquad_notch(filter_biquad_t *bq, float fc, float fs, float q)
+{
+    float w0 = 2.0f * (float)M_PI * fc / fs;
+    float cw = cosf(w0), alpha = sinf(w0) / (2.0f * q);
+    filter_biquad_set(bq, 1.0f, -2.0f * cw, 1.0f, 1.0f + alpha, -2.0f * cw, 1.0f - alpha);
+}
+
+void filter_cascade_butterworth_lowpass(filter_biquad_cascade_t *c, int order, float fc, float fs)
+{
+    if (!c) return;
+    int stages = (order + 1) / 2;
+    if (stages < 1) stages = 1;
+    if (stages > FILTER_BIQUAD_STAGES_MAX) stages = FILTER_BIQUAD_STAGES_MAX;
+    c->stage_count = stages;
+    // 第 k 节 Q = 1 / (2 sin((2k+1)π / 4N))
+    for (int k = 0; k < stages; ++k) {
+        float q = 1.0f / (2.0f * sinf((2 * k + 1) * (float)M_PI / (4.0f * stages)));
+        filter_biquad_lowpass(&c->stages[k], fc, fs, q);
+    }
+}
+
+int filter_cascade_add(filter_biquad_cascade_t *c, const filter_biquad_t *bq)
+{
+    if (!c || !bq || c->stage_count >= FILTER_BIQUAD_STAGES_MAX) return -1;
+    c->stages[c->stage_count] = *bq;
+    c->stages[c->stage_count].w[0] = 0.0f;
+    c->stages[c->stage_count].w[1] = 0.0f;
+    return c->stage_count++;
+}
+
+void filter_cascade_reset(filter_biquad_cascade_t *c)
+{
+    if (!c) return;
+    for (int k = 0; k < c->stage_count; ++k) {
+        c->stages[k].w[0] = 0.0f;
+        c->stages[k].w[1] = 0.0f;
+    }
+}
+
+// 直接 II 型单样本更新，状态布局与 dsps_biquad_f32 相同
+static inline float filter_biquad_step(filter_biquad_t *bq, float x)
+{
+    const float *a = bq->coef;
+    float d = x - a[3] * bq->w[0] - a[4] * bq->w[1];
+    float y = a[0] * d + a[1] * bq->w[0] + a[2] * bq->w[1];
+    bq->w[1] = bq->w[0];
+    bq->w[0] = d;
+    return y;
+}
+
+float filter_cascade_process(filter_biquad_cascade_t *c, float x)
+{
+    for (int k = 0; k < c->stage_count; ++k) {
+        x = filter_biquad_step(&c->stages[k], x);
+    }
+    return x;
+}
+
+void filter_cascade_process_block(filter_biquad_cascade_t *c, const float *in, float *out, int len)
+{
+    if (!c || len <= 0) return;
+    if (c->stage_count == 0) {
+        if (out != in) memmove(out, in, len * sizeof(float));
+        return;
+    }
+    // 逐节处理整块：第一节 in -> out，其余节在 out 上原地进行，系数与状态留在寄存器中
+    for (int k = 0; k < c->stage_count; ++k) {
+        const float *src = k == 0 ? in : out;
+#if FILTER_USE_ESP_DSP
+        dsps_biquad_f32(src, out, len, c->stages[k].coef, c->stages[k].w);
+#else
+        filter_biquad_t bq = c->stages[k];
+        for (int i = 0; i < len; ++i) {
+            out[i] = filter_biquad_step(&bq, src[i]);
+        }
+        c->stages[k].w[0] = bq.w[0];
+        c->stages[k].w[1] = bq.w[1];
+#endif
+    }
+}
+
+void filter_moving_avg_init(filter_moving_avg_t *f, int size)
+{
+    if (!f) return;
+    memset(f, 0, sizeof(*f));
+    if (size < 1) size = 1;
+    if (size > FILTER_MOVING_AVG_MAX) size = FILTER_MOVING_AVG_MAX;
+    f->size = size;
+}
+
+float filter_moving_avg_process(filter_moving_avg_t *f, float x)
+{
+    if (f->count < f->size) {
+        f->count++;
+    } else {
+        f->sum -= f->buf[f->pos];
+    }
+    f->buf[f->pos] = x;
+    f->sum += x;
+    if (++f->pos == f->size) {
+        f->pos = 0;
+        // 每绕一圈重新求和一次，消除浮点加减累积的舍入误差，均摊仍为 O(1)
+        float sum = 0.0f;
+        for (int i = 0; i < f->count; ++i) sum += f->buf[i];
+        f->sum = sum;
+    }
+    return f->sum / f->count;
+}
+
+void filter_moving_avg_process_block(filter_moving_avg_t *f, const float *in, float *out, int len)
+{
+    if (!f) return;
+    for (int i = 0; i < len; ++i) {
+        out[i] = filter_moving_avg_process(f, in[i]);
+    }
+}
+
+void filter_median_init(filter_median_t *f, int size)
+{
+    if (!f) return;
+    memset(f, 0, sizeof(*f));
+    if (size < 1) size = 1;
+    if (size > FILTER_MEDIAN_MAX) size = FILTER_MEDIAN_MAX;
+    f->size = size | 1;
+    if (f->size > FILTER_MEDIAN_MAX) f->size -= 2;
+}
+
+float filter_median_process(filter_median_t *f, float x)
+{
+    int n = f->count;
+    if (n == f->size) {
+        // 从有序数组中移除最旧的样本
+        float old = f->ring[f->pos];
+        int i = 0;
+        while (i < n - 1 && f->sorted[i] != old) i++;
+        memmove(&f->sorted[i], &f->sorted[i + 1], (n - 1 - i) * sizeof(float));
+        n--;
+    }
+    // 插入排序放入新样本，窗口很小，线性移动比堆更快
+    int j = n;
+    while (j > 0 && f->sorted[j - 1] > x) {
+        f->sorted[j] = f->sorted[j - 1];
+        j--;
+    }
+    f->sorted[j] = x;
+    f->count = n + 1;
+    f->ring[f->pos] = x;
+    if (++f->pos == f->size) f->pos = 0;
+    return f->sorted[f->count / 2];
+}
+
+// 比较交换，整块处理时没有数据相关的分支：RISC-V F 扩展上 fminf/fmaxf 各是一条 fmin.s/fmax.s；
+// 其他架构（主机构建）上 fminf 不开 -ffast-math 时是库函数调用，改用比较选择，编译为 minss/maxss 一类指令
+#if defined(__riscv_flen)
+#define FILTER_MIN(a, b) fminf(a, b)
+#define FILTER_MAX(a, b) fmaxf(a, b)
+#else
+#define FILTER_MIN(a, b) ((a) < (b) ? (a) : (b))
+#define FILTER_MAX(a, b) ((a) < (b) ? (b) : (a))
+#endif
+#define FILTER_SORT(a, b) do { float lo_ = FILTER_MIN(a, b); (b) = FILTER_MAX(a, b); (a) = lo_; } while (0)
+
+// 固定窗口的中值排序网络（只排出中位所需的部分），比较次数分别为 3、7、13、19
+static inline float filter_med3(const float *p)
+{
+    float p0 = p[0], p1 = p[1], p2 = p[2];
+    FILTER_SORT(p0, p1); FILTER_SORT(p1, p2); FILTER_SORT(p0, p1);
+    return p1;
+}
+
+static inline float filter_med5(const float *p)
+{
+    float p0 = p[0], p1 = p[1], p2 = p[2], p3 = p[3], p4 = p[4];
+    FILTER_SORT(p0, p1); FILTER_SORT(p3, p4); FILTER_SORT(p0, p3);
+    FILTER_SORT(p1, p4); FILTER_SORT(p1, p2); FILTER_SORT(p2, p3);
+    FILTER_SORT(p1, p2);
+    return p2;
+}
+
+static inline float filter_med7(const float *p)
+{
+    float p0 = p[0], p1 = p[1], p2 = p[2], p3 = p[3], p4 = p[4], p5 = p[5], p6 = p[6];
+    FILTER_SORT(p0, p5); FILTER_SORT(p0, p3); FILTER_SORT(p1, p6);
+    FILTER_SORT(p2, p4); FILTER_SORT(p0, p1); FILTER_SORT(p3, p5);
+    FILTER_SORT(p2, p6); FILTER_SORT(p2, p3); FILTER_SORT(p3, p6);
+    FILTER_SORT(p4, p5); FILTER_SORT(p1, p4); FILTER_SORT(p1, p3);
+    FILTER_SORT(p3, p4);
+    return p3;
+}
+
+static inline float filter_med9(const float *p)
+{
+    float p0 = p[0], p1 = p[1], p2 = p[2], p3 = p[3], p4 = p[4], p5 = p[5], p6 = p[6], p7 = p[7], p8 = p[8];
+    FILTER_SORT(p1, p2); FILTER_SORT(p4, p5); FILTER_SORT(p7, p8);
+    FILTER_SORT(p0, p1); FILTER_SORT(p3, p4); FILTER_SORT(p6, p7);
+    FILTER_SORT(p1, p2); FILTER_SORT(p4, p5); FILTER_SORT(p7, p8);
+    FILTER_SORT(p0, p3); FILTER_SORT(p5, p8); FILTER_SORT(p4, p7);
+    FILTER_SORT(p3, p6); FILTER_SORT(p1, p4); FILTER_SORT(p2, p5);
+    FILTER_SORT(p4, p7); FILTER_SORT(p4, p2); FILTER_SORT(p6, p4);
+    FILTER_SORT(p4, p2);
+    return p4;
+}
+
+// out[i] 为 x[i..i+size) 的中值；各输出互不依赖，按窗口大小分派到展开的内核
+static void filter_median_kernel(const float *x, float *out, int n, int size)
+{
+    switch (size) {
+    case 3: for (int i = 0; i < n; ++i) out[i] = filter_med3(&x[i]); break;
+    case 5: for (int i = 0; i < n; ++i) out[i] = filter_med5(&x[i]); break;
+    case 7: for (int i = 0; i < n; ++i) out[i] = filter_med7(&x[i]); break;
+    case 9: for (int i = 0; i < n; ++i) out[i] = filter_med9(&x[i]); break;
+    default: memmove(out, x, n * sizeof(float)); break;
+    }
+}
+
+void filter_median_process_block(filter_median_t *f, const float *in, float *out, int len)
+{
+    if (!f || len <= 0) return;
+    // 窗口未填满时取已有样本的中值，走逐样本路径
+    int i = 0;
+    while (i < len && f->count < f->size) {
+        out[i] = filter_median_process(f, in[i]);
+        i++;
+    }
+    if (i == len) return;
+
+    // 窗口已满后用排序网络：最近 size 个样本（从旧到新）放在前面，分段拷入输入，in 与 out 可以是同一块内存
+    int size = f->size;
+    float ext[FILTER_MEDIAN_MAX + FILTER_MEDIAN_CHUNK];
+    for (int k = 0; k < size; ++k) ext[k] = f->ring[(f->pos + k) % size];
+    while (i < len) {
+        int n = len - i < FILTER_MEDIAN_CHUNK ? len - i : FILTER_MEDIAN_CHUNK;
+        memcpy(&ext[size], &in[i], n * sizeof(float));
+        filter_median_kernel(&ext[1], &out[i], n, size);
+        memmove(ext, &ext[n], size * sizeof(float));
+        i += n;
+    }
+
+    // 同步逐样本路径的状态，之后两种接口可以继续混用
+    f->pos = 0;
+    for (int k = 0; k < size; ++k) {
+        float x = ext[k];
+        f->ring[k] = x;
+        int j = k;
+        while (j > 0 && f->sorted[j - 1] > x) {
+            f->sorted[j] = f->sorted[j - 1];
+            j--;
+        }
+        f->sorted[j] = x;
+    }
+}
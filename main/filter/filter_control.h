@@ -0,0 +1,72 @@
+// 数字滤波库头文件：级联双二阶 IIR、O(1) 滑动平均、小窗口中值
+// 每种滤波器都提供逐样本与整块两种接口，两者共享同一状态，可以混用
+
+#pragma once
+
+#include <stdint.h>
+
+// 工程加入 espressif/esp-dsp 组件后，整块双二阶滤波使用其针对 ESP32-P4/S3 的向量化内核，否则使用标量实现
+#if defined(__has_include)
+#if __has_include("dsps_biquad.h")
+#define FILTER_USE_ESP_DSP 1
+#endif
+#endif
+#ifndef FILTER_USE_ESP_DSP
+#define FILTER_USE_ESP_DSP 0
+#endif
+
+#define FILTER_BIQUAD_STAGES_MAX  4    // 最多 8 阶
+#define FILTER_MOVING_AVG_MAX     64
+#define FILTER_MEDIAN_MAX         9
+#define FILTER_MEDIAN_CHUNK       64   // 中值整块处理时每次拷入栈上缓冲区的样本数
+
+// 单节双二阶，直接 II 型；系数顺序 {b0, b1, b2, a1, a2}（a0 归一化为 1），与 esp-dsp 一致
+typedef struct {
+    float coef[5];
+    float w[2];
+} filter_biquad_t;
+
+typedef struct {
+    filter_biquad_t stages[FILTER_BIQUAD_STAGES_MAX];
+    int stage_count;
+} filter_biquad_cascade_t;
+
+typedef struct {
+    float buf[FILTER_MOVING_AVG_MAX];
+    float sum;
+    int size;
+    int pos;
+    int count;
+} filter_moving_avg_t;
+
+typedef struct {
+    float ring[FILTER_MEDIAN_MAX];    // 按到达顺序
+    float sorted[FILTER_MEDIAN_MAX];  // 同一批样本按大小排序
+    int size;
+    int pos;
+    int count;
+} filter_median_t;
+
+// 双二阶系数设计（RBJ Audio EQ Cookbook），fc 与 fs 单位为 Hz
+void filter_biquad_lowpass(filter_biquad_t *bq, float fc, float fs, float q);
+void filter_biquad_highpass(filter_biquad_t *bq, float fc, float fs, float q);
+void filter_biquad_notch(filter_biquad_t *bq, float fc, float fs, float q);
+
+// 级联：order 阶 Butterworth 低通（偶数，最大 2 × FILTER_BIQUAD_STAGES_MAX），各节 Q 按极点分布
+void filter_cascade_butterworth_lowpass(filter_biquad_cascade_t *c, int order, float fc, float fs);
+// 逐节添加自定义系数，超出上限时返回 -1
+int filter_cascade_add(filter_biquad_cascade_t *c, const filter_biquad_t *bq);
+void filter_cascade_reset(filter_biquad_cascade_t *c);
+float filter_cascade_process(filter_biquad_cascade_t *c, float x);
+// in 与 out 可以是同一块内存
+void filter_cascade_process_block(filter_biquad_cascade_t *c, const float *in, float *out, int len);
+
+void filter_moving_avg_init(filter_moving_avg_t *f, int size);
+float filter_moving_avg_process(filter_moving_avg_t *f, float x);
+void filter_moving_avg_process_block(filter_moving_avg_t *f, const float *in, float *out, int len);
+
+// size 取奇数，偶数时向上取整
+// 整块接口在窗口填满后使用无分支的排序网络，输出与逐样本接口相同（NaN 除外）
+void filter_median_init(filter_median_t *f, int size);
+float filter_median_process(filter_median_t *f, float x);
+void filter_median_process_block(filter_median_t *f, const float *in, float *out, int len);
@@ -1,3 +1,19 @@
 #pragma once
 
-#include "driver/gpio.h"
+#include "gpio/hal_gpio.h"
+
+// 双核分工：控制核运行采集与控制，界面核运行显示、串口、命令与后台分析
+// 单核配置（含 Linux 主机构建）下两类任务都在核 0
+#if CONFIG_FREERTOS_UNICORE || CONFIG_IDF_TARGET_LINUX
+#define APP_CORE_CONTROL    0
+#else
+#define APP_CORE_CONTROL    1
+#endif
+#define APP_CORE_UI         0
+
+// 浮点测量值转成遥测/记录的定点字段前先限幅：超出目标整数类型范围（含 NaN）的转换是未定义行为
+static inline float app_clamp_fixed(float x, float lo, float hi)
+{
+    if (!(x >= lo)) return lo;
+    return x > hi ? hi : x;
+}
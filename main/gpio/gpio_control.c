@@ -2,12 +2,10 @@
 
 void gpio_init(gpio_num_t target_gpio, gpio_mode_t mode, uint32_t level)
 {
-    gpio_reset_pin(target_gpio);
-    gpio_set_direction(target_gpio, mode);
-    gpio_set_level(target_gpio, level);
+    hal_gpio_init(target_gpio, mode, level);
 }
 
 void gpio_set(gpio_num_t target_gpio, uint32_t level)
 {
-    gpio_set_level(target_gpio, level);
+    hal_gpio_set_level(target_gpio, level);
 }
\ No newline at end of file
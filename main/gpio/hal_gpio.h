@@ -0,0 +1,35 @@
+// GPIO 硬件抽象层：ESP-IDF 实现见 hal_gpio_esp.c，Linux 主机仿真实现见 hal_gpio_linux.c
+// 上层模块只通过这里拿到 gpio_num_t 等平台类型，不直接包含驱动头文件
+
+#pragma once
+
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include <stdint.h>
+
+#if CONFIG_IDF_TARGET_LINUX
+typedef enum {
+    GPIO_NUM_NC = -1,
+    GPIO_NUM_0, GPIO_NUM_1, GPIO_NUM_2, GPIO_NUM_3, GPIO_NUM_4, GPIO_NUM_5, GPIO_NUM_6, GPIO_NUM_7,
+    GPIO_NUM_8, GPIO_NUM_9, GPIO_NUM_10, GPIO_NUM_11, GPIO_NUM_12, GPIO_NUM_13, GPIO_NUM_14, GPIO_NUM_15,
+    GPIO_NUM_16, GPIO_NUM_17, GPIO_NUM_18, GPIO_NUM_19, GPIO_NUM_20, GPIO_NUM_21, GPIO_NUM_22, GPIO_NUM_23,
+    GPIO_NUM_24, GPIO_NUM_25, GPIO_NUM_26, GPIO_NUM_27, GPIO_NUM_28, GPIO_NUM_29, GPIO_NUM_30, GPIO_NUM_31,
+    GPIO_NUM_32, GPIO_NUM_33, GPIO_NUM_34, GPIO_NUM_35, GPIO_NUM_36, GPIO_NUM_37, GPIO_NUM_38, GPIO_NUM_39,
+    GPIO_NUM_40, GPIO_NUM_41, GPIO_NUM_42, GPIO_NUM_43, GPIO_NUM_44, GPIO_NUM_45, GPIO_NUM_46, GPIO_NUM_47,
+    GPIO_NUM_48, GPIO_NUM_49, GPIO_NUM_50, GPIO_NUM_51, GPIO_NUM_52, GPIO_NUM_53, GPIO_NUM_54,
+    GPIO_NUM_MAX,
+} gpio_num_t;
+
+typedef enum {
+    GPIO_MODE_DISABLE = 0,
+    GPIO_MODE_INPUT,
+    GPIO_MODE_OUTPUT,
+    GPIO_MODE_INPUT_OUTPUT,
+} gpio_mode_t;
+#else
+#include "driver/gpio.h"
+#endif
+
+esp_err_t hal_gpio_init(gpio_num_t gpio, gpio_mode_t mode, uint32_t level);
+esp_err_t hal_gpio_set_level(gpio_num_t gpio, uint32_t level);
+int hal_gpio_get_level(gpio_num_t gpio);
@@ -0,0 +1,19 @@
+#include "hal_gpio.h"
+
+esp_err_t hal_gpio_init(gpio_num_t gpio, gpio_mode_t mode, uint32_t level)
+{
+    esp_err_t ret = gpio_reset_pin(gpio);
+    if (ret == ESP_OK) ret = gpio_set_direction(gpio, mode);
+    if (ret == ESP_OK) ret = gpio_set_level(gpio, level);
+    return ret;
+}
+
+esp_err_t hal_gpio_set_level(gpio_num_t gpio, uint32_t level)
+{
+    return gpio_set_level(gpio, level);
+}
+
+int hal_gpio_get_level(gpio_num_t gpio)
+{
+    return gpio_get_level(gpio);
+}
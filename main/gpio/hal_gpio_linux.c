@@ -0,0 +1,31 @@
+#include "hal_gpio.h"
+#include "esp_log.h"
+
+// 仿真：只记录电平，变化时打印调试日志
+static const char *TAG = "hal_gpio";
+static uint8_t s_levels[GPIO_NUM_MAX];
+static gpio_mode_t s_modes[GPIO_NUM_MAX];
+
+esp_err_t hal_gpio_init(gpio_num_t gpio, gpio_mode_t mode, uint32_t level)
+{
+    if (gpio < 0 || gpio >= GPIO_NUM_MAX) return ESP_ERR_INVALID_ARG;
+    s_modes[gpio] = mode;
+    s_levels[gpio] = level ? 1 : 0;
+    return ESP_OK;
+}
+
+esp_err_t hal_gpio_set_level(gpio_num_t gpio, uint32_t level)
+{
+    if (gpio < 0 || gpio >= GPIO_NUM_MAX) return ESP_ERR_INVALID_ARG;
+    if (s_levels[gpio] != (level ? 1 : 0)) {
+        ESP_LOGD(TAG, "GPIO%d -> %u", gpio, level ? 1 : 0);
+    }
+    s_levels[gpio] = level ? 1 : 0;
+    return ESP_OK;
+}
+
+int hal_gpio_get_level(gpio_num_t gpio)
+{
+    if (gpio < 0 || gpio >= GPIO_NUM_MAX) return 0;
+    return s_levels[gpio];
+}
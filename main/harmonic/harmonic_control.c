@@ -0,0 +1,178 @@
+#include "harmonic_control.h"
+#include "esp_timer.h"
+#include "trace/trace_control.h"
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "HARMONIC";
+
+static harmonic_config_t s_cfg;
+static float s_hann[HARMONIC_WINDOW_MAX];
+static uint16_t s_capture[2][HARMONIC_WINDOW_MAX];  // 采集端写一块，后台任务读另一块
+static float s_work[HARMONIC_WINDOW_MAX];
+static int s_capture_index = 0;
+static int s_capture_fill = 0;
+static volatile bool s_busy = false;                // 后台任务正在分析 s_capture[s_capture_index ^ 1]
+
+static TaskHandle_t s_harmonic_task = NULL;
+static harmonic_result_t s_result;
+static harmonic_stats_t s_stats;
+static portMUX_TYPE s_result_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// 对已加窗的 s_work 计算频率 f 处分量的峰值幅度，f 不必落在整数频点上
+static float harmonic_goertzel(const float *x, int n, float f, float fs)
+{
+    float coeff = 2.0f * cosf(2.0f * (float)M_PI * f / fs);
+    float s1 = 0.0f, s2 = 0.0f;
+    for (int i = 0; i < n; ++i) {
+        float s0 = x[i] + coeff * s1 - s2;
+        s2 = s1;
+        s1 = s0;
+    }
+    float power = s1 * s1 + s2 * s2 - coeff * s1 * s2;
+    // Hann 窗相干增益为 0.5，单边谱幅值再乘 2
+    return sqrtf(power > 0.0f ? power : 0.0f) * 4.0f / n;
+}
+
+static void harmonic_analyze(const uint16_t *capture)
+{
+    int n = s_cfg.window;
+    float fs = s_cfg.sample_rate_hz;
+    int64_t t0 = esp_timer_get_time();
+
+    int64_t sum = 0;
+    for (int i = 0; i < n; ++i) sum += capture[i];
+    float mean = (float)sum / n;
+    // 去直流后加窗，避免直流分量经窗函数泄漏到低次谐波
+    for (int i = 0; i < n; ++i) {
+        s_work[i] = ((float)capture[i] - mean) * s_hann[i];
+    }
+
+    harmonic_result_t r = {0};
+    r.dc = (mean - s_cfg.offset) * s_cfg.scale;
+    if (s_cfg.switching_hz > 0.0f && s_cfg.switching_hz < fs / 2.0f) {
+        r.ripple = harmonic_goertzel(s_work, n, s_cfg.switching_hz, fs) * s_cfg.scale;
+    }
+    if (s_cfg.fundamental_hz > 0.0f) {
+        float distortion = 0.0f;
+        for (int k = 1; k <= s_cfg.harmonics; ++k) {
+            float f = s_cfg.fundamental_hz * k;
+            if (f >= fs / 2.0f) break;
+            float a = harmonic_goertzel(s_work, n, f, fs) * s_cfg.scale;
+            r.harmonics[k - 1] = a;
+            r.harmonic_count = k;
+            if (k > 1) distortion += a * a;
+        }
+        r.fundamental = r.harmonics[0];
+        r.thd = r.fundamental > 0.0f ? sqrtf(distortion) / r.fundamental : 0.0f;
+    }
+    r.compute_us = (uint32_t)(esp_timer_get_time() - t0);
+
+    portENTER_CRITICAL(&s_result_lock);
+    r.sequence = s_result.sequence + 1;
+    s_result = r;
+    portEXIT_CRITICAL(&s_result_lock);
+}
+
+static void harmonic_task(void *arg)
+{
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        TRACE_BEGIN(HARMONIC);
+        harmonic_analyze(s_capture[s_capture_index ^ 1]);
+        TRACE_END(HARMONIC);
+        s_stats.windows++;
+        s_busy = false;
+    }
+}
+
+esp_err_t harmonic_init(const harmonic_config_t *cfg)
+{
+    if (!cfg || cfg->sample_rate_hz <= 0.0f || cfg->window < 16 || cfg->window > HARMONIC_WINDOW_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_cfg = *cfg;
+    if (s_cfg.harmonics < 1) s_cfg.harmonics = 1;
+    if (s_cfg.harmonics > HARMONIC_ORDER_MAX) s_cfg.harmonics = HARMONIC_ORDER_MAX;
+    if (s_cfg.scale == 0.0f) s_cfg.scale = 1.0f;
+
+    for (int i = 0; i < s_cfg.window; ++i) {
+        s_hann[i] = 0.5f - 0.5f * cosf(2.0f * (float)M_PI * i / s_cfg.window);
+    }
+    s_capture_index = 0;
+    s_capture_fill = 0;
+    s_busy = false;
+    memset(&s_stats, 0, sizeof(s_stats));
+
+    if (!s_harmonic_task) {
+        xTaskCreatePinnedToCore(harmonic_task, "harmonic", HARMONIC_TASK_STACK_SIZE, NULL, HARMONIC_TASK_PRIORITY, &s_harmonic_task, APP_CORE_UI);
+    }
+    ESP_LOGI(TAG, "Harmonic analyzer initialized: fs=%.0fHz window=%d resolution=%.1fHz",
+             s_cfg.sample_rate_hz, s_cfg.window, s_cfg.sample_rate_hz / s_cfg.window);
+    return ESP_OK;
+}
+
+void harmonic_feed_block(const uint16_t *samples, int count, int stride)
+{
+    if (!s_harmonic_task || !samples || stride <= 0) return;
+    uint16_t *dst = s_capture[s_capture_index];
+    for (int i = 0; i < count; i += stride) {
+        dst[s_capture_fill++] = samples[i];
+        if (s_capture_fill < s_cfg.window) continue;
+        s_capture_fill = 0;
+        if (s_busy) {
+            // 上一个窗口还没算完，覆盖当前窗口重新采集
+            s_stats.windows_dropped++;
+            continue;
+        }
+        s_busy = true;
+        s_capture_index ^= 1;
+        dst = s_capture[s_capture_index];
+        xTaskNotifyGive(s_harmonic_task);
+    }
+}
+
+void harmonic_get_result(harmonic_result_t *result)
+{
+    if (!result) return;
+    portENTER_CRITICAL(&s_result_lock);
+    *result = s_result;
+    portEXIT_CRITICAL(&s_result_lock);
+}
+
+void harmonic_get_stats(harmonic_stats_t *stats)
+{
+    if (stats) *stats = s_stats;
+}
+
+// harm：输出直流、纹波、基波、THD 及各次谐波幅值
+static void cmd_harmonic(const char *args, char *reply, size_t reply_size)
+{
+    harmonic_result_t r;
+    harmonic_get_result(&r);
+    if (r.sequence == 0) {
+        snprintf(reply, reply_size, "ERR no result");
+        return;
+    }
+    int len = snprintf(reply, reply_size, "dc=%.4f ripple=%.4f f0=%.4f thd=%.2f%% t=%" PRIu32 "us",
+                       r.dc, r.ripple, r.fundamental, r.thd * 100.0f, r.compute_us);
+    for (int k = 2; k <= r.harmonic_count && len > 0 && (size_t)len < reply_size; ++k) {
+        len += snprintf(reply + len, reply_size - len, " h%d=%.4f", k, r.harmonics[k - 1]);
+    }
+}
+
+static float harmonic_f0_get(void *ctx) { return s_cfg.fundamental_hz; }
+static esp_err_t harmonic_f0_set(void *ctx, float value) { s_cfg.fundamental_hz = value; return ESP_OK; }
+static float harmonic_fsw_get(void *ctx) { return s_cfg.switching_hz; }
+static esp_err_t harmonic_fsw_set(void *ctx, float value) { s_cfg.switching_hz = value; return ESP_OK; }
+
+void harmonic_register_commands(void)
+{
+    cmd_register_command("harm", cmd_harmonic);
+    cmd_register_param(&(cmd_param_t){ .name = "harm_f0", .type = CMD_PARAM_FLOAT, .min = 0, .max = 100000,
+                                       .getter = harmonic_f0_get, .setter = harmonic_f0_set });
+    cmd_register_param(&(cmd_param_t){ .name = "harm_fsw", .type = CMD_PARAM_FLOAT, .min = 0, .max = 1000000,
+                                       .getter = harmonic_fsw_get, .setter = harmonic_fsw_set });
+}
@@ -0,0 +1,55 @@
+// 谐波分析模块头文件：对采样窗口加 Hann 窗后用一组 Goertzel 滤波器测量
+// 开关频率处的纹波幅值、基波及 2..N 次谐波，并计算 THD
+// 采集端只负责把样本拷入缓冲区，计算在低优先级后台任务中完成，不影响控制环
+
+#pragma once
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "cmd/cmd_registry.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define HARMONIC_WINDOW_MAX       4096
+#define HARMONIC_ORDER_MAX        40    // 含基波
+#define HARMONIC_TASK_STACK_SIZE  4096
+#define HARMONIC_TASK_PRIORITY    (tskIDLE_PRIORITY + 1)
+
+typedef struct {
+    float sample_rate_hz;
+    int window;              // 每次分析的样本数，不超过 HARMONIC_WINDOW_MAX
+    float switching_hz;      // 纹波测量频率，0 不测
+    float fundamental_hz;    // 基波频率，0 不做谐波分析
+    int harmonics;           // 分析到第几次谐波（含基波），不超过 HARMONIC_ORDER_MAX
+    int32_t offset;          // 零点码值
+    float scale;             // 每码值对应的物理量
+} harmonic_config_t;
+
+typedef struct {
+    float dc;                              // 窗口平均值
+    float ripple;                          // 开关频率分量幅值（峰值）
+    float fundamental;                     // 基波幅值（峰值）
+    float harmonics[HARMONIC_ORDER_MAX];   // harmonics[k-1] 为 k 次谐波幅值，超过奈奎斯特频率的为 0
+    int harmonic_count;
+    float thd;                             // 总谐波畸变率，比值而非百分数
+    uint32_t compute_us;                   // 本次分析耗时
+    uint32_t sequence;                     // 每次分析完成加一
+} harmonic_result_t;
+
+typedef struct {
+    uint32_t windows;          // 已分析的窗口
+    uint32_t windows_dropped;  // 后台任务仍在计算时采满而丢弃的窗口
+} harmonic_stats_t;
+
+esp_err_t harmonic_init(const harmonic_config_t *cfg);
+
+// 喂入交错样本块：从 samples[0] 开始每隔 stride 取一个；可直接在 ADC 块回调中调用
+void harmonic_feed_block(const uint16_t *samples, int count, int stride);
+
+void harmonic_get_result(harmonic_result_t *result);
+void harmonic_get_stats(harmonic_stats_t *stats);
+
+// 注册 "harm" 命令输出最近一次分析结果，以及 harm_f0 / harm_fsw 参数
+void harmonic_register_commands(void);
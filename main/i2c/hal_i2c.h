@@ -0,0 +1,27 @@
+// I2C 主机硬件抽象层：ESP-IDF 实现见 hal_i2c_esp.c，Linux 主机仿真实现见 hal_i2c_linux.c
+// Linux 下总线上挂有仿真的 INA226（读数来自 sim/sim_plant）与 SSD1306（显存可导出为图片）
+
+#pragma once
+
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include "gpio/hal_gpio.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#if CONFIG_IDF_TARGET_LINUX
+typedef enum {
+    I2C_NUM_0 = 0,
+    I2C_NUM_1,
+    I2C_NUM_MAX,
+} i2c_port_t;
+#else
+#include "driver/i2c.h"
+#endif
+
+esp_err_t hal_i2c_init(i2c_port_t port, gpio_num_t sda_io, gpio_num_t scl_io, uint32_t clk_hz);
+// 一次写事务：先写 head 再写 data，两段之间不重新起始，用于“寄存器地址 + 数据”
+esp_err_t hal_i2c_write(i2c_port_t port, uint8_t addr, const uint8_t *head, size_t head_len, const uint8_t *data, size_t len);
+esp_err_t hal_i2c_read(i2c_port_t port, uint8_t addr, uint8_t *data, size_t len);
+// 写后重复起始读，用于读寄存器
+esp_err_t hal_i2c_write_read(i2c_port_t port, uint8_t addr, const uint8_t *wdata, size_t wlen, uint8_t *rdata, size_t rlen);
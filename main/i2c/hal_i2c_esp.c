@@ -0,0 +1,59 @@
+#include "hal_i2c.h"
+#include "freertos/FreeRTOS.h"
+
+#define HAL_I2C_TIMEOUT_TICKS pdMS_TO_TICKS(1000)
+
+esp_err_t hal_i2c_init(i2c_port_t port, gpio_num_t sda_io, gpio_num_t scl_io, uint32_t clk_hz)
+{
+	i2c_config_t conf = {
+		.mode = I2C_MODE_MASTER,
+		.sda_io_num = sda_io,
+		.scl_io_num = scl_io,
+		.sda_pullup_en = GPIO_PULLUP_ENABLE,
+		.scl_pullup_en = GPIO_PULLUP_ENABLE,
+		.master.clk_speed = clk_hz,
+	};
+	esp_err_t ret = i2c_param_config(port, &conf);
+	if (ret != ESP_OK) return ret;
+	return i2c_driver_install(port, conf.mode, 0, 0, 0);
+}
+
+esp_err_t hal_i2c_write(i2c_port_t port, uint8_t addr, const uint8_t *head, size_t head_len, const uint8_t *data, size_t len)
+{
+	i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+	i2c_master_start(cmd);
+	i2c_master_write_byte(cmd, (addr << 1) | I2C_MASTER_WRITE, true);
+	if (head_len > 0) i2c_master_write(cmd, (uint8_t *)head, head_len, true);
+	if (len > 0) i2c_master_write(cmd, (uint8_t *)data, len, true);
+	i2c_master_stop(cmd);
+	esp_err_t ret = i2c_master_cmd_begin(port, cmd, HAL_I2C_TIMEOUT_TICKS);
+	i2c_cmd_link_delete(cmd);
+	return ret;
+}
+
+esp_err_t hal_i2c_read(i2c_port_t port, uint8_t addr, uint8_t *data, size_t len)
+{
+	i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+	i2c_master_start(cmd);
+	i2c_master_write_byte(cmd, (addr << 1) | I2C_MASTER_READ, true);
+	i2c_master_read(cmd, data, len, I2C_MASTER_LAST_NACK);
+	i2c_master_stop(cmd);
+	esp_err_t ret = i2c_master_cmd_begin(port, cmd, HAL_I2C_TIMEOUT_TICKS);
+	i2c_cmd_link_delete(cmd);
+	return ret;
+}
+
+esp_err_t hal_i2c_write_read(i2c_port_t port, uint8_t addr, const uint8_t *wdata, size_t wlen, uint8_t *rdata, size_t rlen)
+{
+	i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+	i2c_master_start(cmd);
+	i2c_master_write_byte(cmd, (addr << 1) | I2C_MASTER_WRITE, true);
+	i2c_master_write(cmd, (uint8_t *)wdata, wlen, true);
+	i2c_master_start(cmd);
+	i2c_master_write_byte(cmd, (addr << 1) | I2C_MASTER_READ, true);
+	i2c_master_read(cmd, rdata, rlen, I2C_MASTER_LAST_NACK);
+	i2c_master_stop(cmd);
+	esp_err_t ret = i2c_master_cmd_begin(port, cmd, HAL_I2C_TIMEOUT_TICKS);
+	i2c_cmd_link_delete(cmd);
+	return ret;
+}
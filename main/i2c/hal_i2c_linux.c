@@ -0,0 +1,200 @@
+#include "hal_i2c.h"
+#include "sim/sim_plant.h"
+#include "i2c_ina226_driver/i2c_ina226_driver.h"
+#include "i2c_oled/i2c_oled_control.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <inttypes.h>
+#include <math.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "hal_i2c";
+
+#define OLED_CAPTURE_PATH   SIM_OUTPUT_DIR "/oled.pbm"
+#define SSD1306_COLUMNS     132   // 显存按 SH1106 的 132 列，驱动写入时偏移 2 列
+#define SSD1306_PAGES       8
+
+// ---------------- INA226 仿真 ----------------
+
+static uint16_t s_ina_regs[8];
+static uint8_t s_ina_pointer = 0;
+static int64_t s_ina_window_end_us = 0;   // 当前转换窗口结束的时刻
+static float s_ina_sum_v = 0.0f;          // 窗口内各次读取时的被控对象输出，近似芯片内部的平均
+static float s_ina_sum_i = 0.0f;
+static int s_ina_sum_count = 0;
+
+// 按手册的换算关系由被控对象的电压电流生成寄存器值
+static void ina226_sim_publish(float v, float i)
+{
+    int32_t shunt = lroundf(i * SHUNT_RESISTOR_OHMS / (SHUNT_LSB / 1000.0f));
+    int32_t bus = lroundf(v / BUS_LSB);
+    if (shunt > 32767) shunt = 32767;
+    if (shunt < -32768) shunt = -32768;
+    if (bus < 0) bus = 0;
+    if (bus > 0x7FFF) bus = 0x7FFF;
+    int32_t current = shunt * s_ina_regs[INA226_REG_CALIB] / 2048;
+    int32_t power = abs(current) * bus / 20000;
+    s_ina_regs[INA226_REG_SHUNT_V] = (uint16_t)shunt;
+    s_ina_regs[INA226_REG_BUS_V] = (uint16_t)bus;
+    s_ina_regs[INA226_REG_CURRENT] = (uint16_t)current;
+    s_ina_regs[INA226_REG_POWER] = (uint16_t)(power > 0xFFFF ? 0xFFFF : power);
+}
+
+// 与芯片一样按转换周期更新结果寄存器：窗口内的读数只累加，窗口结束后第一次读取时发布平均值
+static void ina226_sim_sample(void)
+{
+    float v, i;
+    sim_plant_get(&v, &i);
+    s_ina_sum_v += v;
+    s_ina_sum_i += i;
+    s_ina_sum_count++;
+    int64_t now = esp_timer_get_time();
+    if (now < s_ina_window_end_us) return;
+    uint32_t period = ina226_conversion_period_us(s_ina_regs[INA226_REG_CONFIG]);
+    ina226_sim_publish(s_ina_sum_v / s_ina_sum_count, s_ina_sum_i / s_ina_sum_count);
+    s_ina_sum_v = s_ina_sum_i = 0.0f;
+    s_ina_sum_count = 0;
+    s_ina_window_end_us = period > 0 && now - s_ina_window_end_us < period ? s_ina_window_end_us + period : now + period;
+}
+
+static esp_err_t ina226_sim_write(const uint8_t *buf, size_t len)
+{
+    if (len < 1) return ESP_OK;
+    s_ina_pointer = buf[0] & 0x07;
+    if (len >= 3 && s_ina_pointer != INA226_REG_SHUNT_V && s_ina_pointer != INA226_REG_BUS_V &&
+        s_ina_pointer != INA226_REG_POWER && s_ina_pointer != INA226_REG_CURRENT) {
+        s_ina_regs[s_ina_pointer] = ((uint16_t)buf[1] << 8) | buf[2];
+    }
+    return ESP_OK;
+}
+
+static esp_err_t ina226_sim_read(uint8_t *data, size_t len)
+{
+    if (s_ina_pointer >= INA226_REG_SHUNT_V && s_ina_pointer <= INA226_REG_CURRENT) {
+        ina226_sim_sample();
+    }
+    uint16_t value = s_ina_regs[s_ina_pointer];
+    for (size_t k = 0; k < len; ++k) {
+        data[k] = (k == 0) ? value >> 8 : (k == 1) ? value & 0xFF : 0;
+    }
+    return ESP_OK;
+}
+
+// ---------------- SSD1306 仿真 ----------------
+
+static uint8_t s_gram[SSD1306_PAGES][SSD1306_COLUMNS];
+static int s_page = 0;
+static int s_column = 0;
+static int s_cmd_params = 0;   // 当前多字节命令还剩几个参数字节
+
+static void ssd1306_sim_capture(void)
+{
+    char tmp[] = OLED_CAPTURE_PATH ".tmp";
+    FILE *f = fopen(tmp, "wb");
+    if (!f) return;
+    // P4：1 位灰度，每行 128 像素打包为 16 字节，高位在前
+    fprintf(f, "P4\n128 64\n");
+    for (int y = 0; y < SSD1306_PAGES * 8; ++y) {
+        uint8_t row[16] = {0};
+        for (int x = 0; x < 128; ++x) {
+            if (s_gram[y / 8][x + 2] & (1 << (y % 8))) row[x / 8] |= 0x80 >> (x % 8);
+        }
+        fwrite(row, 1, sizeof(row), f);
+    }
+    fclose(f);
+    rename(tmp, OLED_CAPTURE_PATH);
+}
+
+static void ssd1306_sim_command(uint8_t c)
+{
+    if (s_cmd_params > 0) {
+        s_cmd_params--;
+        return;
+    }
+    if (c <= 0x0F) {
+        s_column = (s_column & 0xF0) | c;
+    } else if (c <= 0x1F) {
+        s_column = (s_column & 0x0F) | ((c & 0x0F) << 4);
+    } else if (c >= 0xB0 && c <= 0xB7) {
+        s_page = c & 0x07;
+    } else if (c == 0x21 || c == 0x22) {
+        s_cmd_params = 2;
+    } else if (c == 0x20 || c == 0x81 || c == 0x8D || c == 0xA8 || c == 0xD3 ||
+               c == 0xD5 || c == 0xD9 || c == 0xDA || c == 0xDB) {
+        s_cmd_params = 1;
+    }
+}
+
+static esp_err_t ssd1306_sim_write(const uint8_t *buf, size_t len)
+{
+    if (len < 1) return ESP_OK;
+    bool data = (buf[0] & 0x40) != 0;
+    for (size_t k = 1; k < len; ++k) {
+        if (!data) {
+            ssd1306_sim_command(buf[k]);
+            continue;
+        }
+        if (s_column < SSD1306_COLUMNS) s_gram[s_page][s_column] = buf[k];
+        s_column++;
+    }
+    if (data && s_page == SSD1306_PAGES - 1) {
+        ssd1306_sim_capture();
+    }
+    return ESP_OK;
+}
+
+// ---------------- 总线 ----------------
+
+typedef struct {
+    i2c_port_t port;
+    uint8_t addr;
+    esp_err_t (*write)(const uint8_t *buf, size_t len);
+    esp_err_t (*read)(uint8_t *data, size_t len);
+} i2c_sim_device_t;
+
+static const i2c_sim_device_t s_devices[] = {
+    { I2C_INA226_NUM, INA226_I2C_ADDR, ina226_sim_write, ina226_sim_read },
+    { OLED_I2C_PORT, OLED_I2C_ADDR, ssd1306_sim_write, NULL },
+};
+
+static const i2c_sim_device_t *i2c_sim_find(i2c_port_t port, uint8_t addr)
+{
+    for (size_t i = 0; i < sizeof(s_devices) / sizeof(s_devices[0]); ++i) {
+        if (s_devices[i].port == port && s_devices[i].addr == addr) return &s_devices[i];
+    }
+    return NULL;
+}
+
+esp_err_t hal_i2c_init(i2c_port_t port, gpio_num_t sda_io, gpio_num_t scl_io, uint32_t clk_hz)
+{
+    if (port < 0 || port >= I2C_NUM_MAX) return ESP_ERR_INVALID_ARG;
+    sim_output_dir_init();
+    ESP_LOGI(TAG, "Simulated I2C%d (sda=%d scl=%d %" PRIu32 "Hz)", port, sda_io, scl_io, clk_hz);
+    return ESP_OK;
+}
+
+esp_err_t hal_i2c_write(i2c_port_t port, uint8_t addr, const uint8_t *head, size_t head_len, const uint8_t *data, size_t len)
+{
+    const i2c_sim_device_t *dev = i2c_sim_find(port, addr);
+    if (!dev || !dev->write) return ESP_FAIL;   // 无应答
+    uint8_t buf[head_len + len];
+    if (head_len) memcpy(buf, head, head_len);
+    if (len) memcpy(buf + head_len, data, len);
+    return dev->write(buf, head_len + len);
+}
+
+esp_err_t hal_i2c_read(i2c_port_t port, uint8_t addr, uint8_t *data, size_t len)
+{
+    const i2c_sim_device_t *dev = i2c_sim_find(port, addr);
+    if (!dev || !dev->read) return ESP_FAIL;
+    return dev->read(data, len);
+}
+
+esp_err_t hal_i2c_write_read(i2c_port_t port, uint8_t addr, const uint8_t *wdata, size_t wlen, uint8_t *rdata, size_t rlen)
+{
+    esp_err_t ret = hal_i2c_write(port, addr, wdata, wlen, NULL, 0);
+    if (ret != ESP_OK) return ret;
+    return hal_i2c_read(port, addr, rdata, rlen);
+}
@@ -1,34 +1,69 @@
 #include "i2c_control.h"
+#include "trace/trace_control.h"
+#include "freertos/FreeRTOS.h"
 
 static esp_timer_handle_t i2c_timer;
 static i2c_content_t i2c_content_buffer[I2C_CONTENT_BUFFER_SIZE];
-static volatile int i2c_write_index = 0;
-static volatile int i2c_read_index = 0;
-static volatile int i2c_content_count = 0;
+static ring_buffer_t i2c_content_ring;
+static bool i2c_content_reading = false;
 
 static i2c_device_t opened_i2c_addrs[I2C_PORTS_MAX];
 static volatile int opened_i2c_count = 0;
 
+// 两条总线分别被控制核与界面核使用，统计表的登记与计数放在同一个临界区内
+static portMUX_TYPE i2c_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static i2c_stats_t i2c_stats[I2C_STATS_DEVICES_MAX];
+static int i2c_stats_count = 0;
+
+static void i2c_stats_record(i2c_port_t i2c_num, uint8_t addr, esp_err_t ret)
+{
+	portENTER_CRITICAL(&i2c_stats_lock);
+	i2c_stats_t *st = NULL;
+	for (int i = 0; i < i2c_stats_count; ++i) {
+		if (i2c_stats[i].i2c_num == i2c_num && i2c_stats[i].addr == addr) {
+			st = &i2c_stats[i];
+			break;
+		}
+	}
+	if (!st && i2c_stats_count < I2C_STATS_DEVICES_MAX) {
+		st = &i2c_stats[i2c_stats_count++];
+		*st = (i2c_stats_t){ .i2c_num = i2c_num, .addr = addr, .last_error = ESP_OK };
+	}
+	if (st) {
+		st->transactions++;
+		if (ret != ESP_OK) {
+			st->failures++;
+			if (ret == ESP_ERR_TIMEOUT) st->timeouts++;
+			st->last_error = ret;
+		}
+	}
+	portEXIT_CRITICAL(&i2c_stats_lock);
+}
+
 void i2c_timer_callback(void* arg)
 {
 	for (int i = 0; i < opened_i2c_count; ++i) {
 		uint8_t addr = opened_i2c_addrs[i].addr;
 		i2c_port_t i2c_num = opened_i2c_addrs[i].i2c_num;
-		uint8_t data[I2C_BUF_SIZE] = {0};
+		// 直接读入空槽位，读取失败时槽位不提交，下次复用
+		i2c_content_t *slot = ring_claim_write(&i2c_content_ring);
+		if (!slot) {
+			break;
+		}
 		int len = I2C_BUF_SIZE;
-		esp_err_t ret = i2c_read(i2c_num, addr, data, len);
-		if (ret == ESP_OK && i2c_content_count < I2C_CONTENT_BUFFER_SIZE) {
-			memcpy(i2c_content_buffer[i2c_write_index].data, data, len);
-			i2c_content_buffer[i2c_write_index].addr = addr;
-			i2c_content_buffer[i2c_write_index].length = len;
-			i2c_write_index = (i2c_write_index + 1) % I2C_CONTENT_BUFFER_SIZE;
-			i2c_content_count++;
+		esp_err_t ret = i2c_read(i2c_num, addr, slot->data, len);
+		if (ret == ESP_OK) {
+			slot->i2c_num = i2c_num;
+			slot->addr = addr;
+			slot->length = len;
+			ring_commit_write(&i2c_content_ring);
 		}
 	}
 }
 
 void i2c_timer_service_start(void)
 {
+	ring_init(&i2c_content_ring, i2c_content_buffer, sizeof(i2c_content_t), I2C_CONTENT_BUFFER_SIZE);
 	const esp_timer_create_args_t timer_args = {
 		.callback = &i2c_timer_callback,
 		.name = "i2c_timer"
@@ -46,80 +81,65 @@ void i2c_add_device(i2c_port_t i2c_num, uint8_t addr)
 
 i2c_content_t* i2c_read_buffer(void)
 {
-	if (i2c_content_count <= 0) {
-		return NULL;
+	// 上一次返回的槽位此时才归还给生产者
+	if (i2c_content_reading) {
+		ring_release_read(&i2c_content_ring);
 	}
-	i2c_content_t* content = &i2c_content_buffer[i2c_read_index];
-	i2c_read_index = (i2c_read_index + 1) % I2C_CONTENT_BUFFER_SIZE;
-	i2c_content_count--;
+	i2c_content_t* content = ring_claim_read(&i2c_content_ring);
+	i2c_content_reading = (content != NULL);
 	return content;
 }
 
 void i2c_init(i2c_port_t i2c_num, gpio_num_t sda_io, gpio_num_t scl_io)
 {
-	i2c_config_t conf = {
-		.mode = I2C_MODE_MASTER,
-		.sda_io_num = sda_io,
-		.scl_io_num = scl_io,
-		.sda_pullup_en = GPIO_PULLUP_ENABLE,
-		.scl_pullup_en = GPIO_PULLUP_ENABLE,
-		.master.clk_speed = I2C_MASTER_FREQ_HZ,
-	};
-	ESP_ERROR_CHECK(i2c_param_config(i2c_num, &conf));
-	ESP_ERROR_CHECK(i2c_driver_install(i2c_num, conf.mode, I2C_MASTER_RX_BUF_DISABLE, I2C_MASTER_TX_BUF_DISABLE, 0));
+	ESP_ERROR_CHECK(hal_i2c_init(i2c_num, sda_io, scl_io, I2C_MASTER_FREQ_HZ));
 }
 
 esp_err_t i2c_write(i2c_port_t i2c_num, uint8_t dev_addr, const uint8_t *data, size_t len)
 {
-	i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-	i2c_master_start(cmd);
-	i2c_master_write_byte(cmd, (dev_addr << 1) | I2C_MASTER_WRITE, true);
-	i2c_master_write(cmd, (uint8_t*)data, len, true);
-	i2c_master_stop(cmd);
-	esp_err_t ret = i2c_master_cmd_begin(i2c_num, cmd, pdMS_TO_TICKS(1000));
-	i2c_cmd_link_delete(cmd);
+	TRACE_BEGIN_ARG(I2C, dev_addr);
+	esp_err_t ret = hal_i2c_write(i2c_num, dev_addr, NULL, 0, data, len);
+	TRACE_END(I2C);
+	i2c_stats_record(i2c_num, dev_addr, ret);
 	return ret;
 }
 
 esp_err_t i2c_read(i2c_port_t i2c_num, uint8_t dev_addr, uint8_t *data, size_t len)
 {
-	i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-	i2c_master_start(cmd);
-	i2c_master_write_byte(cmd, (dev_addr << 1) | I2C_MASTER_READ, true);
-	i2c_master_read(cmd, data, len, I2C_MASTER_LAST_NACK);
-	i2c_master_stop(cmd);
-	esp_err_t ret = i2c_master_cmd_begin(i2c_num, cmd, pdMS_TO_TICKS(1000));
-	i2c_cmd_link_delete(cmd);
+	TRACE_BEGIN_ARG(I2C, dev_addr);
+	esp_err_t ret = hal_i2c_read(i2c_num, dev_addr, data, len);
+	TRACE_END(I2C);
+	i2c_stats_record(i2c_num, dev_addr, ret);
 	return ret;
 }
 
 esp_err_t i2c_read_reg(i2c_port_t i2c_num, uint8_t dev_addr, uint8_t reg_addr, uint8_t *data, size_t len)
 {
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-
-	i2c_master_start(cmd);
-    i2c_master_write_byte(cmd, (dev_addr << 1) | I2C_MASTER_WRITE, true);
-    i2c_master_write_byte(cmd, reg_addr, true);
-
-    i2c_master_start(cmd);
-    i2c_master_write_byte(cmd, (dev_addr << 1) | I2C_MASTER_READ, true);
-    i2c_master_read(cmd, data, len, I2C_MASTER_LAST_NACK);
-    i2c_master_stop(cmd);
-
-    esp_err_t ret = i2c_master_cmd_begin(i2c_num, cmd, pdMS_TO_TICKS(1000));
-    i2c_cmd_link_delete(cmd);
-    return ret;
+	TRACE_BEGIN_ARG(I2C, dev_addr);
+	esp_err_t ret = hal_i2c_write_read(i2c_num, dev_addr, &reg_addr, 1, data, len);
+	TRACE_END(I2C);
+	i2c_stats_record(i2c_num, dev_addr, ret);
+	return ret;
 }
 
 esp_err_t i2c_write_reg(i2c_port_t i2c_num, uint8_t dev_addr, uint8_t reg_addr, const uint8_t *data, size_t len)
 {
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-    i2c_master_start(cmd);
-    i2c_master_write_byte(cmd, (dev_addr << 1) | I2C_MASTER_WRITE, true);
-    i2c_master_write_byte(cmd, reg_addr, true);
-    i2c_master_write(cmd, (uint8_t*)data, len, true);
-    i2c_master_stop(cmd);
-    esp_err_t ret = i2c_master_cmd_begin(i2c_num, cmd, pdMS_TO_TICKS(1000));
-    i2c_cmd_link_delete(cmd);
-    return ret;
-}
\ No newline at end of file
+	TRACE_BEGIN_ARG(I2C, dev_addr);
+	esp_err_t ret = hal_i2c_write(i2c_num, dev_addr, &reg_addr, 1, data, len);
+	TRACE_END(I2C);
+	i2c_stats_record(i2c_num, dev_addr, ret);
+	return ret;
+}
+
+bool i2c_get_stats(int index, i2c_stats_t *stats)
+{
+	if (!stats) return false;
+	bool found = false;
+	portENTER_CRITICAL(&i2c_stats_lock);
+	if (index >= 0 && index < i2c_stats_count) {
+		*stats = i2c_stats[index];
+		found = true;
+	}
+	portEXIT_CRITICAL(&i2c_stats_lock);
+	return found;
+}
@@ -1,17 +1,19 @@
 #pragma once
 
-#include "driver/i2c.h"
+#include "i2c/hal_i2c.h"
 #include <string.h>
 #include "global_params.h"
 #include "esp_timer.h"
+#include "ring/ring_buffer.h"
 
 #define I2C_BUF_SIZE                1024
 #define I2C_MASTER_NUM              I2C_NUM_0
 #define I2C_MASTER_FREQ_HZ          400000
 #define I2C_MASTER_TX_BUF_DISABLE   0
 #define I2C_MASTER_RX_BUF_DISABLE   0
-#define I2C_CONTENT_BUFFER_SIZE     10
+#define I2C_CONTENT_BUFFER_SIZE     8   // 必须为 2 的幂
 #define I2C_PORTS_MAX               2
+#define I2C_STATS_DEVICES_MAX       8   // 按 (端口, 地址) 分别统计的设备数
 
 typedef struct {
 	uint8_t i2c_num;
@@ -25,12 +27,26 @@ typedef struct {
 	uint8_t addr;
 } i2c_device_t;
 
+// 每个设备的事务统计，第一次访问该地址时登记
+typedef struct {
+	i2c_port_t i2c_num;
+	uint8_t addr;
+	uint32_t transactions;
+	uint32_t failures;         // 含超时
+	uint32_t timeouts;
+	esp_err_t last_error;
+} i2c_stats_t;
+
 void i2c_timer_service_start(void);
 void i2c_add_device(i2c_port_t i2c_num, uint8_t addr);
+// 返回的指针在下一次调用 i2c_read_buffer 之前有效，只能由一个任务调用
 i2c_content_t* i2c_read_buffer(void);
 void i2c_init(i2c_port_t i2c_num, gpio_num_t sda_io, gpio_num_t scl_io);
 esp_err_t i2c_read(i2c_port_t i2c_num, uint8_t addr, uint8_t* data, size_t len);
 esp_err_t i2c_write(i2c_port_t i2c_num, uint8_t dev_addr, const uint8_t *data, size_t len);
 
 esp_err_t i2c_read_reg(i2c_port_t i2c_num, uint8_t dev_addr, uint8_t reg_addr, uint8_t *data, size_t len);
-esp_err_t i2c_write_reg(i2c_port_t i2c_num, uint8_t dev_addr, uint8_t reg_addr, const uint8_t *data, size_t len);
\ No newline at end of file
+esp_err_t i2c_write_reg(i2c_port_t i2c_num, uint8_t dev_addr, uint8_t reg_addr, const uint8_t *data, size_t len);
+
+// 取第 index 个已登记设备的统计，不存在时返回 false
+bool i2c_get_stats(int index, i2c_stats_t *stats);
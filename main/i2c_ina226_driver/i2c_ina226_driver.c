@@ -1,13 +1,40 @@
 #include "i2c_ina226_driver.h"
+#include <inttypes.h>
 
 static const char *TAG = "INA226";
+static uint16_t s_ina226_config = INA226_CONFIG_VALUE;
+
+esp_err_t ina226_set_config(uint16_t config)
+{
+    uint8_t config_data[2] = { (uint8_t)((config >> 8) & 0xFF), (uint8_t)(config & 0xFF) };
+    esp_err_t ret = i2c_write_reg(I2C_INA226_NUM, INA226_I2C_ADDR, INA226_REG_CONFIG, config_data, 2);
+    if (ret == ESP_OK) {
+        s_ina226_config = config;
+    }
+    return ret;
+}
+
+uint16_t ina226_get_config(void)
+{
+    return s_ina226_config;
+}
+
+uint32_t ina226_conversion_period_us(uint16_t config)
+{
+    static const uint16_t avg_counts[8] = { 1, 4, 16, 64, 128, 256, 512, 1024 };
+    static const uint16_t ct_us[8] = { 140, 204, 332, 588, 1100, 2116, 4156, 8244 };
+    uint32_t mode = config & 0x7;
+    uint32_t per_avg = 0;
+    if (mode & 0x1) per_avg += ct_us[(config >> INA226_CONFIG_CT_SHIFT) & 0x7];
+    if (mode & 0x2) per_avg += ct_us[(config >> (INA226_CONFIG_CT_SHIFT + 3)) & 0x7];
+    return per_avg * avg_counts[(config >> INA226_CONFIG_AVG_SHIFT) & 0x7];
+}
 
 esp_err_t ina226_init(void)
 {
     // 写 INA226_REG_CONFIG 寄存器
-    uint16_t cfg = INA226_CONFIG_VALUE;
-    uint8_t config_data[2] = { (uint8_t)((cfg >> 8) & 0xFF), (uint8_t)(cfg & 0xFF) };
-    esp_err_t ret = i2c_write_reg(I2C_INA226_NUM, INA226_I2C_ADDR, INA226_REG_CONFIG, config_data, 2);
+    uint16_t cfg = s_ina226_config;
+    esp_err_t ret = ina226_set_config(cfg);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to configure INA226: %s", esp_err_to_name(ret));
         return ret;
@@ -18,7 +45,7 @@ esp_err_t ina226_init(void)
     // Cal = round(0.00512 / (Current_LSB * R_shunt))
     uint32_t calib = (uint32_t)(0.00512f / (current_lsb * SHUNT_RESISTOR_OHMS) + 0.5f);
     if (calib == 0 || calib > 0xFFFF) {
-        ESP_LOGW(TAG, "Calculated calib out of range: %u", calib);
+        ESP_LOGW(TAG, "Calculated calib out of range: %" PRIu32, calib);
     }
     uint16_t calib_u16 = (uint16_t)(calib & 0xFFFF);
     uint8_t calib_data[2] = { (uint8_t)((calib_u16 >> 8) & 0xFF), (uint8_t)(calib_u16 & 0xFF) };
@@ -97,4 +124,65 @@ esp_err_t ina226_read_all(ina226_data_t *data)
 
     ret = ina226_read_power(&data->power_mw);
     return ret;
+}
+
+esp_err_t ina226_set_alert(uint16_t mask, uint16_t limit)
+{
+    // 先写阈值再使能，避免旧阈值短暂生效
+    uint8_t limit_data[2] = { (uint8_t)(limit >> 8), (uint8_t)(limit & 0xFF) };
+    esp_err_t ret = i2c_write_reg(I2C_INA226_NUM, INA226_I2C_ADDR, INA226_REG_ALERT, limit_data, 2);
+    if (ret != ESP_OK) return ret;
+    uint8_t mask_data[2] = { (uint8_t)(mask >> 8), (uint8_t)(mask & 0xFF) };
+    return i2c_write_reg(I2C_INA226_NUM, INA226_I2C_ADDR, INA226_REG_MASK, mask_data, 2);
+}
+
+esp_err_t ina226_set_overcurrent_alert(float current_a, bool latch)
+{
+    // 分流电压原始值 = I × Rshunt / 2.5 μV
+    float raw = current_a * SHUNT_RESISTOR_OHMS * 1000.0f / SHUNT_LSB;
+    if (raw < 1.0f || raw > 32767.0f) return ESP_ERR_INVALID_ARG;
+    uint16_t mask = INA226_ALERT_SOL | (latch ? INA226_ALERT_LEN : 0);
+    esp_err_t ret = ina226_set_alert(mask, (uint16_t)(raw + 0.5f));
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "Over-current alert at %.3fA (shunt raw %u)", current_a, (uint16_t)(raw + 0.5f));
+    }
+    return ret;
+}
+
+esp_err_t ina226_read_alert(uint16_t *mask)
+{
+    uint8_t data[2];
+    esp_err_t ret = i2c_read_reg(I2C_INA226_NUM, INA226_I2C_ADDR, INA226_REG_MASK, data, 2);
+    if (ret == ESP_OK && mask) *mask = _bytes_to_uint16(data);
+    return ret;
+}
+
+static float ina226_avg_get(void *ctx)
+{
+    return (float)((s_ina226_config >> INA226_CONFIG_AVG_SHIFT) & 0x7);
+}
+
+static esp_err_t ina226_avg_set(void *ctx, float value)
+{
+    uint16_t cfg = s_ina226_config & ~(0x7 << INA226_CONFIG_AVG_SHIFT);
+    return ina226_set_config(cfg | ((uint16_t)value << INA226_CONFIG_AVG_SHIFT));
+}
+
+static float ina226_ct_get(void *ctx)
+{
+    return (float)((s_ina226_config >> INA226_CONFIG_CT_SHIFT) & 0x7);
+}
+
+static esp_err_t ina226_ct_set(void *ctx, float value)
+{
+    // 总线与分流转换时间保持一致
+    uint16_t ct = (uint16_t)value;
+    uint16_t cfg = s_ina226_config & ~(0x3F << INA226_CONFIG_CT_SHIFT);
+    return ina226_set_config(cfg | (((ct << 3) | ct) << INA226_CONFIG_CT_SHIFT));
+}
+
+void ina226_register_params(void)
+{
+    cmd_register_param(&(cmd_param_t){ .name = "ina_avg", .type = CMD_PARAM_INT, .min = 0, .max = 7, .getter = ina226_avg_get, .setter = ina226_avg_set });
+    cmd_register_param(&(cmd_param_t){ .name = "ina_ct", .type = CMD_PARAM_INT, .min = 0, .max = 7, .getter = ina226_ct_get, .setter = ina226_ct_set });
 }
\ No newline at end of file
@@ -4,8 +4,10 @@
 #pragma once
 
 #include "i2c/i2c_control.h"
+#include "cmd/cmd_registry.h"
 #include "esp_log.h"
 #include "esp_err.h"
+#include <stdbool.h>
 #include <stdint.h>
 
 #define I2C_INA226_NUM      I2C_NUM_1
@@ -42,8 +44,23 @@
 // CAL = 0.00512 / (Current_LSB * Rshunt)
 // 其中 Current_LSB = Max_Current / 32768，电流单位为安培
 // Rshunt 是采样电阻值，单位为欧姆
+#define INA226_REG_MASK    0x06  // 报警屏蔽/使能寄存器
+// 高 6 位选择报警功能，同时置位时只有最高位生效；读取该寄存器会清除锁存的报警
+#define INA226_REG_ALERT   0x07  // 报警阈值寄存器
+// 阈值与所选功能对应的寄存器同单位比较，例如过流报警按分流电压寄存器的原始值比较
+
+#define INA226_ALERT_SOL     (1 << 15)  // 分流电压超上限（过流）
+#define INA226_ALERT_SUL     (1 << 14)  // 分流电压低于下限
+#define INA226_ALERT_BOL     (1 << 13)  // 总线电压超上限（过压）
+#define INA226_ALERT_BUL     (1 << 12)  // 总线电压低于下限
+#define INA226_ALERT_POL     (1 << 11)  // 功率超上限
+#define INA226_ALERT_AFF     (1 << 4)   // 报警标志：锁存模式下保持到读取 INA226_REG_MASK
+#define INA226_ALERT_APOL    (1 << 1)   // 置 1 时 ALERT 高有效，默认低有效（开漏）
+#define INA226_ALERT_LEN     (1 << 0)   // 置 1 时锁存报警
 
 #define INA226_CONFIG_VALUE  0x4127  // 配置寄存器：连续测量、4次平均、1.1ms转换时间
+#define INA226_CONFIG_AVG_SHIFT 9    // AVG[11:9]：平均次数编码，0~7 对应 1/4/16/64/128/256/512/1024
+#define INA226_CONFIG_CT_SHIFT  3    // VSHCT[5:3]，VBUSCT[8:6] 在其上方 3 位：转换时间编码，0~7 对应 140us~8.244ms
 #define SHUNT_RESISTOR_OHMS  0.01f    // 分流电阻 10mΩ
 #define MAX_CURRENT_A        3.2768f // 最大电流 3.2768A
 
@@ -63,4 +80,16 @@ esp_err_t ina226_init(void);
 esp_err_t ina226_read_all(ina226_data_t *data);
 esp_err_t ina226_read_voltage(float *bus_voltage_v);
 esp_err_t ina226_read_current(float *current_ma);
-esp_err_t ina226_read_power(float *power_mw);
\ No newline at end of file
+esp_err_t ina226_read_power(float *power_mw);
+esp_err_t ina226_set_config(uint16_t config);
+uint16_t ina226_get_config(void);
+// 按配置寄存器计算连续模式下一组新结果的间隔：平均次数 ×（被选中的总线与分流转换时间之和）
+uint32_t ina226_conversion_period_us(uint16_t config);
+// 配置 ALERT 引脚：mask 为 INA226_ALERT_* 组合，limit 为对应寄存器单位的原始阈值
+esp_err_t ina226_set_alert(uint16_t mask, uint16_t limit);
+// 过流报警：电流超过 current_a 时 ALERT 拉低，latch 为 true 时保持到 ina226_read_alert
+esp_err_t ina226_set_overcurrent_alert(float current_a, bool latch);
+// 读取并清除报警标志
+esp_err_t ina226_read_alert(uint16_t *mask);
+// 注册 ina_avg（平均次数编码）与 ina_ct（总线/分流转换时间编码）两个参数
+void ina226_register_params(void);
\ No newline at end of file
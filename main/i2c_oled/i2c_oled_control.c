@@ -1,4 +1,8 @@
 #include "i2c_oled_control.h"
+#include "trace/trace_control.h"
+#include "esp_log.h"
+
+static const char *TAG = "OLED";
 
 // 本部分代码部分参考自：https://github.com/LKjoey/ESP32-OLED-Driver-for-ssd1306
 
@@ -204,32 +208,30 @@ const uint8_t OLED_F6x8[][6] =
 // 显示缓冲区大小为 128x8 字节（每字节表示 8 行像素）
 uint8_t OLED_DisplayBuf[8][128];
 
-void OLED_i2c_write(uint8_t reg, uint8_t *data, size_t len)
+// OLED_init 期间的第一个错误；屏幕掉线只影响显示，不应让整机复位
+static esp_err_t OLED_error = ESP_OK;
+
+esp_err_t OLED_i2c_write(uint8_t reg, uint8_t *data, size_t len)
 {
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
-    ESP_ERROR_CHECK(i2c_master_start(cmd));
-    ESP_ERROR_CHECK(i2c_master_write_byte(cmd, (OLED_I2C_ADDR << 1) | I2C_MASTER_WRITE, true));
-    ESP_ERROR_CHECK(i2c_master_write_byte(cmd, reg, true));
-    if (len > 0)
-        ESP_ERROR_CHECK(i2c_master_write(cmd, data, len, true));
-    ESP_ERROR_CHECK(i2c_master_stop(cmd));
-    ESP_ERROR_CHECK(i2c_master_cmd_begin(OLED_I2C_PORT, cmd, 1000 / portTICK_PERIOD_MS));
-    i2c_cmd_link_delete(cmd);
+    esp_err_t ret = i2c_write_reg(OLED_I2C_PORT, OLED_I2C_ADDR, reg, data, len);
+    if (ret != ESP_OK && OLED_error == ESP_OK) OLED_error = ret;
+    return ret;
 }
 
-void OLED_write_command(uint8_t command)
+esp_err_t OLED_write_command(uint8_t command)
 {
-    OLED_i2c_write(0x00, &command, 1);
+    return OLED_i2c_write(0x00, &command, 1);
 }
 
-void OLED_write_data(uint8_t *data, uint8_t count)
+esp_err_t OLED_write_data(uint8_t *data, uint8_t count)
 {
-    OLED_i2c_write(0x40, data, count);
+    return OLED_i2c_write(0x40, data, count);
 }
 
 
-void OLED_init(void)
+esp_err_t OLED_init(void)
 {
+    OLED_error = ESP_OK;
     /*写入一系列的命令，对OLED进行初始化配置*/
     OLED_write_command(0xAE); // 设置显示开启/关闭，0xAE关闭，0xAF开启
 
@@ -269,26 +271,35 @@ void OLED_init(void)
 
     OLED_write_command(0xAF); // 开启显示
 
+    esp_err_t ret = OLED_error;
     OLED_clear();
-    OLED_update();
+    if (ret == ESP_OK) ret = OLED_update();
+    if (ret != ESP_OK) ESP_LOGW(TAG, "Init failed: %s", esp_err_to_name(ret));
+    return ret;
 }
 
-void OLED_set_cursor(uint8_t Page, uint8_t X)
+esp_err_t OLED_set_cursor(uint8_t Page, uint8_t X)
 {
     X += 2;
-    OLED_write_command(0xB0 | Page);
-    OLED_write_command(0x10 | ((X & 0xF0) >> 4));
-    OLED_write_command(0x00 | (X & 0x0F));
+    esp_err_t ret = OLED_write_command(0xB0 | Page);
+    if (ret == ESP_OK) ret = OLED_write_command(0x10 | ((X & 0xF0) >> 4));
+    if (ret == ESP_OK) ret = OLED_write_command(0x00 | (X & 0x0F));
+    return ret;
 }
 
-void OLED_update(void)
+// 某一页写入失败时放弃本帧，不在无应答的总线上连续等待超时
+esp_err_t OLED_update(void)
 {
     uint8_t j;
-    for (j = 0; j < 8; j++)
+    esp_err_t ret = ESP_OK;
+    TRACE_BEGIN(OLED_UPDATE);
+    for (j = 0; j < 8 && ret == ESP_OK; j++)
     {
-        OLED_set_cursor(j, 0);
-        OLED_write_data(OLED_DisplayBuf[j], 128);
+        ret = OLED_set_cursor(j, 0);
+        if (ret == ESP_OK) ret = OLED_write_data(OLED_DisplayBuf[j], 128);
     }
+    TRACE_END(OLED_UPDATE);
+    return ret;
 }
 
 void OLED_clear(void)
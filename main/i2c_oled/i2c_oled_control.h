@@ -9,11 +9,12 @@
 #define OLED_I2C_PORT    I2C_NUM_0
 #define OLED_I2C_ADDR    0x3C
 
-void OLED_write_command(uint8_t command);
-void OLED_write_data(uint8_t *data, uint8_t count);
-void OLED_init(void);
-void OLED_set_cursor(uint8_t page, uint8_t column);
-void OLED_update(void);
+// I2C 写入失败时返回错误而不是中止程序，失败次数计入 i2c_get_stats
+esp_err_t OLED_write_command(uint8_t command);
+esp_err_t OLED_write_data(uint8_t *data, uint8_t count);
+esp_err_t OLED_init(void);
+esp_err_t OLED_set_cursor(uint8_t page, uint8_t column);
+esp_err_t OLED_update(void);
 void OLED_clear(void);
 void OLED_reverse(void);
 void OLED_show_image(int16_t X, int16_t Y, uint8_t Width, uint8_t Height, const uint8_t *Image);
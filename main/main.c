@@ -1,3 +1,4 @@
+#include <inttypes.h>
 #include <stdio.h>
 #include <string.h>
 #include "global_params.h"
@@ -8,101 +9,662 @@
 #include "i2c_oled/i2c_oled_control.h"
 #include "i2c_ina226_driver/i2c_ina226_driver.h"
 #include "pid/pid_control.h"
+#include "filter/filter_control.h"
+#include "adc/adc_control.h"
+#include "harmonic/harmonic_control.h"
+#include "meter/meter_control.h"
+#include "cmd/cmd_registry.h"
+#include "ring/ring_buffer.h"
+#include "bench/bench_control.h"
+#include "trace/trace_control.h"
+#include "datalog/datalog_control.h"
+#include "config/config_control.h"
+#include "protect/protect_control.h"
+#include "stats/stats_control.h"
+#include "observer/observer_control.h"
+#include <math.h>
+#if CONFIG_IDF_TARGET_LINUX
+#include "sim/sim_plant.h"
+#else
+#include "driver/gptimer.h"
+#include "esp_attr.h"
+#endif
 
 static const char *TAG = "main";
 
+#define TARGET_VOLTAGE_MIN  10.0f
+#define TARGET_VOLTAGE_MAX  18.0f
+#define INPUT_VOLTAGE_MIN   5.0f
+#define INPUT_VOLTAGE_MAX   40.0f
+
+// 母线电压先经中值滤波去除 I2C 读数毛刺，再经二阶 Butterworth 低通；关闭观测器（obs_en 0）时送入 PID
+#define BUS_FILTER_FS_HZ    1000.0f
+#define BUS_FILTER_FC_HZ    100.0f
+#define BUS_FILTER_MEDIAN   3
+
+// 输出电压观测器：INA226 每个转换周期才出一个新样本，观测器按已施加的占空比在样本之间预测，
+// 每个控制周期都给 PID 一个新的估计值；功率级参数按实际电路修改，噪声方差可用 obs_* 参数在线调整
+#define BUS_OBSERVER_L_H    47e-6f
+#define BUS_OBSERVER_C_F    220e-6f
+#define BUS_OBSERVER_R_OHM  0.05f
+#define BUS_OBSERVER_Q_V    1e-6f
+#define BUS_OBSERVER_Q_I    1e-4f
+#define BUS_OBSERVER_Q_B    1e-4f
+#define BUS_OBSERVER_R_V    1e-5f
+
+// 输出电压经电阻分压后接入 ADC1，用于纹波与谐波分析；分压比按实际电路修改
+#define ANALYZER_ADC_CHANNEL        0
+#define ANALYZER_SAMPLES_PER_PERIOD 4
+#define ANALYZER_DIVIDER_RATIO      11.0f
+#define ANALYZER_WINDOW             4096
+
+// 任务划分：采集与控制固定在 APP_CORE_CONTROL，显示、串口、命令与后台分析固定在 APP_CORE_UI，
+// 两侧只通过无锁 SPSC 环形缓冲区交换数据，界面负载不会影响控制周期
+//
+// 控制核实时预算（每 CONTROL_PERIOD_US = 1000 us 一次）：
+//   INA226 读取 4 个寄存器（400 kHz I2C）  约 600 us
+//   中值 + 低通滤波、观测器、计量、PID、PWM 更新  < 50 us
+//   遥测与界面快照入队                     < 5 us
+//   余量约 350 us；从定时中断到本周期完成超过一个周期的次数计入 overruns（执行过长与被抢占迟到都只在周期末计一次），
+//   单次最长耗时计入 max_us，可用 rt 命令查看
+// 控制周期由 GPTimer 报警中断产生，中断分配在控制核上，唤醒控制任务不经过界面核；Linux 主机构建用 esp_timer
+#define CONTROL_PERIOD_US       PERIOD_US
+#define CONTROL_TASK_STACK_SIZE 4096
+#define CONTROL_TASK_PRIORITY   (configMAX_PRIORITIES - 3)
+#define UI_TASK_STACK_SIZE      4096
+#define UI_TASK_PRIORITY        3
+#define UI_REFRESH_MS           100
+#define UI_SNAPSHOT_DIVIDER     20   // 每 20 个控制周期向界面推送一次快照
+#define UI_SNAPSHOT_QUEUE_SIZE  8    // 必须为 2 的幂
+#define DATALOG_DIVIDER         10   // 每 10 个控制周期记录一个样本（100 Hz，960 KB 分区约 16 分钟，随分区大小线性增加）
+
+// 快速保护：INA226 ALERT（开漏，低有效）接 MCPWM 故障输入，外部比较器可接第二个故障输入；
+// 板子尚未引出这两个信号，先不启用，此时只有软件通路（控制周期 + 一次 I2C 读取）。引出后在此填入引脚：
+// ALERT 在转换结束时才比较，关断延迟最长约一个转换周期（默认约 2.2 ms），比较器才能做到微秒级
+#define PROTECT_ALERT_GPIO          GPIO_NUM_NC
+#define PROTECT_COMPARATOR_GPIO     GPIO_NUM_NC
+#define PROTECT_RETRY_MAX           3
+#define PROTECT_RETRY_DELAY_MS      500
+
+// 启动计时：记录每个初始化步骤的耗时，以及输出电压首次进入目标值 ±BOOT_REGULATION_BAND 的时刻
+#define BOOT_STEPS_MAX          16
+#define BOOT_REGULATION_BAND    0.02f
+
+typedef struct {
+    float target_v;
+    float bus_v;
+    float current_a;
+    float duty;
+} ui_snapshot_t;
+
+typedef struct {
+    const char *name;
+    uint32_t us;
+} boot_step_t;
+
+typedef struct {
+    uint32_t cycles;
+    uint32_t overruns;
+    uint32_t max_us;
+    uint32_t last_us;
+    uint32_t pid_ticks;      // 实际执行的 PID 次数，保护跳闸期间不计
+    uint32_t ina226_errors;  // INA226 读取失败，本周期沿用上一次的测量值
+    uint32_t ina226_samples; // 读到的新转换结果（寄存器值有变化），送入观测器
+} control_stats_t;
+
+static pwm_instance_t pwm_inst = {0};
+static pwm_instance_t pwm_inst_conj = {0};
+static pid_handle_t pid = {0};
+static float target_bus_voltage = 10.0f;
+static float current_pwm_duty = 0.0f;
+static float current_bus_voltage = 0.0f;
+// 前馈使用的输入电压：板上暂无输入侧采样，取 "vin" 参数；接入输入侧传感器后在控制任务中写入测量值即可
+static float input_voltage = APP_CONFIG_DEFAULT_VIN;
+static filter_median_t bus_median;
+static filter_biquad_cascade_t bus_lpf;
+static observer_t bus_observer;
+static float observer_enabled = 1.0f;
+static int meter_out = -1;
+static app_config_t app_cfg;
+
+static boot_step_t boot_steps[BOOT_STEPS_MAX];
+static int boot_step_count = 0;
+static int64_t boot_mark_us = 0;
+static int64_t boot_entry_us = 0;         // 进入 app_main 的时刻（esp_timer 时基，约等于自启动起的时间）
+static int64_t boot_control_us = 0;       // 控制环启动的时刻
+static int64_t boot_ready_us = 0;         // 全部初始化完成的时刻
+static volatile int64_t boot_regulated_us = 0;
+
+static TaskHandle_t control_task_handle = NULL;
+#if CONFIG_IDF_TARGET_LINUX
+static esp_timer_handle_t control_timer = NULL;
+#else
+static gptimer_handle_t control_timer = NULL;
+#endif
+static volatile int64_t control_tick_us = 0;  // 最近一次定时中断的时刻
+static control_stats_t control_stats = {0};
+static ring_buffer_t ui_ring;
+static ui_snapshot_t ui_ring_storage[UI_SNAPSHOT_QUEUE_SIZE];
+
+#if CONFIG_APP_BENCHMARK
+static void bench_ina226_read_all(void *arg) {
+    ina226_data_t data;
+    ina226_read_all(&data);
+}
+
+static void bench_oled_update(void *arg) {
+    OLED_update();
+}
+
+static void bench_oled_show_string(void *arg) {
+    OLED_show_string(0, 0, "V:12.345 I:1.2345", OLED_6X8);
+}
+
+static void bench_pwm_set(void *arg) {
+    pwm_set(0.0f, &pwm_inst);
+}
+
+static void bench_pid_timer_isr(void *arg) {
+    pid_timer_isr((pid_handle_t *)arg);
+}
+
+static void bench_observer_cycle(void *arg) {
+    // 一次预测加一次融合：样本落在 4 个周期之前，包含回退后的重新预测
+    observer_t *obs = (observer_t *)arg;
+    observer_predict(obs, obs->history[obs->head & (OBSERVER_HISTORY - 1)].t_us, 12.0f, 1.0f);
+    observer_update(obs, obs->history[(obs->head - 4) & (OBSERVER_HISTORY - 1)].t_us, 10.0f);
+}
+
+// 滤波内核按 BENCH_FILTER_BLOCK 个样本一块计时，输出每秒样本数；逐样本中值用作整块排序网络的对照
+#define BENCH_FILTER_BLOCK 256
+static float bench_filter_in[BENCH_FILTER_BLOCK];
+static float bench_filter_out[BENCH_FILTER_BLOCK];
+
+static void bench_filter_biquad(void *arg) {
+    filter_cascade_process_block((filter_biquad_cascade_t *)arg, bench_filter_in, bench_filter_out, BENCH_FILTER_BLOCK);
+}
+
+static void bench_filter_moving_avg(void *arg) {
+    filter_moving_avg_process_block((filter_moving_avg_t *)arg, bench_filter_in, bench_filter_out, BENCH_FILTER_BLOCK);
+}
+
+static void bench_filter_median(void *arg) {
+    filter_median_process_block((filter_median_t *)arg, bench_filter_in, bench_filter_out, BENCH_FILTER_BLOCK);
+}
+
+static void bench_filter_median_sample(void *arg) {
+    for (int i = 0; i < BENCH_FILTER_BLOCK; ++i) {
+        bench_filter_out[i] = filter_median_process((filter_median_t *)arg, bench_filter_in[i]);
+    }
+}
+
+static void run_benchmarks(void) {
+    // PID 与观测器使用独立句柄，不影响控制环的状态
+    static pid_handle_t bench_pid;
+    static float bench_duty = 0.0f;
+    static float bench_voltage = 0.0f;
+    pid_init(&bench_pid, target_bus_voltage, &bench_duty, &bench_voltage);
+    static observer_t bench_obs;
+    observer_init(&bench_obs, &bus_observer.cfg, 10.0f);
+
+    bench_register("ina226_read_all", bench_ina226_read_all, NULL);
+    bench_register("OLED_update", bench_oled_update, NULL);
+    bench_register("OLED_show_string", bench_oled_show_string, NULL);
+    bench_register("pwm_set", bench_pwm_set, NULL);
+    bench_register("pid_timer_isr", bench_pid_timer_isr, &bench_pid);
+    bench_register("observer_cycle", bench_observer_cycle, &bench_obs);
+
+    // 带噪声与尖峰的输入，避免中值的分支被完全预测
+    uint32_t seed = 1;
+    for (int i = 0; i < BENCH_FILTER_BLOCK; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        bench_filter_in[i] = 12.0f + (float)(seed >> 16) * 1e-5f + ((seed >> 28) == 0 ? 5.0f : 0.0f);
+    }
+    static filter_biquad_cascade_t bench_lpf;
+    static filter_moving_avg_t bench_avg;
+    static filter_median_t bench_median_blk;
+    static filter_median_t bench_median_smp;
+    filter_cascade_butterworth_lowpass(&bench_lpf, 4, 1000.0f, 20000.0f);
+    filter_moving_avg_init(&bench_avg, 16);
+    filter_median_init(&bench_median_blk, BUS_FILTER_MEDIAN);
+    filter_median_init(&bench_median_smp, BUS_FILTER_MEDIAN);
+    bench_register_block("filter_biquad4", bench_filter_biquad, &bench_lpf, BENCH_FILTER_BLOCK);
+    bench_register_block("filter_moving_avg", bench_filter_moving_avg, &bench_avg, BENCH_FILTER_BLOCK);
+    bench_register_block("filter_median", bench_filter_median, &bench_median_blk, BENCH_FILTER_BLOCK);
+    bench_register_block("filter_median_smp", bench_filter_median_sample, &bench_median_smp, BENCH_FILTER_BLOCK);
+    bench_run_all(CONFIG_APP_BENCHMARK_ITERATIONS);
+
+    OLED_clear();
+    OLED_update();
+}
+#endif
+
 void Show_OLED_Content(float target_v_out, float v_bus, float i_measure, float pwm_duty);
+static void register_commands(void);
+static void analyzer_init(void);
+static void control_task(void *arg);
+static void ui_task(void *arg);
+#if CONFIG_APP_BENCHMARK
+static void run_benchmarks(void);
+#endif
+
+#if CONFIG_IDF_TARGET_LINUX
+static void control_timer_callback(void *arg) {
+    control_tick_us = esp_timer_get_time();
+    xTaskNotifyGive(control_task_handle);
+}
+#else
+static bool IRAM_ATTR control_timer_on_alarm(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *arg) {
+    control_tick_us = esp_timer_get_time();
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(control_task_handle, &woken);
+    return woken == pdTRUE;
+}
+#endif
 
+// 由控制任务自身调用：GPTimer 的中断在注册回调时分配到调用者所在的核，即 APP_CORE_CONTROL
+static void control_timer_start(void) {
+#if CONFIG_IDF_TARGET_LINUX
+    const esp_timer_create_args_t timer_args = {
+        .callback = control_timer_callback,
+        .name = "control_timer"
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &control_timer));
+    ESP_ERROR_CHECK(esp_timer_start_periodic(control_timer, CONTROL_PERIOD_US));
+#else
+    gptimer_config_t timer_cfg = {
+        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = 1000000,
+    };
+    ESP_ERROR_CHECK(gptimer_new_timer(&timer_cfg, &control_timer));
+    gptimer_alarm_config_t alarm_cfg = {
+        .alarm_count = CONTROL_PERIOD_US,
+        .reload_count = 0,
+        .flags.auto_reload_on_alarm = true,
+    };
+    ESP_ERROR_CHECK(gptimer_set_alarm_action(control_timer, &alarm_cfg));
+    gptimer_event_callbacks_t cbs = {
+        .on_alarm = control_timer_on_alarm,
+    };
+    ESP_ERROR_CHECK(gptimer_register_event_callbacks(control_timer, &cbs, NULL));
+    ESP_ERROR_CHECK(gptimer_enable(control_timer));
+    ESP_ERROR_CHECK(gptimer_start(control_timer));
+#endif
+    boot_control_us = esp_timer_get_time();
+}
+
+// 记录从上一个标记到现在的耗时，归入 name 步骤
+static void boot_step(const char *name) {
+    int64_t now = esp_timer_get_time();
+    if (boot_step_count < BOOT_STEPS_MAX) {
+        boot_steps[boot_step_count].name = name;
+        boot_steps[boot_step_count].us = (uint32_t)(now - boot_mark_us);
+        boot_step_count++;
+    }
+    boot_mark_us = now;
+}
+
+// 启动顺序按"尽快进入调节"安排：只有控制环依赖的外设在控制任务启动前初始化，
+// OLED、数据记录扫描、谐波分析与命令服务放在控制环启动之后，此时控制核已在调节输出
 void app_main(void) {
-    gpio_init(GPIO_NUM_2, GPIO_MODE_OUTPUT, 0);
+    boot_entry_us = boot_mark_us = esp_timer_get_time();
 
-    uart_timer_service_init();
+    gpio_init(GPIO_NUM_2, GPIO_MODE_OUTPUT, 0);
     uart_init(UART_NUM_0);
+    uart_telemetry_init(UART_NUM_1, GPIO_NUM_23);
+    boot_step("uart");
+
+    // 配置缺失或损坏时 app_cfg 为默认值，照常启动
+    app_config_load(&app_cfg);
+    target_bus_voltage = app_cfg.vset;
+    boot_step("config");
 
-    pwm_instance_t pwm_inst = {0};
-    pwm_instance_t pwm_inst_conj = {0};
-    pwm_init_conj(20000, 0, &pwm_inst, GPIO_NUM_51, &pwm_inst_conj, GPIO_NUM_52);
+    pwm_init_conj(app_cfg.pwm_freq_hz, 0, &pwm_inst, GPIO_NUM_51, &pwm_inst_conj, GPIO_NUM_52);
+    boot_step("pwm");
 
     i2c_timer_service_start();
     i2c_init(I2C_NUM_0, GPIO_NUM_19, GPIO_NUM_18);
     i2c_init(I2C_NUM_1, GPIO_NUM_21, GPIO_NUM_22);
+    boot_step("i2c");
+
+    ina226_init();
+    boot_step("ina226");
+
+    // 在控制环启动前接好刹车，第一次开关就处于保护之下
+    protect_config_t prot_cfg = {
+        .pwm = &pwm_inst,
+        .pwm_conj = &pwm_inst_conj,
+        .alert_gpio = PROTECT_ALERT_GPIO,
+        .comparator_gpio = PROTECT_COMPARATOR_GPIO,
+        .oc_limit_a = app_cfg.oc_limit_a,
+        .ov_limit_v = app_cfg.ov_limit_v,
+        .retry_max = PROTECT_RETRY_MAX,
+        .retry_delay_ms = PROTECT_RETRY_DELAY_MS,
+    };
+    protect_init(&prot_cfg);
+    boot_step("protect");
+
+    // 目前只有输出侧 INA226；接入输入侧传感器后添加 "in" 通道并调用 meter_set_efficiency_pair 即可得到效率
+    meter_init(0);
+    meter_out = meter_channel_add("out");
+
+    filter_median_init(&bus_median, BUS_FILTER_MEDIAN);
+    filter_cascade_butterworth_lowpass(&bus_lpf, 2, BUS_FILTER_FC_HZ, BUS_FILTER_FS_HZ);
+    observer_config_t obs_cfg = {
+        .l_h = BUS_OBSERVER_L_H,
+        .c_f = BUS_OBSERVER_C_F,
+        .r_ohm = BUS_OBSERVER_R_OHM,
+        .period_s = CONTROL_PERIOD_US / 1e6f,
+        .q_v = BUS_OBSERVER_Q_V,
+        .q_i = BUS_OBSERVER_Q_I,
+        .q_b = BUS_OBSERVER_Q_B,
+        .r_v = BUS_OBSERVER_R_V,
+    };
+    ESP_ERROR_CHECK(observer_init(&bus_observer, &obs_cfg, 0.0f));
+    // PID 不再使用独立定时器，而是在控制任务中紧跟测量执行
+    pid_init(&pid, target_bus_voltage, &current_pwm_duty, &current_bus_voltage);
+    // 前馈给出理想变换比对应的占空比，启动、目标值阶跃与输入阶跃都不必等积分项爬升
+    pid_set_feedforward(&pid, (pid_ff_topology_t)app_cfg.ff_topology, &input_voltage);
+
+    // 参数注册只是填表，提前完成后配置经同一套范围检查与 setter 下发到各模块
+    register_commands();
+    app_config_apply(&app_cfg);
+    boot_step("control_init");
 
+#if CONFIG_APP_BENCHMARK
+    // 在控制任务启动前运行，独占 I2C 总线与 PWM，避免相互干扰计时
     OLED_init();
+    run_benchmarks();
+    boot_step("bench");
+#endif
+
+    ring_init(&ui_ring, ui_ring_storage, sizeof(ui_snapshot_t), UI_SNAPSHOT_QUEUE_SIZE);
+    // 控制任务优先级高于 app_main，创建后立即在控制核上启动周期定时器
+    xTaskCreatePinnedToCore(control_task, "control", CONTROL_TASK_STACK_SIZE, NULL, CONTROL_TASK_PRIORITY, &control_task_handle, APP_CORE_CONTROL);
+    boot_step("control_start");
+
+    // 以下步骤与控制环并行，OLED 与 INA226 分别在两条 I2C 总线上
+#if !CONFIG_APP_BENCHMARK
+    OLED_init();
+#endif
     OLED_update();
+    boot_step("oled");
 
-    ina226_data_t ina226_data = {0};
-    ina226_init();
+    // 分区不存在时只打印警告，其余功能照常运行
+    datalog_init();
+    boot_step("datalog");
 
-    float target_bus_voltage = 10.0f;
-    float current_pwm_duty = 0.0f;
-    float current_bus_voltage = 0.0f;
-    pid_handle_t pid = {0};
-    pid_init(&pid, target_bus_voltage, &current_pwm_duty, &current_bus_voltage);
-    pid_timer_service_init(&pid);
+    analyzer_init();
+    boot_step("analyzer");
+
+    // 命令在独立任务中解析，不占用控制循环
+    cmd_service_start();
+    xTaskCreatePinnedToCore(ui_task, "ui", UI_TASK_STACK_SIZE, NULL, UI_TASK_PRIORITY, NULL, APP_CORE_UI);
+    boot_step("ui");
+
+    boot_ready_us = esp_timer_get_time();
+    ESP_LOGI(TAG, "Boot: app_main at %" PRId64 "us, control loop at %" PRId64 "us, ready at %" PRId64 "us",
+             boot_entry_us, boot_control_us, boot_ready_us);
+    for (int i = 0; i < boot_step_count; ++i) {
+        ESP_LOGI(TAG, "  %-14s %8" PRIu32 "us", boot_steps[i].name, boot_steps[i].us);
+    }
+}
 
+// 控制任务：测量 -> 滤波 / 观测器 -> PID -> PWM，每个周期由定时器唤醒一次
+static void control_task(void *arg) {
+    ina226_data_t ina226_data = {0};
+    float last_bus_v = NAN;
+    float last_shunt_mv = NAN;
+    float bus_filtered = 0.0f;
+    uint32_t snapshot_count = 0;
+    uint32_t datalog_count = 0;
+    control_timer_start();
     while (1) {
-        uart_content_t* cmd = uart_read();
-        if (cmd != NULL) {
-            ESP_LOGI(TAG, "Received command: %s", cmd->data);
-            char *cmd_str = (char*)cmd->data;
-
-            // 处理Reset命令
-            if (strcmp(cmd_str, "R") == 0) {
-                pid_reset(&pid);
-                ESP_LOGI(TAG, "PID reset completed");
-            }
-            // 处理电压设置命令 V:<float>
-            else if (strncmp(cmd_str, "V:", 2) == 0) {
-                float set_voltage = strtof(cmd_str + 2, NULL);
-                if (set_voltage >= 10.0f && set_voltage <= 18.0f) {
-                    target_bus_voltage = set_voltage;
-                    ESP_LOGI(TAG, "Set target bus voltage: %.2fV", set_voltage);
-                    change_pid_setpoint(&pid, target_bus_voltage);
-                }
-            }
-            // 处理PID参数设置命令 K:<P/I/D>:<float>
-            else if (strncmp(cmd_str, "K:", 2) == 0) {
-                char param_type = cmd_str[2];
-                if (cmd_str[3] == ':') {
-                    float param_value = strtof(cmd_str + 4, NULL);
-                    switch (param_type) {
-                        case 'P':
-                            pid_set_kp(&pid, param_value);
-                            ESP_LOGI(TAG, "Set Kp: %.3f", param_value);
-                            break;
-                        case 'I':
-                            pid_set_ki(&pid, param_value);
-                            ESP_LOGI(TAG, "Set Ki: %.3f", param_value);
-                            break;
-                        case 'D':
-                            pid_set_kd(&pid, param_value);
-                            ESP_LOGI(TAG, "Set Kd: %.3f", param_value);
-                            break;
-                        default:
-                            ESP_LOGW(TAG, "Invalid PID parameter: %c", param_type);
-                            break;
-                    }
-                }
-            }
-            // 兼容原有的直接数字输入（作为电压设置）
-            else {
-                float set_voltage = strtof(cmd_str, NULL);
-                if (set_voltage >= 10.0f && set_voltage <= 18.0f) {
-                    target_bus_voltage = set_voltage;
-                    ESP_LOGI(TAG, "Set target bus voltage: %.2fV", set_voltage);
-                    change_pid_setpoint(&pid, target_bus_voltage);
-                }
+        uint32_t pending = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        // 本周期对应的定时中断时刻；周期执行中到来的下一次中断会改写 control_tick_us，因此在唤醒时取出
+        int64_t tick_us = control_tick_us;
+        int64_t t0 = esp_timer_get_time();
+        TRACE_BEGIN(CONTROL);
+        if (pending > 1) TRACE_INSTANT(OVERRUN, pending - 1);
+
+        TRACE_BEGIN(INA226_READ);
+        esp_err_t read_ret = ina226_read_all(&ina226_data);
+        TRACE_END(INA226_READ);
+        if (read_ret != ESP_OK) {
+            control_stats.ina226_errors++;
+        } else {
+            // 用未滤波的读数比较，软件通路不叠加滤波延迟
+            protect_check(ina226_data.bus_voltage_v, ina226_data.current_ma / 1000.0f);
+            meter_update(meter_out, t0, ina226_data.bus_voltage_v, ina226_data.current_ma / 1000.0f);
+            bus_filtered = filter_cascade_process(&bus_lpf, filter_median_process(&bus_median, ina226_data.bus_voltage_v));
+            // 转换周期长于控制周期时寄存器会保持上一次的结果，只有数值变化才算新样本；不读 CVRF 标志，
+            // 读 Mask/Enable 会清除保护使用的锁存报警。新样本在上一次读取之后完成，平均意义上是半个控制周期前，
+            // 对应转换窗口的中点再早半个转换周期
+            if (ina226_data.bus_voltage_v != last_bus_v || ina226_data.shunt_voltage_mv != last_shunt_mv) {
+                last_bus_v = ina226_data.bus_voltage_v;
+                last_shunt_mv = ina226_data.shunt_voltage_mv;
+                control_stats.ina226_samples++;
+                int64_t sample_us = t0 - CONTROL_PERIOD_US / 2 - ina226_conversion_period_us(ina226_get_config()) / 2;
+                observer_update(&bus_observer, sample_us, ina226_data.bus_voltage_v);
             }
         }
-
+        current_bus_voltage = observer_enabled != 0.0f ? observer_voltage(&bus_observer) : bus_filtered;
+        if (boot_regulated_us == 0 && fabsf(current_bus_voltage - target_bus_voltage) <= target_bus_voltage * BOOT_REGULATION_BAND) {
+            boot_regulated_us = t0;
+        }
+        if (protect_tripped()) {
+            // 输出已被刹车关断：清空积分并把占空比压到下限，恢复后前馈从 0 渐入重新起步
+            pid_reset(&pid);
+            current_pwm_duty = pid.input_min;
+        } else {
+            TRACE_BEGIN(PID);
+            pid_timer_isr(&pid);
+            TRACE_END(PID);
+            control_stats.pid_ticks++;
+        }
         pwm_set(current_pwm_duty, &pwm_inst);
+        // 刹车期间功率管全部关断，驱动电压按零预测
+        float drive_v = protect_tripped() ? 0.0f : current_pwm_duty / 100.0f * input_voltage;
+        observer_predict(&bus_observer, t0, drive_v, ina226_data.current_ma / 1000.0f);
+        TRACE_COUNTER(VBUS, current_bus_voltage * 1000.0f);
+        TRACE_COUNTER(DUTY, current_pwm_duty * 100.0f);
+
+        uart_telemetry_sample_t sample = {
+            .timestamp_us = (uint32_t)t0,
+            .bus_voltage_mv = (uint16_t)app_clamp_fixed(current_bus_voltage * 1000.0f, 0.0f, UINT16_MAX),
+            .current_01ma = (int16_t)app_clamp_fixed(ina226_data.current_ma * 10.0f, INT16_MIN, INT16_MAX),
+            .duty_001 = (uint16_t)app_clamp_fixed(current_pwm_duty * 100.0f, 0.0f, UINT16_MAX),
+            .setpoint_mv = (uint16_t)app_clamp_fixed(target_bus_voltage * 1000.0f, 0.0f, UINT16_MAX),
+        };
+        uart_telemetry_push(&sample);
+
+        if (++datalog_count >= DATALOG_DIVIDER) {
+            datalog_count = 0;
+            datalog_push(t0, current_bus_voltage, ina226_data.current_ma / 1000.0f, current_pwm_duty);
+        }
+
+        if (++snapshot_count >= UI_SNAPSHOT_DIVIDER) {
+            snapshot_count = 0;
+            ui_snapshot_t snap = {
+                .target_v = target_bus_voltage,
+                .bus_v = current_bus_voltage,
+                .current_a = ina226_data.current_ma / 1000.0f,
+                .duty = current_pwm_duty,
+            };
+            ring_push(&ui_ring, &snap);
+        }
 
-        ina226_read_all(&ina226_data);
-        current_bus_voltage = ina226_data.bus_voltage_v;
+        TRACE_END(CONTROL);
+        int64_t t1 = esp_timer_get_time();
+        uint32_t elapsed = (uint32_t)(t1 - t0);
+        control_stats.last_us = elapsed;
+        if (elapsed > control_stats.max_us) control_stats.max_us = elapsed;
+        // 超时只在这里计数：一个周期迟到或执行过长只算一次，合并掉的定时中断由 OVERRUN 追踪事件记录
+        if (t1 - tick_us > CONTROL_PERIOD_US) control_stats.overruns++;
+        control_stats.cycles++;
+    }
+}
+
+// 界面任务：取出最新快照刷新 OLED，I2C 刷屏耗时只占用界面核
+static void ui_task(void *arg) {
+    ui_snapshot_t snap = {0};
+    while (1) {
+        while (ring_pop(&ui_ring, &snap)) {}
+        Show_OLED_Content(snap.target_v, snap.bus_v, snap.current_a, snap.duty);
+        vTaskDelay(pdMS_TO_TICKS(UI_REFRESH_MS));
+    }
+}
+
+static void analyzer_adc_block(const uint16_t *samples, int count, int channel_count, int64_t first_timestamp_us, void *arg) {
+    harmonic_feed_block(samples, count, channel_count);
+}
 
-        Show_OLED_Content(target_bus_voltage, current_bus_voltage, ina226_data.current_ma / 1000.0f, current_pwm_duty);
-        vTaskDelay(pdMS_TO_TICKS(1));
+// ADC 采样率标称为开关频率整数倍（自由运行，不与 PWM 硬件同步），谐波分析在后台任务中进行
+static void analyzer_init(void) {
+    static const uint8_t channels[] = { ANALYZER_ADC_CHANNEL };
+    adc_cont_config_t adc_cfg = {
+        .channels = channels,
+        .channel_count = 1,
+        .switching_freq_hz = app_cfg.pwm_freq_hz,
+        .samples_per_period = ANALYZER_SAMPLES_PER_PERIOD,
+    };
+    if (adc_cont_init(&adc_cfg) != ESP_OK) {
+        ESP_LOGW(TAG, "Analyzer ADC unavailable, ripple analysis disabled");
+        return;
     }
+    harmonic_config_t harm_cfg = {
+        .sample_rate_hz = (float)adc_cont_sample_rate(),
+        .window = ANALYZER_WINDOW,
+        .switching_hz = (float)app_cfg.pwm_freq_hz,
+        .harmonics = 10,
+        .scale = 3.3f / ADC_CONT_FULL_SCALE * ANALYZER_DIVIDER_RATIO,
+    };
+    ESP_ERROR_CHECK(harmonic_init(&harm_cfg));
+    ESP_ERROR_CHECK(adc_cont_start(analyzer_adc_block, NULL));
+}
+
+static esp_err_t set_target_voltage(void *ctx, float value) {
+    change_pid_setpoint(&pid, value);
+    ESP_LOGI(TAG, "Set target bus voltage: %.2fV", value);
+    return ESP_OK;
+}
+
+static esp_err_t set_input_voltage(void *ctx, float value) {
+#if CONFIG_IDF_TARGET_LINUX
+    // 仿真中把参数当作输入电压阶跃，前馈取到的值即理想的输入侧测量
+    sim_plant_set_vin(value);
+#endif
+    return ESP_OK;
+}
+
+static float get_pwm_freq(void *ctx) {
+    return (float)(MCPWM_RESOLUTION_HZ / pwm_inst.period_ticks);
+}
+
+static esp_err_t set_pwm_freq(void *ctx, float value) {
+    // 互补对共用定时器与比较器，由主实例改写，共轭实例的 period_ticks 随之同步；
+    // 失败时周期不变，"set freq=" 与 NVS 配置的应用都会报告错误
+    return pwm_set_freq((uint32_t)value, &pwm_inst);
+}
+
+// R：重置 PID 状态
+static void cmd_reset(const char *args, char *reply, size_t reply_size) {
+    pid_reset(&pid);
+    snprintf(reply, reply_size, "OK PID reset");
+}
+
+// V:<float>：设置目标电压（旧格式）
+static void cmd_voltage(const char *args, char *reply, size_t reply_size) {
+    esp_err_t ret = cmd_param_set("vset", strtof(args, NULL));
+    snprintf(reply, reply_size, ret == ESP_OK ? "OK" : "ERR vset out of range");
+}
+
+// K:<P/I/D>:<float>：设置 PID 参数（旧格式）
+static void cmd_gain(const char *args, char *reply, size_t reply_size) {
+    const char *name = NULL;
+    switch (args[0]) {
+        case 'P': name = "kp"; break;
+        case 'I': name = "ki"; break;
+        case 'D': name = "kd"; break;
+        default: break;
+    }
+    if (!name || args[1] != ':') {
+        snprintf(reply, reply_size, "ERR invalid PID parameter");
+        return;
+    }
+    esp_err_t ret = cmd_param_set(name, strtof(args + 2, NULL));
+    snprintf(reply, reply_size, ret == ESP_OK ? "OK" : "ERR %s out of range", name);
+}
+
+// rt：控制任务运行统计
+static void cmd_realtime(const char *args, char *reply, size_t reply_size) {
+    snprintf(reply, reply_size, "cycles=%" PRIu32 " overruns=%" PRIu32 " last=%" PRIu32 "us max=%" PRIu32 "us budget=%dus",
+             control_stats.cycles, control_stats.overruns, control_stats.last_us, control_stats.max_us, CONTROL_PERIOD_US);
+}
+
+// boot：启动各步骤耗时，以及控制环启动、首次进入调节带、初始化完成的时刻
+static void cmd_boot(const char *args, char *reply, size_t reply_size) {
+    int len = snprintf(reply, reply_size, "entry=%" PRId64 "us control=%" PRId64 "us regulated=%" PRId64 "us ready=%" PRId64 "us",
+                       boot_entry_us, boot_control_us, boot_regulated_us, boot_ready_us);
+    for (int i = 0; i < boot_step_count && len > 0 && (size_t)len < reply_size; ++i) {
+        len += snprintf(reply + len, reply_size - len, " %s=%" PRIu32, boot_steps[i].name, boot_steps[i].us);
+    }
+}
+
+// ADC 连续采样状态：标称/实测采样率及是否满足周期同步
+static void cmd_adc(const char *args, char *reply, size_t reply_size) {
+    adc_cont_stats_t st;
+    adc_cont_get_stats(&st);
+    snprintf(reply, reply_size, "rate=%" PRIu32 "Hz measured=%" PRIu32 "Hz err=%" PRId32 "ppm sync=%d periods=%" PRIu32 " blocks=%" PRIu32 " overflows=%" PRIu32,
+             adc_cont_sample_rate(), st.measured_rate_hz, st.rate_error_ppm,
+             adc_cont_synchronized(), adc_cont_periods_per_block(), st.blocks,
+             st.pool_overflows);
+}
+
+// 兼容原有的直接数字输入（作为电压设置）
+static void cmd_fallback_voltage(const char *line, char *reply, size_t reply_size) {
+    char *end = NULL;
+    strtof(line, &end);
+    if (end == line) {
+        snprintf(reply, reply_size, "ERR unknown command");
+        return;
+    }
+    cmd_voltage(line, reply, reply_size);
+}
+
+static void register_commands(void) {
+    cmd_register_param(&(cmd_param_t){ .name = "vset", .type = CMD_PARAM_FLOAT, .min = TARGET_VOLTAGE_MIN, .max = TARGET_VOLTAGE_MAX,
+                                       .value = &target_bus_voltage, .setter = set_target_voltage });
+    cmd_register_param(&(cmd_param_t){ .name = "vin", .type = CMD_PARAM_FLOAT, .min = INPUT_VOLTAGE_MIN, .max = INPUT_VOLTAGE_MAX,
+                                       .value = &input_voltage, .setter = set_input_voltage });
+    cmd_register_param(&(cmd_param_t){ .name = "freq", .type = CMD_PARAM_INT, .min = 1000, .max = 200000,
+                                       .getter = get_pwm_freq, .setter = set_pwm_freq });
+    pid_register_params(&pid);
+    ina226_register_params();
+    harmonic_register_commands();
+    meter_register_commands();
+    trace_register_commands();
+    datalog_register_commands();
+    app_config_register_commands();
+    protect_register_commands();
+    stats_register_commands();
+    stats_register_counter("loop", &control_stats.cycles, true);
+    stats_register_counter("pid", &control_stats.pid_ticks, true);
+    stats_register_counter("overrun", &control_stats.overruns, false);
+    stats_register_counter("ina_err", &control_stats.ina226_errors, false);
+    stats_register_counter("ina_new", &control_stats.ina226_samples, true);
+    observer_register_commands(&bus_observer);
+    cmd_register_param(&(cmd_param_t){ .name = "obs_en", .type = CMD_PARAM_BOOL, .min = 0, .max = 1,
+                                       .value = &observer_enabled });
+
+    cmd_register_command("R", cmd_reset);
+    cmd_register_command("V", cmd_voltage);
+    cmd_register_command("K", cmd_gain);
+    cmd_register_command("rt", cmd_realtime);
+    cmd_register_command("boot", cmd_boot);
+    cmd_register_command("adc", cmd_adc);
+    cmd_register_fallback(cmd_fallback_voltage);
 }
 
 void Show_OLED_Content(float target_v_out, float v_bus, float i_measure, float pwm_duty) {
@@ -116,5 +678,11 @@ void Show_OLED_Content(float target_v_out, float v_bus, float i_measure, float p
     OLED_show_string(0, 32, buf, OLED_6X8);
     snprintf(buf, sizeof(buf), "PWM Duty: %.3f%%", pwm_duty);
     OLED_show_string(0, 48, buf, OLED_6X8);
+    harmonic_result_t harm;
+    harmonic_get_result(&harm);
+    if (harm.sequence > 0) {
+        snprintf(buf, sizeof(buf), "Ripple: %.1fmV", harm.ripple * 1000.0f);
+        OLED_show_string(0, 56, buf, OLED_6X8);
+    }
     OLED_update();
 }
\ No newline at end of file
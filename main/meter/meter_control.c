@@ -0,0 +1,224 @@
+#include "meter_control.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef struct {
+    float min;
+    float max;
+    float sum;
+    uint32_t count;
+} meter_window_acc_t;
+
+typedef struct {
+    bool used;
+    char name[METER_NAME_MAX];
+    // 积分量：整数部分与不足 1 nJ / 1 nC 的余数（单位 0.5 pJ / 0.5 pC）
+    int64_t energy_nj;
+    int64_t charge_nc;
+    int64_t energy_rem;
+    int64_t charge_rem;
+    int64_t elapsed_us;
+    // 上一个样本
+    bool has_last;
+    int64_t last_ts_us;
+    int64_t last_power_uw;
+    int64_t last_current_ua;
+    // 窗口统计
+    int64_t window_start_us;
+    meter_window_acc_t acc[3];       // 电压、电流、功率
+    meter_stat_t window[3];          // 最近一个完整窗口
+    uint32_t samples;
+    uint32_t gaps;
+} meter_channel_t;
+
+static meter_channel_t s_channels[METER_CHANNELS_MAX];
+static uint32_t s_window_us = METER_DEFAULT_WINDOW_US;
+static int s_eff_in = -1;
+static int s_eff_out = -1;
+static portMUX_TYPE s_meter_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static void meter_window_clear(meter_window_acc_t *acc)
+{
+    acc->min = INFINITY;
+    acc->max = -INFINITY;
+    acc->sum = 0.0f;
+    acc->count = 0;
+}
+
+static void meter_window_add(meter_window_acc_t *acc, float x)
+{
+    if (x < acc->min) acc->min = x;
+    if (x > acc->max) acc->max = x;
+    acc->sum += x;
+    acc->count++;
+}
+
+static void meter_channel_clear(meter_channel_t *ch)
+{
+    ch->energy_nj = 0;
+    ch->charge_nc = 0;
+    ch->energy_rem = 0;
+    ch->charge_rem = 0;
+    ch->elapsed_us = 0;
+    ch->has_last = false;
+    ch->samples = 0;
+    ch->gaps = 0;
+    for (int k = 0; k < 3; ++k) {
+        meter_window_clear(&ch->acc[k]);
+        memset(&ch->window[k], 0, sizeof(ch->window[k]));
+    }
+}
+
+void meter_init(uint32_t window_us)
+{
+    memset(s_channels, 0, sizeof(s_channels));
+    s_window_us = window_us ? window_us : METER_DEFAULT_WINDOW_US;
+    s_eff_in = -1;
+    s_eff_out = -1;
+}
+
+int meter_channel_add(const char *name)
+{
+    for (int i = 0; i < METER_CHANNELS_MAX; ++i) {
+        if (s_channels[i].used) continue;
+        meter_channel_clear(&s_channels[i]);
+        strncpy(s_channels[i].name, name ? name : "", METER_NAME_MAX - 1);
+        s_channels[i].used = true;
+        return i;
+    }
+    return -1;
+}
+
+void meter_update(int channel, int64_t timestamp_us, float voltage_v, float current_a)
+{
+    if (channel < 0 || channel >= METER_CHANNELS_MAX || !s_channels[channel].used) return;
+    meter_channel_t *ch = &s_channels[channel];
+    float power_w = voltage_v * current_a;
+    int64_t power_uw = llroundf(power_w * 1e6f);
+    int64_t current_ua = llroundf(current_a * 1e6f);
+
+    portENTER_CRITICAL(&s_meter_lock);
+    if (ch->has_last) {
+        int64_t dt = timestamp_us - ch->last_ts_us;
+        if (dt > 0 && dt <= METER_MAX_GAP_US) {
+            // 梯形积分：(p0 + p1) × dt 的单位为 0.5 pJ，满 2000 进位为 1 nJ，余数留到下次
+            ch->energy_rem += (ch->last_power_uw + power_uw) * dt;
+            ch->energy_nj += ch->energy_rem / 2000;
+            ch->energy_rem %= 2000;
+            ch->charge_rem += (ch->last_current_ua + current_ua) * dt;
+            ch->charge_nc += ch->charge_rem / 2000;
+            ch->charge_rem %= 2000;
+            ch->elapsed_us += dt;
+        } else {
+            ch->gaps++;
+        }
+    } else {
+        ch->window_start_us = timestamp_us;
+    }
+    ch->has_last = true;
+    ch->last_ts_us = timestamp_us;
+    ch->last_power_uw = power_uw;
+    ch->last_current_ua = current_ua;
+    ch->samples++;
+
+    meter_window_add(&ch->acc[0], voltage_v);
+    meter_window_add(&ch->acc[1], current_a);
+    meter_window_add(&ch->acc[2], power_w);
+    if (timestamp_us - ch->window_start_us >= s_window_us) {
+        for (int k = 0; k < 3; ++k) {
+            meter_window_acc_t *acc = &ch->acc[k];
+            ch->window[k].min = acc->min;
+            ch->window[k].max = acc->max;
+            ch->window[k].avg = acc->sum / acc->count;
+            meter_window_clear(acc);
+        }
+        ch->window_start_us = timestamp_us;
+    }
+    portEXIT_CRITICAL(&s_meter_lock);
+}
+
+esp_err_t meter_get_reading(int channel, meter_reading_t *reading)
+{
+    if (channel < 0 || channel >= METER_CHANNELS_MAX || !s_channels[channel].used || !reading) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    meter_channel_t *ch = &s_channels[channel];
+    portENTER_CRITICAL(&s_meter_lock);
+    reading->energy_wh = ch->energy_nj / 3.6e12;
+    reading->charge_ah = ch->charge_nc / 3.6e12;
+    reading->elapsed_s = ch->elapsed_us / 1e6f;
+    reading->voltage = ch->window[0];
+    reading->current = ch->window[1];
+    reading->power = ch->window[2];
+    reading->samples = ch->samples;
+    reading->gaps = ch->gaps;
+    portEXIT_CRITICAL(&s_meter_lock);
+    return ESP_OK;
+}
+
+void meter_reset(int channel)
+{
+    portENTER_CRITICAL(&s_meter_lock);
+    for (int i = 0; i < METER_CHANNELS_MAX; ++i) {
+        if (s_channels[i].used && (channel < 0 || channel == i)) meter_channel_clear(&s_channels[i]);
+    }
+    portEXIT_CRITICAL(&s_meter_lock);
+}
+
+void meter_set_efficiency_pair(int input_channel, int output_channel)
+{
+    s_eff_in = input_channel;
+    s_eff_out = output_channel;
+}
+
+esp_err_t meter_get_efficiency(meter_efficiency_t *eff)
+{
+    if (!eff) return ESP_ERR_INVALID_ARG;
+    if (s_eff_in < 0 || s_eff_out < 0 || !s_channels[s_eff_in].used || !s_channels[s_eff_out].used) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    portENTER_CRITICAL(&s_meter_lock);
+    float p_in = s_channels[s_eff_in].window[2].avg;
+    float p_out = s_channels[s_eff_out].window[2].avg;
+    int64_t e_in = s_channels[s_eff_in].energy_nj;
+    int64_t e_out = s_channels[s_eff_out].energy_nj;
+    portEXIT_CRITICAL(&s_meter_lock);
+    eff->window = p_in > 0.0f ? p_out / p_in : 0.0f;
+    eff->cumulative = e_in > 0 ? (float)((double)e_out / e_in) : 0.0f;
+    return ESP_OK;
+}
+
+// meter：每个通道一行，最后输出效率
+static void cmd_meter(const char *args, char *reply, size_t reply_size)
+{
+    int len = 0;
+    for (int i = 0; i < METER_CHANNELS_MAX && (size_t)len < reply_size; ++i) {
+        meter_reading_t r;
+        if (meter_get_reading(i, &r) != ESP_OK) continue;
+        len += snprintf(reply + len, reply_size - len,
+                        "%s%s: E=%.6fWh Q=%.6fAh t=%.1fs V=%.3f/%.3f/%.3f I=%.4f/%.4f/%.4f P=%.3f/%.3f/%.3f",
+                        len ? "\r\n" : "", s_channels[i].name, r.energy_wh, r.charge_ah, r.elapsed_s,
+                        r.voltage.min, r.voltage.avg, r.voltage.max,
+                        r.current.min, r.current.avg, r.current.max,
+                        r.power.min, r.power.avg, r.power.max);
+    }
+    meter_efficiency_t eff;
+    if ((size_t)len < reply_size && meter_get_efficiency(&eff) == ESP_OK) {
+        len += snprintf(reply + len, reply_size - len, "%seff=%.2f%% cum=%.2f%%",
+                        len ? "\r\n" : "", eff.window * 100.0f, eff.cumulative * 100.0f);
+    }
+    if (len == 0) snprintf(reply, reply_size, "ERR no channels");
+}
+
+static void cmd_meter_reset(const char *args, char *reply, size_t reply_size)
+{
+    meter_reset(-1);
+    snprintf(reply, reply_size, "OK meter reset");
+}
+
+void meter_register_commands(void)
+{
+    cmd_register_command("meter", cmd_meter);
+    cmd_register_command("meter_reset", cmd_meter_reset);
+}
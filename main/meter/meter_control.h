@@ -0,0 +1,55 @@
+// 电能计量模块头文件
+// 按样本的真实时间戳做梯形积分，能量与电荷以 nJ / nC 整数累加，余数保留到下一次，长时间运行不漂移
+// 同时输出时间窗口内的最小/最大/平均值，以及由输入/输出通道对计算的效率
+
+#pragma once
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "cmd/cmd_registry.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define METER_CHANNELS_MAX       4
+#define METER_NAME_MAX           8
+#define METER_DEFAULT_WINDOW_US  1000000   // 统计窗口 1 s
+#define METER_MAX_GAP_US         500000    // 相邻样本间隔超过该值视为断采，不跨越积分
+
+typedef struct {
+    float min;
+    float max;
+    float avg;
+} meter_stat_t;
+
+typedef struct {
+    double energy_wh;        // 累计能量，放电/回馈方向为负
+    double charge_ah;        // 累计电荷
+    float elapsed_s;         // 参与积分的总时长（不含断采）
+    meter_stat_t voltage;    // 最近一个完整窗口的统计，单位 V
+    meter_stat_t current;    // A
+    meter_stat_t power;      // W
+    uint32_t samples;
+    uint32_t gaps;           // 因间隔过长而跳过的积分区间
+} meter_reading_t;
+
+typedef struct {
+    float window;            // 最近一个窗口的 P_out_avg / P_in_avg
+    float cumulative;        // 自上次复位以来的 E_out / E_in
+} meter_efficiency_t;
+
+// window_us 为 0 时使用 METER_DEFAULT_WINDOW_US
+void meter_init(uint32_t window_us);
+// 添加一个计量通道，返回通道号，失败返回 -1；name 会被复制
+int meter_channel_add(const char *name);
+// 送入一个样本：timestamp_us 为采样时刻（esp_timer_get_time 时基）
+void meter_update(int channel, int64_t timestamp_us, float voltage_v, float current_a);
+
+esp_err_t meter_get_reading(int channel, meter_reading_t *reading);
+void meter_reset(int channel);   // channel < 0 复位所有通道
+
+// 指定效率计算使用的输入/输出通道
+void meter_set_efficiency_pair(int input_channel, int output_channel);
+esp_err_t meter_get_efficiency(meter_efficiency_t *eff);
+
+// 注册 "meter"（输出所有通道读数与效率）与 "meter_reset" 命令
+void meter_register_commands(void);
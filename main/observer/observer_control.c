@@ -0,0 +1,310 @@
+#include "observer_control.h"
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "OBSERVER";
+
+// 初始协方差：电压 (V²)、电感电流 (A²)、驱动偏差 (V²)
+#define OBSERVER_P0_V   1.0f
+#define OBSERVER_P0_I   1.0f
+#define OBSERVER_P0_B   1.0f
+
+#define OBSERVER_AUG    (OBSERVER_STATES + 2)
+
+static observer_t *s_cmd_obs = NULL;
+
+#define OBSERVER_AVG_STEPS  64   // 计算周期平均时对一个周期的细分数
+
+// 增广矩阵 m·t 的矩阵指数：缩放到范数小于 0.5 后做 Taylor 展开再平方回来
+static void observer_expm(double m[OBSERVER_AUG][OBSERVER_AUG], double t, double e[OBSERVER_AUG][OBSERVER_AUG])
+{
+    double norm = 0.0;
+    for (int i = 0; i < OBSERVER_AUG; ++i) {
+        double row = 0.0;
+        for (int j = 0; j < OBSERVER_AUG; ++j) row += fabs(m[i][j]);
+        if (row > norm) norm = row;
+    }
+    int squarings = 0;
+    while (norm * t > 0.5) {
+        t *= 0.5;
+        squarings++;
+    }
+
+    double term[OBSERVER_AUG][OBSERVER_AUG] = {0};
+    double tmp[OBSERVER_AUG][OBSERVER_AUG];
+    memset(e, 0, sizeof(double) * OBSERVER_AUG * OBSERVER_AUG);
+    for (int i = 0; i < OBSERVER_AUG; ++i) e[i][i] = term[i][i] = 1.0;
+    for (int k = 1; k <= 10; ++k) {
+        for (int i = 0; i < OBSERVER_AUG; ++i) {
+            for (int j = 0; j < OBSERVER_AUG; ++j) {
+                double s = 0.0;
+                for (int n = 0; n < OBSERVER_AUG; ++n) s += term[i][n] * m[n][j];
+                tmp[i][j] = s * t / k;
+            }
+        }
+        for (int i = 0; i < OBSERVER_AUG; ++i) {
+            for (int j = 0; j < OBSERVER_AUG; ++j) {
+                term[i][j] = tmp[i][j];
+                e[i][j] += tmp[i][j];
+            }
+        }
+    }
+    while (squarings-- > 0) {
+        for (int i = 0; i < OBSERVER_AUG; ++i) {
+            for (int j = 0; j < OBSERVER_AUG; ++j) {
+                double s = 0.0;
+                for (int n = 0; n < OBSERVER_AUG; ++n) s += e[i][n] * e[n][j];
+                tmp[i][j] = s;
+            }
+        }
+        memcpy(e, tmp, sizeof(tmp));
+    }
+}
+
+// 增广矩阵 [[A, B], [0, 0]] 的指数同时给出 Φ 与 Γ；其第一行在一个周期内的平均给出周期平均电压的系数
+static void observer_discretize(observer_t *obs)
+{
+    const observer_config_t *c = &obs->cfg;
+    double m[OBSERVER_AUG][OBSERVER_AUG] = {0};
+    m[0][1] = 1.0 / c->c_f;
+    m[0][4] = -1.0 / c->c_f;
+    m[1][0] = -1.0 / c->l_h;
+    m[1][1] = -c->r_ohm / c->l_h;
+    m[1][2] = -1.0 / c->l_h;
+    m[1][3] = 1.0 / c->l_h;
+
+    double e[OBSERVER_AUG][OBSERVER_AUG];
+    observer_expm(m, c->period_s, e);
+    for (int i = 0; i < OBSERVER_STATES; ++i) {
+        for (int j = 0; j < OBSERVER_STATES; ++j) obs->phi[i][j] = (float)e[i][j];
+        obs->gamma[i][0] = (float)e[i][OBSERVER_STATES];
+        obs->gamma[i][1] = (float)e[i][OBSERVER_STATES + 1];
+    }
+
+    // 梯形积分：step 为细分步长的转移矩阵，row 为 e^(M·τ) 的第一行，随 τ 逐步推进
+    double step[OBSERVER_AUG][OBSERVER_AUG];
+    observer_expm(m, c->period_s / OBSERVER_AVG_STEPS, step);
+    double row[OBSERVER_AUG] = { 1.0 };
+    double acc[OBSERVER_AUG];
+    for (int j = 0; j < OBSERVER_AUG; ++j) acc[j] = 0.5 * row[j];
+    for (int k = 1; k <= OBSERVER_AVG_STEPS; ++k) {
+        double next[OBSERVER_AUG];
+        for (int j = 0; j < OBSERVER_AUG; ++j) {
+            double s = 0.0;
+            for (int n = 0; n < OBSERVER_AUG; ++n) s += row[n] * step[n][j];
+            next[j] = s;
+        }
+        memcpy(row, next, sizeof(row));
+        for (int j = 0; j < OBSERVER_AUG; ++j) acc[j] += (k == OBSERVER_AVG_STEPS ? 0.5 : 1.0) * row[j];
+    }
+    for (int j = 0; j < OBSERVER_STATES; ++j) obs->h_avg[j] = (float)(acc[j] / OBSERVER_AVG_STEPS);
+    obs->d_avg[0] = (float)(acc[OBSERVER_STATES] / OBSERVER_AVG_STEPS);
+    obs->d_avg[1] = (float)(acc[OBSERVER_STATES + 1] / OBSERVER_AVG_STEPS);
+}
+
+static inline observer_slot_t *observer_slot(observer_t *obs, uint32_t index)
+{
+    return &obs->history[index & (OBSERVER_HISTORY - 1)];
+}
+
+// from 的状态与协方差按其记录的输入推进一步写入 to：x' = Φx + Γu，P' = ΦPΦᵀ + Q
+static void observer_propagate(const observer_t *obs, const observer_slot_t *from, observer_slot_t *to)
+{
+    float fp[OBSERVER_STATES][OBSERVER_STATES];
+    for (int i = 0; i < OBSERVER_STATES; ++i) {
+        float x = obs->gamma[i][0] * from->drive_v + obs->gamma[i][1] * from->i_out_a;
+        for (int n = 0; n < OBSERVER_STATES; ++n) x += obs->phi[i][n] * from->x[n];
+        to->x[i] = x;
+        for (int j = 0; j < OBSERVER_STATES; ++j) {
+            float s = 0.0f;
+            for (int n = 0; n < OBSERVER_STATES; ++n) s += obs->phi[i][n] * from->p[n][j];
+            fp[i][j] = s;
+        }
+    }
+    for (int i = 0; i < OBSERVER_STATES; ++i) {
+        for (int j = i; j < OBSERVER_STATES; ++j) {
+            float s = 0.0f;
+            for (int n = 0; n < OBSERVER_STATES; ++n) s += fp[i][n] * obs->phi[j][n];
+            to->p[i][j] = to->p[j][i] = s;
+        }
+    }
+    // 同步整流下轻载电感电流可以反向（强制连续模式），负电流是合法状态，不做截断，模型保持线性
+    to->p[0][0] += obs->cfg.q_v;
+    to->p[1][1] += obs->cfg.q_i;
+    to->p[2][2] += obs->cfg.q_b;
+}
+
+static float observer_slot_average(const observer_t *obs, const observer_slot_t *slot)
+{
+    float v = obs->d_avg[0] * slot->drive_v + obs->d_avg[1] * slot->i_out_a;
+    for (int n = 0; n < OBSERVER_STATES; ++n) v += obs->h_avg[n] * slot->x[n];
+    return v;
+}
+
+void observer_reset(observer_t *obs, float v0)
+{
+    if (!obs) return;
+    observer_slot_t *slot = observer_slot(obs, obs->head);
+    float i_out = slot->i_out_a;
+    memset(slot->x, 0, sizeof(slot->x));
+    memset(slot->p, 0, sizeof(slot->p));
+    // 电感电流取最近的输出电流，即电容电流为零的稳态假设
+    slot->x[0] = v0;
+    slot->x[1] = i_out;
+    slot->p[0][0] = OBSERVER_P0_V;
+    slot->p[1][1] = OBSERVER_P0_I;
+    slot->p[2][2] = OBSERVER_P0_B;
+    obs->filled = 1;
+    obs->consecutive_rejects = 0;
+}
+
+esp_err_t observer_init(observer_t *obs, const observer_config_t *cfg, float v0)
+{
+    if (!obs || !cfg || cfg->l_h <= 0.0f || cfg->c_f <= 0.0f || cfg->r_ohm < 0.0f || cfg->period_s <= 0.0f ||
+        cfg->r_v <= 0.0f) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(obs, 0, sizeof(*obs));
+    obs->cfg = *cfg;
+    observer_discretize(obs);
+    observer_reset(obs, v0);
+    ESP_LOGI(TAG, "Observer initialized: L=%.1fuH C=%.1fuF r=%.3fohm T=%.0fus",
+             cfg->l_h * 1e6f, cfg->c_f * 1e6f, cfg->r_ohm, cfg->period_s * 1e6f);
+    return ESP_OK;
+}
+
+void observer_predict(observer_t *obs, int64_t now_us, float drive_v, float i_out_a)
+{
+    if (!obs) return;
+    if (obs->reset_request) {
+        obs->reset_request = false;
+        observer_reset(obs, observer_voltage(obs));
+    }
+    observer_slot_t *cur = observer_slot(obs, obs->head);
+    cur->t_us = now_us;
+    cur->drive_v = drive_v;
+    cur->i_out_a = i_out_a;
+    observer_slot_t *next = observer_slot(obs, obs->head + 1);
+    observer_propagate(obs, cur, next);
+    next->t_us = now_us + (int64_t)(obs->cfg.period_s * 1e6f);
+    // 新周期的输入在下一次预测时才知道，先沿用本周期的值，供在此之前到达的样本重新预测
+    next->drive_v = drive_v;
+    next->i_out_a = i_out_a;
+    obs->head++;
+    if (obs->filled < OBSERVER_HISTORY) obs->filled++;
+    obs->stats.predictions++;
+}
+
+bool observer_update(observer_t *obs, int64_t sample_us, float v)
+{
+    if (!obs) return false;
+    // 找到采样时刻所在的周期，晚于当前周期起点的样本按当前周期处理
+    uint32_t back = 0;
+    while (back < obs->filled && observer_slot(obs, obs->head - back)->t_us > sample_us) back++;
+    if (back >= obs->filled) {
+        obs->stats.late++;
+        return false;
+    }
+    int64_t delay = observer_slot(obs, obs->head)->t_us - sample_us;
+    obs->stats.last_delay_us = delay > 0 ? (uint32_t)delay : 0;
+
+    // 量测取该周期内输出电压的平均：z = h·x + d·u，LC 振荡与开关纹波在平均中基本抵消
+    observer_slot_t *slot = observer_slot(obs, obs->head - back);
+    float ph[OBSERVER_STATES];
+    float s = obs->cfg.r_v;
+    for (int i = 0; i < OBSERVER_STATES; ++i) {
+        ph[i] = 0.0f;
+        for (int n = 0; n < OBSERVER_STATES; ++n) ph[i] += slot->p[i][n] * obs->h_avg[n];
+        s += obs->h_avg[i] * ph[i];
+    }
+    float innovation = v - observer_slot_average(obs, slot);
+    float nis = innovation * innovation / s;
+    if (nis > OBSERVER_GATE) {
+        obs->stats.rejected++;
+        if (++obs->consecutive_rejects >= OBSERVER_REJECT_MAX) {
+            // 连续偏离说明模型与实际已经失配（负载突变、参数错误），放弃历史从量测值重新开始
+            observer_reset(obs, v);
+            obs->stats.resets++;
+        }
+        return false;
+    }
+    obs->consecutive_rejects = 0;
+
+    // K = P·hᵀ / S，P = P - K·(h·P)，P 对称故 h·P = (P·hᵀ)ᵀ
+    for (int i = 0; i < OBSERVER_STATES; ++i) {
+        float k = ph[i] / s;
+        slot->x[i] += k * innovation;
+        for (int j = 0; j < OBSERVER_STATES; ++j) slot->p[i][j] -= k * ph[j];
+    }
+
+    // 用记录的输入重新预测到当前周期
+    for (uint32_t n = back; n > 0; --n) {
+        observer_slot_t *to = observer_slot(obs, obs->head - n + 1);
+        observer_propagate(obs, observer_slot(obs, obs->head - n), to);
+    }
+
+    observer_stats_t *st = &obs->stats;
+    st->updates++;
+    st->innovation_mean += OBSERVER_STATS_ALPHA * (innovation - st->innovation_mean);
+    float ms = st->innovation_rms * st->innovation_rms;
+    ms += OBSERVER_STATS_ALPHA * (innovation * innovation - ms);
+    st->innovation_rms = sqrtf(ms);
+    st->nis += OBSERVER_STATS_ALPHA * (nis - st->nis);
+    return true;
+}
+
+float observer_voltage(const observer_t *obs)
+{
+    if (!obs) return 0.0f;
+    if (obs->filled < 2) return obs->history[obs->head & (OBSERVER_HISTORY - 1)].x[0];
+    return observer_slot_average(obs, &obs->history[(obs->head - 1) & (OBSERVER_HISTORY - 1)]);
+}
+
+float observer_inductor_current(const observer_t *obs)
+{
+    return obs ? obs->history[obs->head & (OBSERVER_HISTORY - 1)].x[1] : 0.0f;
+}
+
+float observer_bias(const observer_t *obs)
+{
+    return obs ? obs->history[obs->head & (OBSERVER_HISTORY - 1)].x[2] : 0.0f;
+}
+
+void observer_get_stats(const observer_t *obs, observer_stats_t *stats)
+{
+    if (obs && stats) *stats = obs->stats;
+}
+
+// obs：估计值与新息统计；obs reset：在控制任务的下一次预测时重新初始化
+static void cmd_observer(const char *args, char *reply, size_t reply_size)
+{
+    observer_t *obs = s_cmd_obs;
+    while (*args == ' ') args++;
+    if (strncmp(args, "reset", 5) == 0) {
+        obs->reset_request = true;
+        snprintf(reply, reply_size, "OK");
+        return;
+    }
+    observer_stats_t st;
+    observer_get_stats(obs, &st);
+    snprintf(reply, reply_size,
+             "v=%.4f il=%.4f bias=%.4f pred=%" PRIu32 " upd=%" PRIu32 " rej=%" PRIu32 " late=%" PRIu32 " reset=%" PRIu32 " "
+             "innov_mean=%.2fmV innov_rms=%.2fmV nis=%.2f delay=%" PRIu32 "us",
+             observer_voltage(obs), observer_inductor_current(obs), observer_bias(obs),
+             st.predictions, st.updates, st.rejected, st.late, st.resets,
+             st.innovation_mean * 1000.0f, st.innovation_rms * 1000.0f, st.nis, st.last_delay_us);
+}
+
+void observer_register_commands(observer_t *obs)
+{
+    if (!obs) return;
+    s_cmd_obs = obs;
+    cmd_register_command("obs", cmd_observer);
+    // 噪声参数只影响协方差，可以在线调整；L、C、r 需要重新离散化，只在初始化时给出
+    cmd_register_param(&(cmd_param_t){ .name = "obs_qv", .type = CMD_PARAM_FLOAT, .min = 0.0f, .max = 1.0f, .value = &obs->cfg.q_v });
+    cmd_register_param(&(cmd_param_t){ .name = "obs_qi", .type = CMD_PARAM_FLOAT, .min = 0.0f, .max = 1.0f, .value = &obs->cfg.q_i });
+    cmd_register_param(&(cmd_param_t){ .name = "obs_qb", .type = CMD_PARAM_FLOAT, .min = 0.0f, .max = 1.0f, .value = &obs->cfg.q_b });
+    cmd_register_param(&(cmd_param_t){ .name = "obs_rv", .type = CMD_PARAM_FLOAT, .min = 1e-9f, .max = 1.0f, .value = &obs->cfg.r_v });
+}
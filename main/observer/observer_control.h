@@ -0,0 +1,84 @@
+// 状态观测器模块头文件：在稀疏、带延迟的 INA226 样本之间预测输出电压
+// 被控对象取同步 Buck 的平均值模型：L·diL/dt = D·Vin - b - v - r·iL，C·dv/dt = iL - iout
+// 状态为 [输出电压 v, 电感电流 iL, 驱动偏差 b]，b 吸收死区、导通压降与输入电压误差，按随机游走建模
+// 每个控制周期用已施加的驱动电压 D·Vin 与最近的输出电流做一次预测；INA226 出新样本时按样本的采样时刻
+// 回到历史中对应的周期做卡尔曼更新，再用记录的输入重新预测到当前周期，量测延迟不会反映到估计值上
+// INA226 给出的是转换窗口内的平均，LC 谐振通常高于控制频率，因此量测与输出都取一个控制周期内的平均电压，
+// 而不是周期起点的瞬时值，控制器不会对采样频率以上的振荡作出反应
+
+#pragma once
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "cmd/cmd_registry.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define OBSERVER_STATES          3
+#define OBSERVER_HISTORY         32      // 保留的周期数，必须为 2 的幂；采样时刻早于该窗口的样本丢弃
+#define OBSERVER_GATE            25.0f   // 归一化新息平方的门限（5σ），超过视为野值
+#define OBSERVER_REJECT_MAX      3       // 连续拒绝该次数后认为模型失配，以量测值重新初始化
+#define OBSERVER_STATS_ALPHA     (1.0f / 64.0f)   // 新息统计的指数平均系数
+
+typedef struct {
+    float l_h;               // 电感 (H)
+    float c_f;               // 输出电容 (F)
+    float r_ohm;             // 电感支路等效电阻 (Ω)
+    float period_s;          // 预测步长，等于控制周期
+    float q_v;               // 每步过程噪声方差：电压 (V²)、电流 (A²)、驱动偏差 (V²)
+    float q_i;
+    float q_b;
+    float r_v;               // 电压量测噪声方差 (V²)
+} observer_config_t;
+
+typedef struct {
+    int64_t t_us;            // 该周期起点
+    float x[OBSERVER_STATES];
+    float p[OBSERVER_STATES][OBSERVER_STATES];
+    float drive_v;           // 该周期内施加的 D·Vin
+    float i_out_a;           // 该周期内使用的输出电流
+} observer_slot_t;
+
+typedef struct {
+    uint32_t predictions;
+    uint32_t updates;
+    uint32_t rejected;       // 新息超过门限
+    uint32_t late;           // 采样时刻早于历史窗口
+    uint32_t resets;         // 连续拒绝后重新初始化
+    float innovation_mean;   // 新息的指数平均 (V)，长期偏离 0 说明模型有偏差
+    float innovation_rms;    // (V)
+    float nis;               // 归一化新息平方的指数平均，噪声参数合适时约为 1
+    uint32_t last_delay_us;  // 最近一个样本从采样时刻到融合的延迟
+} observer_stats_t;
+
+typedef struct {
+    observer_config_t cfg;
+    float phi[OBSERVER_STATES][OBSERVER_STATES];   // 离散化后的状态转移矩阵
+    float gamma[OBSERVER_STATES][2];               // 输入矩阵，输入为 [D·Vin, iout]
+    float h_avg[OBSERVER_STATES];                  // 周期平均电压 = h_avg·x + d_avg·u
+    float d_avg[2];
+    observer_slot_t history[OBSERVER_HISTORY];
+    uint32_t head;           // 当前周期所在的槽位序号（单调递增，取模得到下标）
+    uint32_t filled;         // 有效的历史周期数
+    uint8_t consecutive_rejects;
+    volatile bool reset_request;   // 由命令任务置位，控制任务在下一次预测时处理
+    observer_stats_t stats;
+} observer_t;
+
+// 离散化模型并把初始状态设为 v0；参数无效时返回 ESP_ERR_INVALID_ARG
+esp_err_t observer_init(observer_t *obs, const observer_config_t *cfg, float v0);
+void observer_reset(observer_t *obs, float v0);
+
+// 每个控制周期调用一次：now_us 为本周期起点，drive_v 为本周期施加的 D·Vin，i_out_a 为最近测得的输出电流
+void observer_predict(observer_t *obs, int64_t now_us, float drive_v, float i_out_a);
+// 融合一个电压样本，sample_us 为样本对应的采样时刻；被门限拒绝或过旧时返回 false
+bool observer_update(observer_t *obs, int64_t sample_us, float v);
+
+// 上一个控制周期内输出电压的平均估计，供控制器使用
+float observer_voltage(const observer_t *obs);
+float observer_inductor_current(const observer_t *obs);
+float observer_bias(const observer_t *obs);
+void observer_get_stats(const observer_t *obs, observer_stats_t *stats);
+
+// 注册 "obs" 命令：输出估计值与新息统计；obs reset 以最近的估计重新初始化协方差
+void observer_register_commands(observer_t *obs);
@@ -18,6 +18,35 @@ void pid_init(pid_handle_t *pid, float setpoint, float *input_ptr, float *output
 	pid->output_ptr = output_ptr;
 	pid->setpoint = setpoint;
 	pid->period_s = PERIOD_US / 1000000.0f;
+	pid->ff_topology = PID_FF_NONE;
+	pid->ff_applied = PID_FF_NONE;
+	pid->vin_ptr = NULL;
+	pid->feedforward = 0.0f;
+	pid->ff_gain = 0.0f;
+	pid->ff_bias = 0.0f;
+	pid->active = false;
+}
+
+void pid_set_feedforward(pid_handle_t *pid, pid_ff_topology_t topology, float *vin_ptr)
+{
+	if (!pid) return;
+	pid->vin_ptr = vin_ptr;
+	pid->ff_topology = topology;
+}
+
+float pid_feedforward_duty(pid_ff_topology_t topology, float vin, float vref)
+{
+	if (vin < PID_FF_VIN_MIN || vref <= 0.0f) return 0.0f;
+	float d;
+	switch (topology) {
+		case PID_FF_BUCK:       d = vref / vin; break;
+		case PID_FF_BOOST:      d = 1.0f - vin / vref; break;
+		case PID_FF_BUCK_BOOST: d = vref / (vin + vref); break;
+		default: return 0.0f;
+	}
+	if (d < 0.0f) d = 0.0f;
+	if (d > 1.0f) d = 1.0f;
+	return d * 100.0f;
 }
 
 #ifndef EPSILON
@@ -35,6 +64,33 @@ void pid_timer_isr(pid_handle_t *pid)
 	if (output < pid->input_min) output = pid->input_min;
 	if (output > pid->input_max) output = pid->input_max;
 
+	// 前馈这一块：输入电压与目标值的变化直接反映到占空比，积分项只需补偿损耗等模型误差
+	float feedforward = pid->vin_ptr ? pid_feedforward_duty(pid->ff_topology, *(pid->vin_ptr), pid->setpoint) : 0.0f;
+	// 复位后前馈渐入，与积分项一起从低占空比爬升
+	if (pid->ff_gain < 1.0f) {
+		pid->ff_gain += pid->period_s / PID_FF_RAMP_S;
+		if (pid->ff_gain > 1.0f) pid->ff_gain = 1.0f;
+	}
+	feedforward *= pid->ff_gain;
+	if (pid->ff_topology != pid->ff_applied) {
+		// 运行中切换拓扑：无扰切换，前馈的跳变（连同之前的余量）折算进积分项，输出保持不变；
+		// ki 为 0 或超出积分限幅而吸收不了的部分留在 ff_bias 中，一直保持到下一次切换或复位
+		if (pid->active) {
+			float step = pid->feedforward - feedforward + pid->ff_bias;
+			if (pid->ki > 0.0f) {
+				float integral = pid->integral + step / pid->ki;
+				float clamped = integral;
+				if (clamped < INTEGRAL_MIN) clamped = INTEGRAL_MIN;
+				if (clamped > INTEGRAL_MAX) clamped = INTEGRAL_MAX;
+				pid->integral = clamped;
+				step = (integral - clamped) * pid->ki;
+			}
+			pid->ff_bias = step;
+		}
+		pid->ff_applied = pid->ff_topology;
+	}
+	pid->feedforward = feedforward;
+
     // 积分这一块
 	float error = pid->setpoint - output;
 	pid->integral += error * pid->period_s;
@@ -44,7 +100,8 @@ void pid_timer_isr(pid_handle_t *pid)
 	// 微分这一块
 	float derivative = (error - pid->last_error) / pid->period_s;
 	pid->last_error = error;
-	float input = pid->kp * error + pid->ki * pid->integral + pid->kd * derivative;
+	float input = feedforward + pid->ff_bias + pid->kp * error + pid->ki * pid->integral + pid->kd * derivative;
+	pid->active = true;
 
 	// 输入限幅
 	if (input < pid->input_min) input = pid->input_min;
@@ -84,6 +141,9 @@ void pid_reset(pid_handle_t *pid)
     if (!pid) return;
     pid->integral = 0.0f;
     pid->last_error = 0.0f;
+    pid->ff_gain = 0.0f;
+    pid->ff_bias = 0.0f;
+    pid->active = false;
 }
 
 void pid_set_kp(pid_handle_t *pid, float kp)
@@ -102,4 +162,28 @@ void pid_set_kd(pid_handle_t *pid, float kd)
 {
     if (!pid) return;
     pid->kd = kd;
+}
+
+static float pid_ff_get(void *ctx)
+{
+    return (float)((pid_handle_t *)ctx)->ff_topology;
+}
+
+static esp_err_t pid_ff_set(void *ctx, float value)
+{
+    ((pid_handle_t *)ctx)->ff_topology = (pid_ff_topology_t)(int)value;
+    return ESP_OK;
+}
+
+void pid_register_params(pid_handle_t *pid)
+{
+    if (!pid) return;
+    cmd_register_param(&(cmd_param_t){ .name = "kp", .type = CMD_PARAM_FLOAT, .min = 0.0f, .max = 100.0f, .value = &pid->kp });
+    cmd_register_param(&(cmd_param_t){ .name = "ki", .type = CMD_PARAM_FLOAT, .min = 0.0f, .max = 100.0f, .value = &pid->ki });
+    cmd_register_param(&(cmd_param_t){ .name = "kd", .type = CMD_PARAM_FLOAT, .min = 0.0f, .max = 100.0f, .value = &pid->kd });
+    cmd_register_param(&(cmd_param_t){ .name = "duty_min", .type = CMD_PARAM_FLOAT, .min = 0.0f, .max = 100.0f, .value = &pid->input_min });
+    cmd_register_param(&(cmd_param_t){ .name = "duty_max", .type = CMD_PARAM_FLOAT, .min = 0.0f, .max = 100.0f, .value = &pid->input_max });
+    // 0 关闭 / 1 buck / 2 boost / 3 buck-boost
+    cmd_register_param(&(cmd_param_t){ .name = "ff", .type = CMD_PARAM_INT, .min = PID_FF_NONE, .max = PID_FF_BUCK_BOOST,
+                                       .getter = pid_ff_get, .setter = pid_ff_set, .ctx = pid });
 }
\ No newline at end of file
@@ -2,6 +2,8 @@
 
 #include "esp_timer.h"
 #include <stddef.h>
+#include <stdbool.h>
+#include "cmd/cmd_registry.h"
 
 // 默认PID参数宏
 #define PID_KP  0.4f
@@ -18,6 +20,19 @@
 
 #define PERIOD_US         1000
 
+// 前馈：输入电压低于该值时认为测量无效，不加前馈
+#define PID_FF_VIN_MIN    1.0f
+// 复位后前馈从 0 线性加到全值所用的时间，避免刹车恢复或重新启动时占空比一步跳到稳态值
+#define PID_FF_RAMP_S     0.05f
+
+// 前馈使用的变换器拓扑，按理想变换比由输入电压与目标值算出稳态占空比
+typedef enum {
+	PID_FF_NONE,
+	PID_FF_BUCK,          // D = Vref / Vin
+	PID_FF_BOOST,         // D = 1 - Vin / Vref
+	PID_FF_BUCK_BOOST,    // D = Vref / (Vin + Vref)，Vref 取输出电压幅值
+} pid_ff_topology_t;
+
 typedef struct {
 	float kp;
 	float ki;
@@ -30,6 +45,13 @@ typedef struct {
 	float *input_ptr;
 	float *output_ptr;
 	float period_s;
+	pid_ff_topology_t ff_topology;
+	float *vin_ptr;       // 输入电压，NULL 时不加前馈
+	float feedforward;    // 最近一次实际加上的前馈占空比 (%)，已乘 ff_gain
+	float ff_gain;        // 前馈渐入系数，复位后从 0 升到 1
+	float ff_bias;        // 拓扑切换时积分项吸收不了的前馈跳变 (%)（ki 为 0 或超出积分限幅），不衰减
+	pid_ff_topology_t ff_applied;
+	bool active;          // 复位后已输出过，前馈切换时需要无扰
 } pid_handle_t;
 
 // 初始化 PID，setpoint 为目标值，input_ptr / output_ptr 为输入输出指针
@@ -38,15 +60,24 @@ void pid_init(pid_handle_t *pid, float setpoint, float *input_ptr, float *output
 // 启动定时器服务，自动以 PERIOD_US 频率调用 pid_timer_isr
 void pid_timer_service_init(pid_handle_t *pid);
 
+// 设置前馈拓扑与输入电压来源；运行中切换时由定时器中断把前馈的跳变折算进积分项（余量记入 ff_bias），输出不跳变
+void pid_set_feedforward(pid_handle_t *pid, pid_ff_topology_t topology, float *vin_ptr);
+
+// 理想变换比对应的占空比 (%)，输入电压无效或拓扑为 PID_FF_NONE 时返回 0
+float pid_feedforward_duty(pid_ff_topology_t topology, float vin, float vref);
+
 // 定时器中断服务函数
 void pid_timer_isr(pid_handle_t *pid);
 
 void change_pid_setpoint(pid_handle_t *pid, float new_setpoint);
 
-// 重置PID状态（清空积分和上次误差）
+// 重置PID状态（清空积分、上次误差与补偿量），之后前馈在 PID_FF_RAMP_S 内从 0 逐渐加入
 void pid_reset(pid_handle_t *pid);
 
 // 修改PID参数
 void pid_set_kp(pid_handle_t *pid, float kp);
 void pid_set_ki(pid_handle_t *pid, float ki);
-void pid_set_kd(pid_handle_t *pid, float kd);
\ No newline at end of file
+void pid_set_kd(pid_handle_t *pid, float kd);
+
+// 向命令注册表注册 kp/ki/kd、输出上下限及前馈拓扑 ff，可通过 "set kp=0.5" 等命令在线调整
+void pid_register_params(pid_handle_t *pid);
\ No newline at end of file
@@ -0,0 +1,290 @@
+#include "protect_control.h"
+#include "i2c_ina226_driver/i2c_ina226_driver.h"
+#include "trace/trace_control.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "PROTECT";
+
+static protect_config_t s_cfg;
+static TaskHandle_t s_protect_task = NULL;
+static volatile protect_state_t s_state = PROTECT_STATE_OK;
+static protect_status_t s_status;
+// 故障中断、控制任务、命令与后台任务都会改状态，先判断再切换必须在同一临界区内完成
+static portMUX_TYPE s_state_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// 跳闸方（故障中断或控制任务）与后台任务之间只传递一个待处理事件，处理前的后续跳闸只计数
+static portMUX_TYPE s_pending_lock = portMUX_INITIALIZER_UNLOCKED;
+static bool s_pending = false;
+static protect_event_t s_pending_event;
+
+// 以下只由后台任务修改
+static protect_event_t s_events[PROTECT_EVENTS_MAX];
+static uint32_t s_event_count = 0;
+static int64_t s_trip_us = 0;
+static int64_t s_last_recover_us = 0;
+static volatile bool s_clear_request = false;
+
+static const char *const s_source_names[] = { "ina_alert", "comparator", "soft_oc", "soft_ov", "manual" };
+
+static void IRAM_ATTR protect_post(protect_source_t source, float value)
+{
+    portENTER_CRITICAL_SAFE(&s_pending_lock);
+    if (s_pending) {
+        s_status.events_lost++;
+    } else {
+        s_pending = true;
+        s_pending_event.timestamp_us = esp_timer_get_time();
+        s_pending_event.source = source;
+        s_pending_event.value = value;
+    }
+    portEXIT_CRITICAL_SAFE(&s_pending_lock);
+}
+
+// 只有当前状态为 from 时才切换到 to，返回是否切换成功
+static bool IRAM_ATTR protect_transition(protect_state_t from, protect_state_t to)
+{
+    portENTER_CRITICAL_SAFE(&s_state_lock);
+    bool ok = s_state == from;
+    if (ok) s_state = to;
+    portEXIT_CRITICAL_SAFE(&s_state_lock);
+    return ok;
+}
+
+// GPIO 故障中断：硬件已经关断输出，这里只记录并唤醒后台任务；
+// 已处于跳闸状态时是同一次故障被另一条通路（如软件过流）先行捕获，不再重复记录
+static bool IRAM_ATTR protect_on_fault(int source, void *arg)
+{
+    if (!protect_transition(PROTECT_STATE_OK, PROTECT_STATE_TRIPPED)) return false;
+    TRACE_INSTANT(FAULT, source);
+    protect_post(source == 0 ? PROTECT_SRC_INA226_ALERT : PROTECT_SRC_COMPARATOR, 0.0f);
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(s_protect_task, &woken);
+    return woken == pdTRUE;
+}
+
+static void protect_trip(protect_source_t source, float value)
+{
+    if (!protect_transition(PROTECT_STATE_OK, PROTECT_STATE_TRIPPED)) return;
+    pwm_fault_trigger(s_cfg.pwm);
+    TRACE_INSTANT(FAULT, source);
+    protect_post(source, value);
+    xTaskNotifyGive(s_protect_task);
+}
+
+void protect_check(float bus_voltage_v, float current_a)
+{
+    if (!s_protect_task || s_state != PROTECT_STATE_OK) return;
+    if (current_a > s_cfg.oc_limit_a) {
+        protect_trip(PROTECT_SRC_SOFT_OC, current_a);
+    } else if (bus_voltage_v > s_cfg.ov_limit_v) {
+        protect_trip(PROTECT_SRC_SOFT_OV, bus_voltage_v);
+    }
+}
+
+bool protect_tripped(void)
+{
+    return s_state != PROTECT_STATE_OK;
+}
+
+// 取出待处理事件写入记录；INA226 的锁存报警在这里读取清除，ALERT 撤销后才能解除刹车
+static void protect_collect(void)
+{
+    protect_event_t ev;
+    bool pending;
+    portENTER_CRITICAL(&s_pending_lock);
+    pending = s_pending;
+    ev = s_pending_event;
+    s_pending = false;
+    portEXIT_CRITICAL(&s_pending_lock);
+    if (!pending) return;
+
+    ev.ina_flags = 0;
+    if (s_cfg.alert_gpio != GPIO_NUM_NC) ina226_read_alert(&ev.ina_flags);
+    if (s_last_recover_us == 0 || ev.timestamp_us - s_last_recover_us > (int64_t)PROTECT_RETRY_WINDOW_MS * 1000) {
+        s_status.retries = 0;
+    }
+    ev.retry = s_status.retries;
+    s_events[s_event_count & (PROTECT_EVENTS_MAX - 1)] = ev;
+    s_event_count++;
+    s_status.trips++;
+    s_trip_us = ev.timestamp_us;
+    ESP_LOGW(TAG, "Trip: %s value=%.3f ina=0x%04X retry=%u/%u", s_source_names[ev.source], ev.value,
+             ev.ina_flags, ev.retry, s_cfg.retry_max);
+}
+
+// automatic 为 false 表示手动清除，不计入连续重试次数
+static void protect_try_recover(bool automatic)
+{
+    esp_err_t ret = pwm_fault_recover(s_cfg.pwm);
+    if (ret != ESP_OK) {
+        // 故障信号仍有效（短路未消除），保持关断，下一个周期再试
+        s_status.recover_failures++;
+        return;
+    }
+    if (!protect_transition(PROTECT_STATE_TRIPPED, PROTECT_STATE_OK)) return;
+    s_last_recover_us = esp_timer_get_time();
+    s_status.recoveries++;
+    if (automatic) s_status.retries++;
+    ESP_LOGI(TAG, "Recovered (retry %u/%u)", s_status.retries, s_cfg.retry_max);
+}
+
+static void protect_task(void *arg)
+{
+    while (1) {
+        TickType_t wait = s_state == PROTECT_STATE_TRIPPED ? pdMS_TO_TICKS(s_cfg.retry_delay_ms) : portMAX_DELAY;
+        ulTaskNotifyTake(pdTRUE, wait);
+        protect_collect();
+
+        if (s_clear_request) {
+            s_clear_request = false;
+            s_status.retries = 0;
+            protect_transition(PROTECT_STATE_LOCKOUT, PROTECT_STATE_TRIPPED);
+            if (s_state != PROTECT_STATE_TRIPPED) continue;
+            protect_try_recover(false);
+            continue;
+        }
+        if (s_state != PROTECT_STATE_TRIPPED) continue;
+        if (esp_timer_get_time() - s_trip_us < (int64_t)s_cfg.retry_delay_ms * 1000) continue;
+        if (s_status.retries >= s_cfg.retry_max) {
+            protect_transition(PROTECT_STATE_TRIPPED, PROTECT_STATE_LOCKOUT);
+            ESP_LOGE(TAG, "Lockout after %u retries, use \"prot clear\"", s_status.retries);
+            continue;
+        }
+        protect_try_recover(true);
+    }
+}
+
+esp_err_t protect_init(const protect_config_t *cfg)
+{
+    if (!cfg || !cfg->pwm || cfg->oc_limit_a <= 0.0f || cfg->ov_limit_v <= 0.0f) return ESP_ERR_INVALID_ARG;
+    if (s_protect_task) return ESP_ERR_INVALID_STATE;
+    s_cfg = *cfg;
+    // 电流寄存器在 MAX_CURRENT_A 处饱和，更高的阈值软件通路永远比较不到
+    if (s_cfg.oc_limit_a > MAX_CURRENT_A) {
+        ESP_LOGW(TAG, "Over-current limit %.3fA above measurable range, using %.4fA", s_cfg.oc_limit_a, MAX_CURRENT_A);
+        s_cfg.oc_limit_a = MAX_CURRENT_A;
+    }
+    memset(&s_status, 0, sizeof(s_status));
+    s_state = PROTECT_STATE_OK;
+
+    if (s_cfg.alert_gpio != GPIO_NUM_NC) {
+        // 锁存模式：ALERT 一直保持到后台任务读取标志，刹车不会在事件记录之前被解除
+        esp_err_t ret = ina226_set_overcurrent_alert(s_cfg.oc_limit_a, true);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to configure INA226 alert: %s", esp_err_to_name(ret));
+            return ret;
+        }
+        // ALERT 在一次转换结束时才比较，关断延迟最长约为一个转换周期，而不是比较器的微秒级
+        ESP_LOGI(TAG, "INA226 alert latency up to %" PRIu32 "us (one conversion cycle)",
+                 ina226_conversion_period_us(ina226_get_config()));
+    }
+
+    // 任务先于故障中断创建，中断回调总能拿到有效的任务句柄
+    xTaskCreatePinnedToCore(protect_task, "protect", PROTECT_TASK_STACK_SIZE, NULL, PROTECT_TASK_PRIORITY, &s_protect_task, APP_CORE_UI);
+    pwm_fault_config_t fault_cfg = {
+        .gpios = { s_cfg.alert_gpio, s_cfg.comparator_gpio },
+        .active_high = { false, s_cfg.comparator_active_high },
+        .cb = protect_on_fault,
+    };
+    esp_err_t ret = pwm_fault_init(s_cfg.pwm, s_cfg.pwm_conj, &fault_cfg);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to enable PWM fault brake: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    ESP_LOGI(TAG, "Protection armed: oc=%.2fA ov=%.2fV retry=%u x %" PRIu32 "ms", s_cfg.oc_limit_a, s_cfg.ov_limit_v,
+             s_cfg.retry_max, s_cfg.retry_delay_ms);
+    return ESP_OK;
+}
+
+void protect_get_status(protect_status_t *status)
+{
+    if (!status) return;
+    *status = s_status;
+    status->state = s_state;
+}
+
+bool protect_get_event(int index, protect_event_t *event)
+{
+    uint32_t count = s_event_count;
+    uint32_t oldest = count > PROTECT_EVENTS_MAX ? count - PROTECT_EVENTS_MAX : 0;
+    if (index < 0 || oldest + index >= count || !event) return false;
+    *event = s_events[(oldest + index) & (PROTECT_EVENTS_MAX - 1)];
+    return true;
+}
+
+// prot：无参数输出状态；log [页] 分页输出事件记录（最新的在前）；clear 清除锁定并尝试恢复；trip 手动跳闸
+static void cmd_protect(const char *args, char *reply, size_t reply_size)
+{
+    if (!s_protect_task) {
+        snprintf(reply, reply_size, "ERR protection not initialized");
+        return;
+    }
+    while (*args == ' ') args++;
+    if (strncmp(args, "clear", 5) == 0) {
+        s_clear_request = true;
+        xTaskNotifyGive(s_protect_task);
+        snprintf(reply, reply_size, "OK");
+    } else if (strncmp(args, "trip", 4) == 0) {
+        protect_trip(PROTECT_SRC_MANUAL, 0.0f);
+        snprintf(reply, reply_size, "OK");
+    } else if (strncmp(args, "log", 3) == 0) {
+        // 先取快照，分页时后台任务追加的新事件不会让各页错位
+        protect_event_t events[PROTECT_EVENTS_MAX];
+        int count = 0;
+        while (count < PROTECT_EVENTS_MAX && protect_get_event(count, &events[count])) count++;
+        if (count == 0) {
+            snprintf(reply, reply_size, "no events");
+            return;
+        }
+        int pages = (count + PROTECT_LOG_PAGE_EVENTS - 1) / PROTECT_LOG_PAGE_EVENTS;
+        int page = atoi(args + 3);
+        if (page < 1) page = 1;
+        if (page > pages) {
+            snprintf(reply, reply_size, "ERR page %d of %d", page, pages);
+            return;
+        }
+        int len = snprintf(reply, reply_size, "page %d/%d", page, pages);
+        int first = count - 1 - (page - 1) * PROTECT_LOG_PAGE_EVENTS;
+        for (int i = first; i >= 0 && i > first - PROTECT_LOG_PAGE_EVENTS && (size_t)len < reply_size; --i) {
+            const protect_event_t *ev = &events[i];
+            len += snprintf(reply + len, reply_size - len, "\r\nt=%" PRId64 "us src=%s value=%.3f ina=0x%04X retry=%u",
+                            ev->timestamp_us, s_source_names[ev->source], ev->value, ev->ina_flags, ev->retry);
+        }
+    } else {
+        static const char *const state_names[] = { "ok", "tripped", "lockout" };
+        protect_status_t st;
+        protect_get_status(&st);
+        snprintf(reply, reply_size, "state=%s trips=%" PRIu32 " recovered=%" PRIu32 " recover_fail=%" PRIu32 " retries=%u/%u lost=%" PRIu32 " oc=%.2fA ov=%.2fV",
+                 state_names[st.state], st.trips, st.recoveries, st.recover_failures, st.retries, s_cfg.retry_max,
+                 st.events_lost, s_cfg.oc_limit_a, s_cfg.ov_limit_v);
+    }
+}
+
+static float protect_oc_get(void *ctx) { return s_cfg.oc_limit_a; }
+
+static esp_err_t protect_oc_set(void *ctx, float value)
+{
+    if (s_cfg.alert_gpio != GPIO_NUM_NC) {
+        esp_err_t ret = ina226_set_overcurrent_alert(value, true);
+        if (ret != ESP_OK) return ret;
+    }
+    s_cfg.oc_limit_a = value;
+    return ESP_OK;
+}
+
+static float protect_ov_get(void *ctx) { return s_cfg.ov_limit_v; }
+static esp_err_t protect_ov_set(void *ctx, float value) { s_cfg.ov_limit_v = value; return ESP_OK; }
+
+void protect_register_commands(void)
+{
+    cmd_register_command("prot", cmd_protect);
+    cmd_register_param(&(cmd_param_t){ .name = "prot_oc", .type = CMD_PARAM_FLOAT, .min = 0.1f, .max = MAX_CURRENT_A,
+                                       .getter = protect_oc_get, .setter = protect_oc_set });
+    cmd_register_param(&(cmd_param_t){ .name = "prot_ov", .type = CMD_PARAM_FLOAT, .min = 1.0f, .max = 60.0f,
+                                       .getter = protect_ov_get, .setter = protect_ov_set });
+}
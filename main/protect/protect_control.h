@@ -0,0 +1,81 @@
+// 保护模块头文件：过流/过压快速关断
+// 硬件通路：INA226 ALERT（分流电压超限，锁存）与外部比较器接到 MCPWM 故障输入，触发后由硬件刹车关断两路输出，
+// 不依赖控制环与 I2C 读数；软件通路：控制环每周期比较测量值，超限时经 MCPWM 软件故障走同一条刹车通路
+// 延迟：INA226 只在每次转换结束时比较阈值，ALERT 最迟在一个转换周期后才拉低（默认配置约 2.2 ms）；
+// 需要微秒级关断时接外部比较器，软件通路的延迟为一个控制周期加一次 I2C 读取
+// 故障状态锁存，由后台任务记录事件并按重试策略恢复，连续重试失败后进入锁定，只能手动清除
+
+#pragma once
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "pwm/pwm_control.h"
+#include "cmd/cmd_registry.h"
+#include "global_params.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define PROTECT_EVENTS_MAX         16        // 事件记录条数，必须为 2 的幂
+#define PROTECT_LOG_PAGE_EVENTS    5         // "prot log" 每页条数，一条约 80 字节，一页须装进 CMD_REPLY_SIZE
+#define PROTECT_RETRY_WINDOW_MS    10000     // 恢复后这段时间内再次跳闸计为连续重试
+#define PROTECT_TASK_STACK_SIZE    3072
+#define PROTECT_TASK_PRIORITY      (configMAX_PRIORITIES - 4)
+
+typedef enum {
+    PROTECT_SRC_INA226_ALERT,    // INA226 ALERT 引脚（硬件过流）
+    PROTECT_SRC_COMPARATOR,      // 外部比较器（硬件过压或过流）
+    PROTECT_SRC_SOFT_OC,         // 控制环软件过流
+    PROTECT_SRC_SOFT_OV,         // 控制环软件过压
+    PROTECT_SRC_MANUAL,          // "prot trip" 命令
+} protect_source_t;
+
+typedef enum {
+    PROTECT_STATE_OK,
+    PROTECT_STATE_TRIPPED,       // 输出已关断，等待自动恢复
+    PROTECT_STATE_LOCKOUT,       // 重试次数用尽，等待 "prot clear"
+} protect_state_t;
+
+typedef struct {
+    pwm_instance_t *pwm;             // 刹车作用的主实例，故障接在其 operator 上
+    pwm_instance_t *pwm_conj;        // 互补输出，可为 NULL
+    gpio_num_t alert_gpio;           // INA226 ALERT，低有效开漏；GPIO_NUM_NC 不使用
+    gpio_num_t comparator_gpio;      // 外部比较器输出；GPIO_NUM_NC 不使用
+    bool comparator_active_high;
+    float oc_limit_a;                // 过流阈值，同时写入 INA226 报警阈值
+    float ov_limit_v;                // 软件过压阈值
+    uint8_t retry_max;               // 连续自动恢复次数上限，0 表示不自动恢复
+    uint32_t retry_delay_ms;         // 跳闸后等待多久尝试恢复
+} protect_config_t;
+
+typedef struct {
+    int64_t timestamp_us;            // 跳闸时刻（esp_timer 时基）
+    uint8_t source;                  // protect_source_t
+    uint8_t retry;                   // 本次跳闸前的连续重试次数
+    uint16_t ina_flags;              // INA226 Mask/Enable 寄存器，仅 ALERT 触发时有效
+    float value;                     // 软件通路的测量值（A 或 V），硬件通路为 0
+} protect_event_t;
+
+typedef struct {
+    protect_state_t state;
+    uint32_t trips;
+    uint32_t recoveries;
+    uint32_t recover_failures;       // 尝试恢复时故障信号仍然有效的次数
+    uint8_t retries;                 // 当前连续重试次数
+    uint32_t events_lost;            // 上一事件尚未处理时又发生的跳闸
+} protect_status_t;
+
+esp_err_t protect_init(const protect_config_t *cfg);
+
+// 控制环每周期调用：测量值超限时立即经软件故障刹车
+void protect_check(float bus_voltage_v, float current_a);
+// 输出是否处于关断状态；跳闸期间控制环每周期复位 PID（清空积分）并把占空比压到下限，恢复后前馈渐入重新起步
+bool protect_tripped(void);
+
+void protect_get_status(protect_status_t *status);
+// 按时间顺序取第 index 条（0 为最早）事件，不存在时返回 false
+bool protect_get_event(int index, protect_event_t *event);
+
+// 注册 "prot" 命令：prot（状态）/ prot log [页] / prot clear / prot trip，以及 prot_oc / prot_ov 参数
+void protect_register_commands(void);
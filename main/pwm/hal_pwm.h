@@ -0,0 +1,23 @@
+// PWM 平台类型：ESP-IDF 下为 MCPWM 句柄，由 pwm_control.c 直接驱动硬件；
+// Linux 主机构建下由 pwm_control_linux.c 实现同一套 pwm_control 接口，占空比与频率送入 sim/sim_plant
+
+#pragma once
+
+#include "sdkconfig.h"
+
+#if CONFIG_IDF_TARGET_LINUX
+typedef void *mcpwm_timer_handle_t;
+typedef void *mcpwm_oper_handle_t;
+typedef void *mcpwm_cmpr_handle_t;
+typedef void *mcpwm_gen_handle_t;
+typedef void *mcpwm_sync_handle_t;
+typedef void *mcpwm_fault_handle_t;
+
+#ifndef SOC_MCPWM_TIMERS_PER_GROUP
+#define SOC_MCPWM_TIMERS_PER_GROUP 3
+#endif
+#else
+#include "driver/mcpwm_prelude.h"
+#include "driver/mcpwm_types.h"
+#include "soc/soc_caps.h"
+#endif
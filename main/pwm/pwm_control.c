@@ -1,43 +1,110 @@
 #include "pwm_control.h"
+#include "sdkconfig.h"
+#include <inttypes.h>
+
+// pwm_set_batch 与 TEZ 中断（均为 IRAM_ATTR）调用 mcpwm_comparator_set_compare_value，
+// 该函数默认在 flash 中，擦写 flash 期间从中断里调用会取指失败
+#if !CONFIG_MCPWM_CTRL_FUNC_IN_IRAM || !CONFIG_MCPWM_ISR_IRAM_SAFE
+#error "pwm requires CONFIG_MCPWM_CTRL_FUNC_IN_IRAM and CONFIG_MCPWM_ISR_IRAM_SAFE, see sdkconfig.defaults"
+#endif
 
 static const char *TAG = "pwm_mcpwm_new";
 
-static uint32_t duty_percent_to_ticks(float duty_percent, uint32_t period_ticks) {
+// 扩频（跳频）服务，同一时间只服务一个实例
+static esp_timer_handle_t s_hop_timer = NULL;
+static pwm_instance_t *s_hop_inst = NULL;
+static uint32_t s_hop_freqs[PWM_FREQ_PROFILE_MAX];
+static int s_hop_count = 0;
+static int s_hop_index = 0;
+
+static portMUX_TYPE s_pwm_batch_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// 占空比内部统一用 Q16 定点表示，PWM_DUTY_Q16_FULL 对应 100%
+static uint32_t duty_percent_to_q16(float duty_percent) {
     if (duty_percent < 0.0f) duty_percent = 0.0f;
     if (duty_percent > 100.0f) duty_percent = 100.0f;
-    return (uint32_t)((duty_percent / 100.0f) * period_ticks);
+    return (uint32_t)(duty_percent * (PWM_DUTY_Q16_FULL / 100.0f));
 }
 
-void pwm_init(uint32_t freq_hz, int group_id, pwm_instance_t *inst, gpio_num_t pwm_gpio) {
-    if (!inst) {
-        ESP_LOGE(TAG, "Invalid unit/timer/op");
-        return;
+// 返回 Q16 定点的比较值，period_ticks 不超过 16 位时不会溢出
+static inline uint32_t duty_q16_to_cmp_q16(uint32_t duty_q16, uint32_t period_ticks) {
+    return duty_q16 * period_ticks;
+}
+
+// 定时器计数到零时触发：累加小数部分，溢出时本周期比较值加一 tick
+// 写入的比较值进入影子寄存器，在下一个 TEZ 生效；与 pwm_set_hires、改频共用一把锁，
+// 另一个核心退出抖动模式时不会被这里的旧值覆盖
+static bool IRAM_ATTR pwm_timer_on_empty(mcpwm_timer_handle_t timer, const mcpwm_timer_event_data_t *edata, void *user_ctx) {
+    pwm_instance_t *inst = (pwm_instance_t *)user_ctx;
+    portENTER_CRITICAL_ISR(&s_pwm_batch_lock);
+    if (inst->hires_enabled) {
+        uint32_t target = inst->cmp_q16;
+        inst->dither_acc += target & 0xFFFF;
+        uint32_t cmp_ticks = (target >> 16) + (inst->dither_acc >> 16);
+        inst->dither_acc &= 0xFFFF;
+        if (cmp_ticks > inst->period_ticks) cmp_ticks = inst->period_ticks;
+        mcpwm_comparator_set_compare_value(inst->cmpr_h, cmp_ticks);
     }
-    if (inst->initialized) {
-        if (inst->gen_h) mcpwm_del_generator(inst->gen_h);
-        if (inst->cmpr_h) mcpwm_del_comparator(inst->cmpr_h);
-        if (inst->oper_h) mcpwm_del_operator(inst->oper_h);
-        if (inst->timer_h) mcpwm_del_timer(inst->timer_h);
-        inst->initialized = false;
+    portEXIT_CRITICAL_ISR(&s_pwm_batch_lock);
+    pwm_period_cb_t cb = inst->period_cb;
+    if (cb) {
+        cb(inst->period_cb_arg);
     }
+    return false;
+}
 
-    if (freq_hz == 0) {
-        ESP_LOGE(TAG, "Invalid frequency");
-        return;
-    }
-    inst->period_ticks = MCPWM_RESOLUTION_HZ / freq_hz;
-    if (inst->period_ticks == 0) {
-        ESP_LOGE(TAG, "Frequency too high for resolution");
-        return;
+// 定时器回调只能在 init 状态下注册，这里会短暂停止一次输出
+static void pwm_attach_isr(pwm_instance_t *inst) {
+    if (inst->isr_attached) return;
+    ESP_ERROR_CHECK(mcpwm_timer_start_stop(inst->timer_h, MCPWM_TIMER_STOP_EMPTY));
+    ESP_ERROR_CHECK(mcpwm_timer_disable(inst->timer_h));
+    mcpwm_timer_event_callbacks_t cbs = {
+        .on_empty = pwm_timer_on_empty,
+    };
+    ESP_ERROR_CHECK(mcpwm_timer_register_event_callbacks(inst->timer_h, &cbs, inst));
+    ESP_ERROR_CHECK(mcpwm_timer_enable(inst->timer_h));
+    ESP_ERROR_CHECK(mcpwm_timer_start_stop(inst->timer_h, MCPWM_TIMER_START_NO_STOP));
+    inst->isr_attached = true;
+}
+
+static void pwm_release(pwm_instance_t *inst) {
+    if (inst->gen_h) mcpwm_del_generator(inst->gen_h);
+    if (inst->cmpr_h) mcpwm_del_comparator(inst->cmpr_h);
+    if (inst->oper_h) mcpwm_del_operator(inst->oper_h);
+    if (inst->timer_h) mcpwm_del_timer(inst->timer_h);
+    for (int i = 0; i < PWM_FAULT_SOURCES; ++i) {
+        if (inst->faults[i]) mcpwm_del_fault(inst->faults[i]);
+        inst->faults[i] = NULL;
     }
+    inst->fault_latched = false;
+    inst->gen_h = NULL;
+    inst->cmpr_h = NULL;
+    inst->oper_h = NULL;
+    inst->timer_h = NULL;
+    inst->initialized = false;
+}
 
+// 创建 timer/oper/cmpr/gen 并设置动作，但不启动定时器
+static void pwm_build(uint32_t period_ticks, int group_id, pwm_instance_t *inst, gpio_num_t pwm_gpio) {
+    inst->period_ticks = period_ticks;
     inst->group_id = group_id;
+    inst->hires_enabled = false;
+    inst->isr_attached = false;
+    inst->cmp_q16 = 0;
+    inst->dither_acc = 0;
+    inst->duty_q16 = 0;
+    inst->cmp_ticks = 0;
+    inst->period_cb = NULL;
+    inst->period_cb_arg = NULL;
+    inst->conj = NULL;
+    inst->primary = NULL;
     mcpwm_timer_config_t timer_cfg = {
         .group_id = group_id,
         .clk_src = MCPWM_TIMER_CLK_SRC_DEFAULT,
         .resolution_hz = MCPWM_RESOLUTION_HZ,
         .period_ticks = inst->period_ticks,
         .count_mode = MCPWM_TIMER_COUNT_MODE_UP,
+        .flags.update_period_on_empty = true,
     };
     ESP_ERROR_CHECK(mcpwm_new_timer(&timer_cfg, &inst->timer_h));
     // 该定时器将向上计数，从 0 计数到 period_ticks，然后重新开始，重装填频率为 freq_hz
@@ -71,13 +138,34 @@ void pwm_init(uint32_t freq_hz, int group_id, pwm_instance_t *inst, gpio_num_t p
         MCPWM_GEN_COMPARE_EVENT_ACTION_END()
     ));
     // 在比较器值处将输出设置为高电平，形成低电平脉冲
+}
+
+void pwm_init(uint32_t freq_hz, int group_id, pwm_instance_t *inst, gpio_num_t pwm_gpio) {
+    if (!inst) {
+        ESP_LOGE(TAG, "Invalid unit/timer/op");
+        return;
+    }
+    if (inst->initialized) {
+        pwm_release(inst);
+    }
+
+    if (freq_hz == 0) {
+        ESP_LOGE(TAG, "Invalid frequency");
+        return;
+    }
+    uint32_t period_ticks = MCPWM_RESOLUTION_HZ / freq_hz;
+    if (period_ticks == 0) {
+        ESP_LOGE(TAG, "Frequency too high for resolution");
+        return;
+    }
+
+    pwm_build(period_ticks, group_id, inst, pwm_gpio);
 
     ESP_ERROR_CHECK(mcpwm_timer_enable(inst->timer_h));
     ESP_ERROR_CHECK(mcpwm_timer_start_stop(inst->timer_h, MCPWM_TIMER_START_NO_STOP));
 
-    inst->last_duty_percent = 0.0f;
     inst->initialized = true;
-    ESP_LOGI(TAG, "PWM initialized: group=%d freq=%u gpio=%d", group_id, freq_hz, pwm_gpio);
+    ESP_LOGI(TAG, "PWM initialized: group=%d freq=%" PRIu32 " gpio=%d", group_id, freq_hz, pwm_gpio);
 }
 
 void pwm_init_conj(uint32_t freq_hz, int group_id, pwm_instance_t *inst, gpio_num_t pwm_gpio, pwm_instance_t *inst_conj, gpio_num_t pwm_gpio_conj) {
@@ -87,11 +175,7 @@ void pwm_init_conj(uint32_t freq_hz, int group_id, pwm_instance_t *inst, gpio_nu
     }
     // 清理旧实例
     if (inst->initialized) {
-        if (inst->gen_h) mcpwm_del_generator(inst->gen_h);
-        if (inst->cmpr_h) mcpwm_del_comparator(inst->cmpr_h);
-        if (inst->oper_h) mcpwm_del_operator(inst->oper_h);
-        if (inst->timer_h) mcpwm_del_timer(inst->timer_h);
-        inst->initialized = false;
+        pwm_release(inst);
     }
     if (inst_conj->initialized) {
         if (inst_conj->gen_h) mcpwm_del_generator(inst_conj->gen_h);
@@ -114,6 +198,7 @@ void pwm_init_conj(uint32_t freq_hz, int group_id, pwm_instance_t *inst, gpio_nu
         .resolution_hz = MCPWM_RESOLUTION_HZ,
         .period_ticks = period_ticks,
         .count_mode = MCPWM_TIMER_COUNT_MODE_UP,
+        .flags.update_period_on_empty = true,
     };
     ESP_ERROR_CHECK(mcpwm_new_timer(&timer_cfg, &inst->timer_h));
     mcpwm_operator_config_t oper_cfg = {
@@ -164,16 +249,33 @@ void pwm_init_conj(uint32_t freq_hz, int group_id, pwm_instance_t *inst, gpio_nu
     ESP_ERROR_CHECK(mcpwm_timer_start_stop(inst->timer_h, MCPWM_TIMER_START_NO_STOP));
     // 两个实例共享 timer/oper/cmpr，独立 gen_h
     inst->period_ticks = period_ticks;
-    inst->last_duty_percent = 0.0f;
+    inst->hires_enabled = false;
+    inst->isr_attached = false;
+    inst_conj->hires_enabled = false;
+    inst_conj->isr_attached = false;
+    inst->period_cb = NULL;
+    inst_conj->period_cb = NULL;
+    inst->duty_q16 = 0;
+    inst->cmp_ticks = 0;
     inst->initialized = true;
     inst_conj->timer_h = inst->timer_h;
     inst_conj->oper_h = inst->oper_h;
     inst_conj->cmpr_h = inst->cmpr_h;
     inst_conj->period_ticks = period_ticks;
-    inst_conj->last_duty_percent = 0.0f;
+    inst_conj->duty_q16 = 0;
+    inst_conj->cmp_ticks = 0;
     inst_conj->initialized = true;
     inst_conj->group_id = group_id;
-    ESP_LOGI(TAG, "PWM conj initialized: group=%d freq=%u gpio(main)=%d gpio(conj)=%d", group_id, freq_hz, pwm_gpio, pwm_gpio_conj);
+    inst->conj = inst_conj;
+    inst->primary = NULL;
+    inst_conj->conj = NULL;
+    inst_conj->primary = inst;
+    ESP_LOGI(TAG, "PWM conj initialized: group=%d freq=%" PRIu32 " gpio(main)=%d gpio(conj)=%d", group_id, freq_hz, pwm_gpio, pwm_gpio_conj);
+}
+
+// 互补对共用一个比较器，占空比与比较值缓存都记在拥有比较器的主实例上
+static inline pwm_instance_t *pwm_cmpr_owner(pwm_instance_t *inst) {
+    return inst->primary ? inst->primary : inst;
 }
 
 void pwm_set(float duty_percent, pwm_instance_t *inst) {
@@ -182,13 +284,23 @@ void pwm_set(float duty_percent, pwm_instance_t *inst) {
         return;
     }
 
-    if (duty_percent < 0.0) duty_percent = 0.0;
-    if (duty_percent > 100.0) duty_percent = 100.0;
-
-    uint32_t cmp_ticks = duty_percent_to_ticks((float)duty_percent, inst->period_ticks);
-    ESP_ERROR_CHECK(mcpwm_comparator_set_compare_value(inst->cmpr_h, cmp_ticks));
-
-    inst->last_duty_percent = (float)duty_percent;
+    inst = pwm_cmpr_owner(inst);
+    uint32_t duty_q16 = duty_percent_to_q16(duty_percent);
+    esp_err_t ret = ESP_OK;
+    // 与 pwm_set_batch、改频共用一把锁，缓存的 duty_q16/cmp_ticks 与比较器始终一致
+    portENTER_CRITICAL_SAFE(&s_pwm_batch_lock);
+    inst->duty_q16 = duty_q16;
+    uint32_t cmp_q16 = duty_q16_to_cmp_q16(duty_q16, inst->period_ticks);
+    if (inst->hires_enabled) {
+        // 由 TEZ 中断负责写比较器
+        inst->cmp_q16 = cmp_q16;
+    } else {
+        uint32_t cmp_ticks = cmp_q16 >> 16;
+        ret = mcpwm_comparator_set_compare_value(inst->cmpr_h, cmp_ticks);
+        if (ret == ESP_OK) inst->cmp_ticks = cmp_ticks;
+    }
+    portEXIT_CRITICAL_SAFE(&s_pwm_batch_lock);
+    ESP_ERROR_CHECK(ret);
 }
 
 void pwm_stop(pwm_instance_t *inst) {
@@ -199,5 +311,366 @@ void pwm_stop(pwm_instance_t *inst) {
 
 float get_pwm_duty(pwm_instance_t *inst) {
     if (!inst || !inst->initialized) return 0.0f;
-    return inst->last_duty_percent;
-}
\ No newline at end of file
+    return pwm_cmpr_owner(inst)->duty_q16 * (100.0f / PWM_DUTY_Q16_FULL);
+}
+
+void pwm_set_hires(pwm_instance_t *inst, bool enable) {
+    if (!inst || !inst->initialized) {
+        ESP_LOGE(TAG, "PWM not initialized");
+        return;
+    }
+    inst = pwm_cmpr_owner(inst);
+    if (inst->hires_enabled == enable) return;
+
+    if (enable) {
+        pwm_attach_isr(inst);
+    }
+
+    // 交接在锁内完成：TEZ 中断与 pwm_set_batch 看到的模式、cmp_q16 与 cmp_ticks 始终一致
+    esp_err_t ret = ESP_OK;
+    portENTER_CRITICAL(&s_pwm_batch_lock);
+    inst->dither_acc = 0;
+    inst->cmp_q16 = duty_q16_to_cmp_q16(inst->duty_q16, inst->period_ticks);
+    inst->hires_enabled = enable;
+    if (!enable) {
+        // 退出抖动模式后回到整数 tick 的直接写入
+        inst->cmp_ticks = inst->cmp_q16 >> 16;
+        ret = mcpwm_comparator_set_compare_value(inst->cmpr_h, inst->cmp_ticks);
+    }
+    portEXIT_CRITICAL(&s_pwm_batch_lock);
+    ESP_ERROR_CHECK(ret);
+    ESP_LOGI(TAG, "PWM hires %s: period=%" PRIu32 " ticks", enable ? "enabled" : "disabled", inst->period_ticks);
+}
+
+void pwm_set_period_callback(pwm_instance_t *inst, pwm_period_cb_t cb, void *arg) {
+    if (!inst || !inst->initialized) {
+        ESP_LOGE(TAG, "PWM not initialized");
+        return;
+    }
+    // 先清空回调再改参数，避免中断拿到新参数配旧回调
+    inst->period_cb = NULL;
+    inst->period_cb_arg = arg;
+    if (cb) {
+        pwm_attach_isr(inst);
+    }
+    inst->period_cb = cb;
+}
+
+void pwm_init_multiphase(uint32_t freq_hz, int group_id, int phase_count, const gpio_num_t *pwm_gpios, pwm_multiphase_t *mp) {
+    if (!mp || !pwm_gpios) {
+        ESP_LOGE(TAG, "Invalid multiphase pointer");
+        return;
+    }
+    if (mp->initialized) {
+        pwm_multiphase_stop(mp);
+        if (mp->sync_h) mcpwm_del_sync_src(mp->sync_h);
+        mp->sync_h = NULL;
+        for (int i = 0; i < mp->phase_count; ++i) {
+            pwm_release(&mp->phases[i]);
+        }
+        mp->initialized = false;
+    }
+    if (phase_count < 2 || phase_count > PWM_PHASES_MAX) {
+        ESP_LOGE(TAG, "Invalid phase count: %d (2~%d)", phase_count, PWM_PHASES_MAX);
+        return;
+    }
+    if (freq_hz == 0) {
+        ESP_LOGE(TAG, "Invalid frequency");
+        return;
+    }
+    uint32_t period_ticks = MCPWM_RESOLUTION_HZ / freq_hz;
+    if (period_ticks == 0) {
+        ESP_LOGE(TAG, "Frequency too high for resolution");
+        return;
+    }
+
+    // 每一相独占一个 timer/oper/cmpr/gen，必须位于同一 group 才能共享同步源
+    for (int i = 0; i < phase_count; ++i) {
+        pwm_build(period_ticks, group_id, &mp->phases[i], pwm_gpios[i]);
+    }
+
+    // 第 0 相的定时器在每次计数到零时产生同步信号
+    mcpwm_timer_sync_src_config_t sync_cfg = {
+        .timer_event = MCPWM_TIMER_EVENT_EMPTY,
+    };
+    ESP_ERROR_CHECK(mcpwm_new_timer_sync_src(mp->phases[0].timer_h, &sync_cfg, &mp->sync_h));
+
+    // 其余相在收到同步信号时把计数值装载为 period * i / N，相当于相移 360°/N * i
+    // 同步在每个周期都会发生，因此各相的相位差被硬件锁定，不会随时间漂移
+    for (int i = 1; i < phase_count; ++i) {
+        mcpwm_timer_sync_phase_config_t phase_cfg = {
+            .sync_src = mp->sync_h,
+            .count_value = period_ticks * i / phase_count,
+            .direction = MCPWM_TIMER_DIRECTION_UP,
+        };
+        ESP_ERROR_CHECK(mcpwm_timer_set_phase_on_sync(mp->phases[i].timer_h, &phase_cfg));
+    }
+
+    for (int i = 0; i < phase_count; ++i) {
+        ESP_ERROR_CHECK(mcpwm_timer_enable(mp->phases[i].timer_h));
+    }
+    for (int i = 0; i < phase_count; ++i) {
+        ESP_ERROR_CHECK(mcpwm_timer_start_stop(mp->phases[i].timer_h, MCPWM_TIMER_START_NO_STOP));
+        mp->phases[i].initialized = true;
+    }
+
+    mp->phase_count = phase_count;
+    mp->initialized = true;
+    ESP_LOGI(TAG, "PWM multiphase initialized: group=%d freq=%" PRIu32 " phases=%d", group_id, freq_hz, phase_count);
+}
+
+void pwm_set_multiphase(float duty_percent, pwm_multiphase_t *mp) {
+    if (!mp || !mp->initialized) {
+        ESP_LOGE(TAG, "PWM multiphase not initialized");
+        return;
+    }
+    // 各相比较值都在 TEZ 生效，先把所有新值写入影子寄存器，下一周期同时更新
+    for (int i = 0; i < mp->phase_count; ++i) {
+        pwm_set(duty_percent, &mp->phases[i]);
+    }
+}
+
+void pwm_multiphase_stop(pwm_multiphase_t *mp) {
+    if (!mp || !mp->initialized) return;
+    for (int i = 0; i < mp->phase_count; ++i) {
+        pwm_stop(&mp->phases[i]);
+    }
+}
+
+// 只做检查与寄存器写入，不打印日志，供跳频定时器回调复用
+// 互补对只由主实例写定时器与比较器，共轭实例的占空比状态不参与计算，只同步 period_ticks
+static esp_err_t pwm_apply_period(uint32_t freq_hz, pwm_instance_t *inst) {
+    if (freq_hz == 0) return ESP_ERR_INVALID_ARG;
+    uint32_t period_ticks = MCPWM_RESOLUTION_HZ / freq_hz;
+    if (period_ticks == 0) return ESP_ERR_INVALID_ARG;
+    if (inst->primary) inst = inst->primary;
+    if (period_ticks == inst->period_ticks) return ESP_OK;
+
+    // 周期与比较值都写入影子寄存器、在 TEZ 装载。先算好新比较值，再在同一个临界区内连续写入两者，
+    // 两次写入之间只隔几条指令；写入之间恰好遇到 TEZ 的概率很小但不为零，那一个周期会是新周期配旧比较值
+    esp_err_t ret;
+    portENTER_CRITICAL_SAFE(&s_pwm_batch_lock);
+    uint32_t cmp_q16 = duty_q16_to_cmp_q16(inst->duty_q16, period_ticks);
+    uint32_t cmp_ticks = cmp_q16 >> 16;
+    ret = mcpwm_timer_set_period(inst->timer_h, period_ticks);
+    if (ret == ESP_OK) {
+        inst->period_ticks = period_ticks;
+        if (inst->conj) inst->conj->period_ticks = period_ticks;
+        if (inst->hires_enabled) {
+            // TEZ 中断在同一把锁内读取 cmp_q16，下一个周期即按新周期抖动
+            inst->cmp_q16 = cmp_q16;
+        } else {
+            ret = mcpwm_comparator_set_compare_value(inst->cmpr_h, cmp_ticks);
+            if (ret == ESP_OK) inst->cmp_ticks = cmp_ticks;
+        }
+    }
+    portEXIT_CRITICAL_SAFE(&s_pwm_batch_lock);
+    return ret;
+}
+
+esp_err_t pwm_set_freq(uint32_t freq_hz, pwm_instance_t *inst) {
+    if (!inst || !inst->initialized) {
+        ESP_LOGE(TAG, "PWM not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t ret = pwm_apply_period(freq_hz, inst);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set frequency %" PRIu32 ": %s", freq_hz, esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+void pwm_set_freq_multiphase(uint32_t freq_hz, pwm_multiphase_t *mp) {
+    if (!mp || !mp->initialized) {
+        ESP_LOGE(TAG, "PWM multiphase not initialized");
+        return;
+    }
+    for (int i = 0; i < mp->phase_count; ++i) {
+        pwm_set_freq(freq_hz, &mp->phases[i]);
+    }
+    // 相移计数值随周期等比例缩放，在下一次同步时生效
+    for (int i = 1; i < mp->phase_count; ++i) {
+        mcpwm_timer_sync_phase_config_t phase_cfg = {
+            .sync_src = mp->sync_h,
+            .count_value = mp->phases[i].period_ticks * i / mp->phase_count,
+            .direction = MCPWM_TIMER_DIRECTION_UP,
+        };
+        ESP_ERROR_CHECK(mcpwm_timer_set_phase_on_sync(mp->phases[i].timer_h, &phase_cfg));
+    }
+}
+
+static void pwm_hop_timer_callback(void *arg) {
+    if (!s_hop_inst || s_hop_count <= 0) return;
+    pwm_apply_period(s_hop_freqs[s_hop_index], s_hop_inst);
+    s_hop_index = (s_hop_index + 1) % s_hop_count;
+}
+
+void pwm_freq_profile_start(pwm_instance_t *inst, const uint32_t *freqs, int count, uint32_t dwell_us) {
+    if (!inst || !inst->initialized || !freqs) {
+        ESP_LOGE(TAG, "PWM not initialized");
+        return;
+    }
+    if (count <= 0 || count > PWM_FREQ_PROFILE_MAX || dwell_us == 0) {
+        ESP_LOGE(TAG, "Invalid frequency profile: count=%d dwell=%" PRIu32, count, dwell_us);
+        return;
+    }
+    pwm_freq_profile_stop();
+    memcpy(s_hop_freqs, freqs, count * sizeof(uint32_t));
+    s_hop_count = count;
+    s_hop_index = 0;
+    s_hop_inst = inst;
+    if (!s_hop_timer) {
+        const esp_timer_create_args_t timer_args = {
+            .callback = &pwm_hop_timer_callback,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "pwm_hop_timer"
+        };
+        ESP_ERROR_CHECK(esp_timer_create(&timer_args, &s_hop_timer));
+    }
+    ESP_ERROR_CHECK(esp_timer_start_periodic(s_hop_timer, dwell_us));
+    ESP_LOGI(TAG, "PWM frequency profile started: steps=%d dwell=%" PRIu32 "us", count, dwell_us);
+}
+
+void pwm_freq_profile_stop(void) {
+    if (s_hop_timer && s_hop_inst) {
+        esp_timer_stop(s_hop_timer);
+    }
+    s_hop_inst = NULL;
+}
+
+int pwm_freq_profile_triangle(uint32_t center_hz, uint32_t deviation_hz, int steps, uint32_t *freqs) {
+    if (!freqs || steps < 2 || steps > PWM_FREQ_PROFILE_MAX || deviation_hz >= center_hz) return 0;
+    // 一个完整三角波周期：从 center - dev 线性升到 center + dev 再降回
+    int half = steps / 2;
+    for (int i = 0; i < steps; ++i) {
+        int k = (i <= half) ? i : steps - i;
+        freqs[i] = center_hz - deviation_hz + (uint32_t)((uint64_t)2 * deviation_hz * k / half);
+    }
+    return steps;
+}
+
+esp_err_t IRAM_ATTR pwm_set_batch(const pwm_duty_t *duties, int count) {
+    if (!duties || count <= 0) return ESP_ERR_INVALID_ARG;
+    esp_err_t ret = ESP_OK;
+
+    // 所有比较器都只在 TEZ 装载影子寄存器，临界区保证这一批写入在几百纳秒内完成，
+    // 同一定时器上的通道会在同一个 TEZ 一起生效；互补对的两个实例按共用的比较器去重
+    portENTER_CRITICAL_SAFE(&s_pwm_batch_lock);
+    for (int i = 0; i < count; ++i) {
+        pwm_instance_t *inst = duties[i].inst;
+        if (!inst || !inst->initialized) {
+            ret = ESP_ERR_INVALID_STATE;
+            continue;
+        }
+        inst = pwm_cmpr_owner(inst);
+        uint32_t duty_q16 = duties[i].duty_q16;
+        if (duty_q16 > PWM_DUTY_Q16_FULL) duty_q16 = PWM_DUTY_Q16_FULL;
+        if (duty_q16 == inst->duty_q16) continue;
+        inst->duty_q16 = duty_q16;
+
+        uint32_t cmp_q16 = duty_q16_to_cmp_q16(duty_q16, inst->period_ticks);
+        if (inst->hires_enabled) {
+            inst->cmp_q16 = cmp_q16;
+            continue;
+        }
+        uint32_t cmp_ticks = cmp_q16 >> 16;
+        if (cmp_ticks == inst->cmp_ticks) continue;
+        if (mcpwm_comparator_set_compare_value(inst->cmpr_h, cmp_ticks) == ESP_OK) {
+            inst->cmp_ticks = cmp_ticks;
+        } else {
+            ret = ESP_FAIL;
+        }
+    }
+    portEXIT_CRITICAL_SAFE(&s_pwm_batch_lock);
+    return ret;
+}
+// GPIO 故障进入中断：硬件已经完成刹车，这里只记录状态并通知上层
+static bool IRAM_ATTR pwm_fault_on_enter(mcpwm_fault_handle_t fault, const mcpwm_fault_event_data_t *edata, void *user_ctx) {
+    pwm_instance_t *inst = (pwm_instance_t *)user_ctx;
+    inst->fault_latched = true;
+    int source = -1;
+    for (int i = 0; i < PWM_FAULT_GPIO_MAX; ++i) {
+        if (inst->faults[i] == fault) source = i;
+    }
+    pwm_fault_cb_t cb = inst->fault_cb;
+    return cb ? cb(source, inst->fault_cb_arg) : false;
+}
+
+static esp_err_t pwm_fault_attach(pwm_instance_t *inst, pwm_instance_t *inst_conj, mcpwm_fault_handle_t fault) {
+    mcpwm_brake_config_t brake_cfg = {
+        .fault = fault,
+        .brake_mode = MCPWM_OPER_BRAKE_MODE_OST,
+    };
+    esp_err_t ret = mcpwm_operator_set_brake_on_fault(inst->oper_h, &brake_cfg);
+    if (ret != ESP_OK) return ret;
+    // 刹车期间上下管都关断，同步整流的续流管也不再导通
+    pwm_instance_t *insts[2] = { inst, inst_conj };
+    for (int i = 0; i < 2; ++i) {
+        if (!insts[i] || !insts[i]->gen_h) continue;
+        ret = mcpwm_generator_set_actions_on_brake_event(
+            insts[i]->gen_h,
+            MCPWM_GEN_BRAKE_EVENT_ACTION(MCPWM_TIMER_DIRECTION_UP, MCPWM_OPER_BRAKE_MODE_OST, MCPWM_GEN_ACTION_LOW),
+            MCPWM_GEN_BRAKE_EVENT_ACTION_END());
+        if (ret != ESP_OK) return ret;
+    }
+    return ESP_OK;
+}
+
+esp_err_t pwm_fault_init(pwm_instance_t *inst, pwm_instance_t *inst_conj, const pwm_fault_config_t *cfg) {
+    if (!inst || !inst->initialized || !cfg) return ESP_ERR_INVALID_ARG;
+    if (inst->faults[PWM_FAULT_SOFT]) return ESP_ERR_INVALID_STATE;
+    inst->fault_cb = cfg->cb;
+    inst->fault_cb_arg = cfg->cb_arg;
+    inst->fault_latched = false;
+
+    esp_err_t ret;
+    for (int i = 0; i < PWM_FAULT_GPIO_MAX; ++i) {
+        if (cfg->gpios[i] == GPIO_NUM_NC) continue;
+        mcpwm_gpio_fault_config_t fault_cfg = {
+            .group_id = inst->group_id,
+            .gpio_num = cfg->gpios[i],
+            .flags.active_level = cfg->active_high[i],
+            .flags.pull_up = !cfg->active_high[i],
+            .flags.pull_down = cfg->active_high[i],
+        };
+        ret = mcpwm_new_gpio_fault(&fault_cfg, &inst->faults[i]);
+        if (ret != ESP_OK) return ret;
+        mcpwm_fault_event_callbacks_t cbs = {
+            .on_fault_enter = pwm_fault_on_enter,
+        };
+        ret = mcpwm_fault_register_event_callbacks(inst->faults[i], &cbs, inst);
+        if (ret != ESP_OK) return ret;
+        ret = pwm_fault_attach(inst, inst_conj, inst->faults[i]);
+        if (ret != ESP_OK) return ret;
+    }
+
+    mcpwm_soft_fault_config_t soft_cfg = {};
+    ret = mcpwm_new_soft_fault(&soft_cfg, &inst->faults[PWM_FAULT_SOFT]);
+    if (ret != ESP_OK) return ret;
+    ret = pwm_fault_attach(inst, inst_conj, inst->faults[PWM_FAULT_SOFT]);
+    if (ret != ESP_OK) return ret;
+
+    ESP_LOGI(TAG, "PWM fault brake enabled: group=%d gpio=%d/%d", inst->group_id, cfg->gpios[0], cfg->gpios[1]);
+    return ESP_OK;
+}
+
+esp_err_t pwm_fault_trigger(pwm_instance_t *inst) {
+    if (!inst || !inst->faults[PWM_FAULT_SOFT]) return ESP_ERR_INVALID_STATE;
+    inst->fault_latched = true;
+    return mcpwm_soft_fault_activate(inst->faults[PWM_FAULT_SOFT]);
+}
+
+esp_err_t pwm_fault_recover(pwm_instance_t *inst) {
+    if (!inst || !inst->initialized) return ESP_ERR_INVALID_STATE;
+    for (int i = 0; i < PWM_FAULT_SOURCES; ++i) {
+        if (!inst->faults[i]) continue;
+        esp_err_t ret = mcpwm_operator_recover_from_fault(inst->oper_h, inst->faults[i]);
+        if (ret != ESP_OK) return ret;
+    }
+    inst->fault_latched = false;
+    return ESP_OK;
+}
+
+bool pwm_fault_active(const pwm_instance_t *inst) {
+    return inst && inst->fault_latched;
+}
@@ -1,25 +1,120 @@
 #pragma once
 
 #include "global_params.h"
-#include "driver/mcpwm_prelude.h"
-#include "driver/mcpwm_types.h"
+#include "pwm/hal_pwm.h"
 #include "esp_log.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include <string.h>
 
 #define MCPWM_RESOLUTION_HZ (30000000) // 30 MHz 分辨率
+#define PWM_FREQ_PROFILE_MAX 64
+#define PWM_DUTY_Q16_FULL    (1u << 16)
+
+// 每个 PWM 周期起点（TEZ）在中断中调用，须放在 IRAM 中且不可阻塞
+typedef void (*pwm_period_cb_t)(void *arg);
+
+// 故障源编号：前 PWM_FAULT_GPIO_MAX 个为 GPIO 故障输入，最后一个为软件故障
+#define PWM_FAULT_GPIO_MAX   2
+#define PWM_FAULT_SOFT       PWM_FAULT_GPIO_MAX
+#define PWM_FAULT_SOURCES    (PWM_FAULT_GPIO_MAX + 1)
+
+// GPIO 故障进入时在中断中调用，source 为故障源编号；须放在 IRAM 中，返回是否需要切换任务
+typedef bool (*pwm_fault_cb_t)(int source, void *arg);
 
 typedef struct {
+    gpio_num_t gpios[PWM_FAULT_GPIO_MAX];   // GPIO_NUM_NC 表示不使用
+    bool active_high[PWM_FAULT_GPIO_MAX];   // false：低电平有效并开启内部上拉（适合开漏报警输出）
+    pwm_fault_cb_t cb;
+    void *cb_arg;
+} pwm_fault_config_t;
+
+typedef struct pwm_instance {
     int group_id;
     mcpwm_timer_handle_t timer_h;
     mcpwm_oper_handle_t oper_h;
     mcpwm_cmpr_handle_t cmpr_h;
     mcpwm_gen_handle_t gen_h;
-    float last_duty_percent;
+    uint32_t duty_q16;   // 当前占空比，Q16 定点，PWM_DUTY_Q16_FULL 为 100%
+    uint32_t cmp_ticks;  // 最近一次写入比较器的值
     uint32_t period_ticks;
     bool initialized;
+    // 高分辨率模式：比较值以 Q16 定点保存，由 TEZ 中断逐周期抖动输出
+    bool hires_enabled;
+    bool isr_attached;
+    volatile uint32_t cmp_q16;
+    uint32_t dither_acc;
+    pwm_period_cb_t period_cb;
+    void *period_cb_arg;
+    // 故障保护：任一故障源触发后两路输出由硬件刹车保持低电平，直到 pwm_fault_recover
+    mcpwm_fault_handle_t faults[PWM_FAULT_SOURCES];
+    pwm_fault_cb_t fault_cb;
+    void *fault_cb_arg;
+    volatile bool fault_latched;
+    // 互补对：主实例拥有 timer/oper/cmpr，conj 指向共轭实例；共轭实例的 primary 指回主实例
+    struct pwm_instance *conj;
+    struct pwm_instance *primary;
 } pwm_instance_t;
 
+// 交错并联的最大相数受限于单个 MCPWM group 内的定时器数量
+#define PWM_PHASES_MAX SOC_MCPWM_TIMERS_PER_GROUP
+
+typedef struct {
+    int phase_count;
+    pwm_instance_t phases[PWM_PHASES_MAX];
+    mcpwm_sync_handle_t sync_h;
+    bool initialized;
+} pwm_multiphase_t;
+
+typedef struct {
+    pwm_instance_t *inst;
+    uint32_t duty_q16;   // Q16 定点占空比，0 ~ PWM_DUTY_Q16_FULL
+} pwm_duty_t;
+
+// 将百分比换算为 pwm_duty_t 使用的 Q16 定点值，可在非热路径预先计算
+#define PWM_DUTY_PERCENT_TO_Q16(p) ((uint32_t)((p) * (PWM_DUTY_Q16_FULL / 100.0f)))
+
 void pwm_init(uint32_t freq_hz, int group_id, pwm_instance_t *inst, gpio_num_t pwm_gpio);
 void pwm_init_conj(uint32_t freq_hz, int group_id, pwm_instance_t *inst, gpio_num_t pwm_gpio, pwm_instance_t *inst_conj, gpio_num_t pwm_gpio_conj);
 void pwm_set(float duty_percent, pwm_instance_t *inst);
 void pwm_stop(pwm_instance_t *inst);
-float get_pwm_duty(pwm_instance_t *inst);
\ No newline at end of file
+float get_pwm_duty(pwm_instance_t *inst);
+
+// 开关高分辨率占空比模式。开启后 pwm_set 只更新目标值，比较值在每个周期起点由中断
+// 按一阶 sigma-delta 在 floor/ceil 之间抖动，平均占空比分辨率达到周期的 1/65536
+// 互补输出共用比较器，对主实例开启即可同时作用于两路输出
+void pwm_set_hires(pwm_instance_t *inst, bool enable);
+
+// 注册周期回调，用于把外部采样等动作同步到开关周期；cb 为 NULL 时取消
+void pwm_set_period_callback(pwm_instance_t *inst, pwm_period_cb_t cb, void *arg);
+
+// 多相交错 PWM：phase_count 路输出由同一 group 的定时器硬件同步，依次相移 360°/phase_count
+void pwm_init_multiphase(uint32_t freq_hz, int group_id, int phase_count, const gpio_num_t *pwm_gpios, pwm_multiphase_t *mp);
+void pwm_set_multiphase(float duty_percent, pwm_multiphase_t *mp);
+void pwm_multiphase_stop(pwm_multiphase_t *mp);
+
+// 运行时修改频率并保持占空比不变，周期与比较值在同一临界区内写入影子寄存器、在 TEZ 装载，不会中断输出
+// 互补输出的两个实例共用定时器与比较器，对任一实例调用一次即可，另一实例的 period_ticks 随之同步
+// 频率超出范围或写寄存器失败时返回错误，此时周期与占空比保持原值
+esp_err_t pwm_set_freq(uint32_t freq_hz, pwm_instance_t *inst);
+void pwm_set_freq_multiphase(uint32_t freq_hz, pwm_multiphase_t *mp);
+
+// 扩频：每隔 dwell_us 依次切换到 freqs 中的下一个频率并循环，用于降低 EMI 峰值或扫频
+void pwm_freq_profile_start(pwm_instance_t *inst, const uint32_t *freqs, int count, uint32_t dwell_us);
+void pwm_freq_profile_stop(void);
+// 生成 center_hz ± deviation_hz 的三角波跳频表，返回写入的点数
+int pwm_freq_profile_triangle(uint32_t center_hz, uint32_t deviation_hz, int steps, uint32_t *freqs);
+
+// 故障保护：GPIO 故障与软件故障都接到 inst 的 operator 上，以一次性（OST）方式刹车，
+// inst 与 inst_conj（可为 NULL）的输出立即拉低，不经过软件，响应时间为微秒级
+esp_err_t pwm_fault_init(pwm_instance_t *inst, pwm_instance_t *inst_conj, const pwm_fault_config_t *cfg);
+// 软件触发刹车，与 GPIO 故障走同一条硬件通路；不调用 fault 回调
+esp_err_t pwm_fault_trigger(pwm_instance_t *inst);
+// 所有故障信号撤销后解除刹车；仍有故障有效时返回 ESP_ERR_INVALID_STATE，输出保持关闭
+esp_err_t pwm_fault_recover(pwm_instance_t *inst);
+bool pwm_fault_active(const pwm_instance_t *inst);
+
+// 批量更新占空比：纯整数运算，跳过未变化的通道，不打印日志也不 abort，可在中断中调用
+// 同一定时器上的通道在同一个 TEZ 生效；出错时返回错误码，其余通道仍会更新
+esp_err_t pwm_set_batch(const pwm_duty_t *duties, int count);
\ No newline at end of file
@@ -0,0 +1,332 @@
+#include "pwm_control.h"
+#include "sim/sim_plant.h"
+#include <inttypes.h>
+
+// Linux 主机构建：没有 MCPWM，第一个初始化的实例驱动仿真被控对象，
+// 周期回调由 esp_timer 按开关周期触发（周期过短时降频到 PWM_SIM_MIN_PERIOD_US）
+// 故障 GPIO 按同样的周期轮询 hal_gpio 电平，刹车时仿真对象的占空比置零
+
+#define PWM_SIM_MIN_PERIOD_US 100
+
+static const char *TAG = "pwm_sim";
+
+static pwm_instance_t *s_plant_inst = NULL;
+
+static pwm_instance_t *s_fault_inst = NULL;
+static esp_timer_handle_t s_fault_timer = NULL;
+static pwm_fault_config_t s_fault_cfg;
+
+static esp_timer_handle_t s_hop_timer = NULL;
+static pwm_instance_t *s_hop_inst = NULL;
+static uint32_t s_hop_freqs[PWM_FREQ_PROFILE_MAX];
+static int s_hop_count = 0;
+static int s_hop_index = 0;
+
+static uint32_t duty_percent_to_q16(float duty_percent) {
+    if (duty_percent < 0.0f) duty_percent = 0.0f;
+    if (duty_percent > 100.0f) duty_percent = 100.0f;
+    return (uint32_t)(duty_percent * (PWM_DUTY_Q16_FULL / 100.0f));
+}
+
+static void pwm_sim_apply(pwm_instance_t *inst) {
+    inst->cmp_ticks = (uint32_t)(((uint64_t)inst->duty_q16 * inst->period_ticks) >> 16);
+    inst->cmp_q16 = inst->duty_q16 * inst->period_ticks;
+    if (inst == s_plant_inst) {
+        sim_plant_set_duty(inst->fault_latched ? 0.0f : inst->duty_q16 * (100.0f / PWM_DUTY_Q16_FULL));
+    }
+}
+
+static uint64_t pwm_sim_period_us(const pwm_instance_t *inst) {
+    uint64_t us = (uint64_t)inst->period_ticks * 1000000 / MCPWM_RESOLUTION_HZ;
+    return us < PWM_SIM_MIN_PERIOD_US ? PWM_SIM_MIN_PERIOD_US : us;
+}
+
+static void pwm_sim_period_timer(void *arg) {
+    pwm_instance_t *inst = (pwm_instance_t *)arg;
+    pwm_period_cb_t cb = inst->period_cb;
+    if (cb) cb(inst->period_cb_arg);
+}
+
+static void pwm_sim_build(uint32_t freq_hz, int group_id, pwm_instance_t *inst, gpio_num_t pwm_gpio) {
+    memset(inst, 0, sizeof(*inst));
+    inst->group_id = group_id;
+    inst->period_ticks = MCPWM_RESOLUTION_HZ / freq_hz;
+    inst->initialized = true;
+    if (!s_plant_inst) {
+        s_plant_inst = inst;
+        sim_plant_set_freq(freq_hz);
+    }
+    pwm_sim_apply(inst);
+}
+
+void pwm_init(uint32_t freq_hz, int group_id, pwm_instance_t *inst, gpio_num_t pwm_gpio) {
+    if (!inst || freq_hz == 0 || MCPWM_RESOLUTION_HZ / freq_hz == 0) {
+        ESP_LOGE(TAG, "Invalid PWM config");
+        return;
+    }
+    pwm_sim_build(freq_hz, group_id, inst, pwm_gpio);
+    ESP_LOGI(TAG, "PWM initialized: group=%d freq=%" PRIu32 " gpio=%d", group_id, freq_hz, pwm_gpio);
+}
+
+void pwm_init_conj(uint32_t freq_hz, int group_id, pwm_instance_t *inst, gpio_num_t pwm_gpio, pwm_instance_t *inst_conj, gpio_num_t pwm_gpio_conj) {
+    if (!inst || !inst_conj || freq_hz == 0 || MCPWM_RESOLUTION_HZ / freq_hz == 0) {
+        ESP_LOGE(TAG, "Invalid PWM config");
+        return;
+    }
+    pwm_sim_build(freq_hz, group_id, inst, pwm_gpio);
+    pwm_sim_build(freq_hz, group_id, inst_conj, pwm_gpio_conj);
+    inst->conj = inst_conj;
+    inst_conj->primary = inst;
+    ESP_LOGI(TAG, "PWM conj initialized: group=%d freq=%" PRIu32 " gpio(main)=%d gpio(conj)=%d", group_id, freq_hz, pwm_gpio, pwm_gpio_conj);
+}
+
+// 与 MCPWM 实现一致：互补对的占空比只记在主实例上
+static inline pwm_instance_t *pwm_cmpr_owner(pwm_instance_t *inst) {
+    return inst->primary ? inst->primary : inst;
+}
+
+void pwm_set(float duty_percent, pwm_instance_t *inst) {
+    if (!inst || !inst->initialized) {
+        ESP_LOGE(TAG, "PWM not initialized");
+        return;
+    }
+    inst = pwm_cmpr_owner(inst);
+    inst->duty_q16 = duty_percent_to_q16(duty_percent);
+    pwm_sim_apply(inst);
+}
+
+void pwm_stop(pwm_instance_t *inst) {
+    if (!inst || !inst->initialized) return;
+    if (inst == s_plant_inst) sim_plant_set_duty(0.0f);
+    if (inst->timer_h) esp_timer_stop((esp_timer_handle_t)inst->timer_h);
+}
+
+float get_pwm_duty(pwm_instance_t *inst) {
+    if (!inst || !inst->initialized) return 0.0f;
+    return pwm_cmpr_owner(inst)->duty_q16 * (100.0f / PWM_DUTY_Q16_FULL);
+}
+
+void pwm_set_hires(pwm_instance_t *inst, bool enable) {
+    if (!inst || !inst->initialized) {
+        ESP_LOGE(TAG, "PWM not initialized");
+        return;
+    }
+    // 仿真对象直接使用连续占空比，高分辨率模式只记录状态
+    inst->hires_enabled = enable;
+}
+
+void pwm_set_period_callback(pwm_instance_t *inst, pwm_period_cb_t cb, void *arg) {
+    if (!inst || !inst->initialized) {
+        ESP_LOGE(TAG, "PWM not initialized");
+        return;
+    }
+    inst->period_cb = NULL;
+    inst->period_cb_arg = arg;
+    if (cb && !inst->timer_h) {
+        const esp_timer_create_args_t timer_args = {
+            .callback = &pwm_sim_period_timer,
+            .arg = inst,
+            .name = "pwm_period"
+        };
+        esp_timer_handle_t timer;
+        ESP_ERROR_CHECK(esp_timer_create(&timer_args, &timer));
+        ESP_ERROR_CHECK(esp_timer_start_periodic(timer, pwm_sim_period_us(inst)));
+        inst->timer_h = timer;
+        inst->isr_attached = true;
+    }
+    inst->period_cb = cb;
+}
+
+void pwm_init_multiphase(uint32_t freq_hz, int group_id, int phase_count, const gpio_num_t *pwm_gpios, pwm_multiphase_t *mp) {
+    if (!mp || !pwm_gpios || phase_count < 1 || phase_count > PWM_PHASES_MAX) {
+        ESP_LOGE(TAG, "Invalid multiphase config");
+        return;
+    }
+    for (int i = 0; i < phase_count; ++i) {
+        pwm_sim_build(freq_hz, group_id, &mp->phases[i], pwm_gpios[i]);
+    }
+    mp->phase_count = phase_count;
+    mp->initialized = true;
+    ESP_LOGI(TAG, "PWM multiphase initialized: group=%d freq=%" PRIu32 " phases=%d", group_id, freq_hz, phase_count);
+}
+
+void pwm_set_multiphase(float duty_percent, pwm_multiphase_t *mp) {
+    if (!mp || !mp->initialized) {
+        ESP_LOGE(TAG, "PWM multiphase not initialized");
+        return;
+    }
+    for (int i = 0; i < mp->phase_count; ++i) {
+        pwm_set(duty_percent, &mp->phases[i]);
+    }
+}
+
+void pwm_multiphase_stop(pwm_multiphase_t *mp) {
+    if (!mp || !mp->initialized) return;
+    for (int i = 0; i < mp->phase_count; ++i) {
+        pwm_stop(&mp->phases[i]);
+    }
+}
+
+static esp_err_t pwm_apply_period(uint32_t freq_hz, pwm_instance_t *inst) {
+    if (freq_hz == 0) return ESP_ERR_INVALID_ARG;
+    uint32_t period_ticks = MCPWM_RESOLUTION_HZ / freq_hz;
+    if (period_ticks == 0) return ESP_ERR_INVALID_ARG;
+    if (inst->primary) inst = inst->primary;
+    if (period_ticks == inst->period_ticks) return ESP_OK;
+    inst->period_ticks = period_ticks;
+    if (inst->conj) inst->conj->period_ticks = period_ticks;
+    pwm_sim_apply(inst);
+    if (inst == s_plant_inst) sim_plant_set_freq(freq_hz);
+    if (inst->timer_h) {
+        esp_timer_stop((esp_timer_handle_t)inst->timer_h);
+        esp_timer_start_periodic((esp_timer_handle_t)inst->timer_h, pwm_sim_period_us(inst));
+    }
+    return ESP_OK;
+}
+
+esp_err_t pwm_set_freq(uint32_t freq_hz, pwm_instance_t *inst) {
+    if (!inst || !inst->initialized) {
+        ESP_LOGE(TAG, "PWM not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t ret = pwm_apply_period(freq_hz, inst);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set frequency %" PRIu32 ": %s", freq_hz, esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+void pwm_set_freq_multiphase(uint32_t freq_hz, pwm_multiphase_t *mp) {
+    if (!mp || !mp->initialized) {
+        ESP_LOGE(TAG, "PWM multiphase not initialized");
+        return;
+    }
+    for (int i = 0; i < mp->phase_count; ++i) {
+        pwm_set_freq(freq_hz, &mp->phases[i]);
+    }
+}
+
+static void pwm_hop_timer_callback(void *arg) {
+    if (!s_hop_inst || s_hop_count <= 0) return;
+    pwm_apply_period(s_hop_freqs[s_hop_index], s_hop_inst);
+    s_hop_index = (s_hop_index + 1) % s_hop_count;
+}
+
+void pwm_freq_profile_start(pwm_instance_t *inst, const uint32_t *freqs, int count, uint32_t dwell_us) {
+    if (!inst || !inst->initialized || !freqs) {
+        ESP_LOGE(TAG, "PWM not initialized");
+        return;
+    }
+    if (count <= 0 || count > PWM_FREQ_PROFILE_MAX || dwell_us == 0) {
+        ESP_LOGE(TAG, "Invalid frequency profile: count=%d dwell=%" PRIu32, count, dwell_us);
+        return;
+    }
+    pwm_freq_profile_stop();
+    memcpy(s_hop_freqs, freqs, count * sizeof(uint32_t));
+    s_hop_count = count;
+    s_hop_index = 0;
+    s_hop_inst = inst;
+    if (!s_hop_timer) {
+        const esp_timer_create_args_t timer_args = {
+            .callback = &pwm_hop_timer_callback,
+            .name = "pwm_hop_timer"
+        };
+        ESP_ERROR_CHECK(esp_timer_create(&timer_args, &s_hop_timer));
+    }
+    ESP_ERROR_CHECK(esp_timer_start_periodic(s_hop_timer, dwell_us));
+}
+
+void pwm_freq_profile_stop(void) {
+    if (s_hop_timer && s_hop_inst) {
+        esp_timer_stop(s_hop_timer);
+    }
+    s_hop_inst = NULL;
+}
+
+int pwm_freq_profile_triangle(uint32_t center_hz, uint32_t deviation_hz, int steps, uint32_t *freqs) {
+    if (!freqs || steps < 2 || steps > PWM_FREQ_PROFILE_MAX || deviation_hz >= center_hz) return 0;
+    int half = steps / 2;
+    for (int i = 0; i < steps; ++i) {
+        int k = (i <= half) ? i : steps - i;
+        freqs[i] = center_hz - deviation_hz + (uint32_t)((uint64_t)2 * deviation_hz * k / half);
+    }
+    return steps;
+}
+
+esp_err_t pwm_set_batch(const pwm_duty_t *duties, int count) {
+    if (!duties || count <= 0) return ESP_ERR_INVALID_ARG;
+    esp_err_t ret = ESP_OK;
+    for (int i = 0; i < count; ++i) {
+        pwm_instance_t *inst = duties[i].inst;
+        if (!inst || !inst->initialized) {
+            ret = ESP_ERR_INVALID_STATE;
+            continue;
+        }
+        inst = pwm_cmpr_owner(inst);
+        uint32_t duty_q16 = duties[i].duty_q16;
+        if (duty_q16 > PWM_DUTY_Q16_FULL) duty_q16 = PWM_DUTY_Q16_FULL;
+        if (duty_q16 == inst->duty_q16) continue;
+        inst->duty_q16 = duty_q16;
+        pwm_sim_apply(inst);
+    }
+    return ret;
+}
+
+static void pwm_sim_fault_poll(void *arg) {
+    pwm_instance_t *inst = s_fault_inst;
+    if (!inst) return;
+    for (int i = 0; i < PWM_FAULT_GPIO_MAX; ++i) {
+        if (s_fault_cfg.gpios[i] == GPIO_NUM_NC) continue;
+        bool active = hal_gpio_get_level(s_fault_cfg.gpios[i]) == (s_fault_cfg.active_high[i] ? 1 : 0);
+        if (!active || inst->fault_latched) continue;
+        inst->fault_latched = true;
+        pwm_sim_apply(inst);
+        if (inst->fault_cb) inst->fault_cb(i, inst->fault_cb_arg);
+    }
+}
+
+esp_err_t pwm_fault_init(pwm_instance_t *inst, pwm_instance_t *inst_conj, const pwm_fault_config_t *cfg) {
+    if (!inst || !inst->initialized || !cfg) return ESP_ERR_INVALID_ARG;
+    if (s_fault_inst) return ESP_ERR_INVALID_STATE;
+    s_fault_cfg = *cfg;
+    inst->fault_cb = cfg->cb;
+    inst->fault_cb_arg = cfg->cb_arg;
+    inst->fault_latched = false;
+    // 仿真上拉/下拉：故障输入初始为无效电平
+    for (int i = 0; i < PWM_FAULT_GPIO_MAX; ++i) {
+        if (cfg->gpios[i] != GPIO_NUM_NC) hal_gpio_init(cfg->gpios[i], GPIO_MODE_INPUT, cfg->active_high[i] ? 0 : 1);
+    }
+    s_fault_inst = inst;
+    const esp_timer_create_args_t timer_args = {
+        .callback = &pwm_sim_fault_poll,
+        .name = "pwm_fault"
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &s_fault_timer));
+    ESP_ERROR_CHECK(esp_timer_start_periodic(s_fault_timer, PWM_SIM_MIN_PERIOD_US));
+    ESP_LOGI(TAG, "PWM fault brake enabled: gpio=%d/%d", cfg->gpios[0], cfg->gpios[1]);
+    return ESP_OK;
+}
+
+esp_err_t pwm_fault_trigger(pwm_instance_t *inst) {
+    if (!inst || inst != s_fault_inst) return ESP_ERR_INVALID_STATE;
+    inst->fault_latched = true;
+    pwm_sim_apply(inst);
+    return ESP_OK;
+}
+
+esp_err_t pwm_fault_recover(pwm_instance_t *inst) {
+    if (!inst || !inst->initialized) return ESP_ERR_INVALID_STATE;
+    if (inst == s_fault_inst) {
+        for (int i = 0; i < PWM_FAULT_GPIO_MAX; ++i) {
+            if (s_fault_cfg.gpios[i] == GPIO_NUM_NC) continue;
+            if (hal_gpio_get_level(s_fault_cfg.gpios[i]) == (s_fault_cfg.active_high[i] ? 1 : 0)) return ESP_ERR_INVALID_STATE;
+        }
+    }
+    inst->fault_latched = false;
+    pwm_sim_apply(inst);
+    return ESP_OK;
+}
+
+bool pwm_fault_active(const pwm_instance_t *inst) {
+    return inst && inst->fault_latched;
+}
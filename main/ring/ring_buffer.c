@@ -0,0 +1,74 @@
+#include "ring_buffer.h"
+#include <string.h>
+
+esp_err_t ring_init(ring_buffer_t *ring, void *storage, size_t elem_size, uint32_t capacity)
+{
+    if (!ring || !storage || elem_size == 0) return ESP_ERR_INVALID_ARG;
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0) return ESP_ERR_INVALID_SIZE;
+    ring->storage = (uint8_t *)storage;
+    ring->elem_size = elem_size;
+    ring->mask = capacity - 1;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    ring->overruns = 0;
+    ring->high_water = 0;
+    return ESP_OK;
+}
+
+void * IRAM_ATTR ring_claim_write(ring_buffer_t *ring)
+{
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    uint32_t used = head - tail;
+    if (used > ring->mask) {
+        ring->overruns++;
+        return NULL;
+    }
+    if (used + 1 > ring->high_water) ring->high_water = used + 1;
+    return ring->storage + (head & ring->mask) * ring->elem_size;
+}
+
+void IRAM_ATTR ring_commit_write(ring_buffer_t *ring)
+{
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+void * IRAM_ATTR ring_claim_read(ring_buffer_t *ring)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    if (head == tail) return NULL;
+    return ring->storage + (tail & ring->mask) * ring->elem_size;
+}
+
+void IRAM_ATTR ring_release_read(ring_buffer_t *ring)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+}
+
+bool ring_push(ring_buffer_t *ring, const void *elem)
+{
+    void *slot = ring_claim_write(ring);
+    if (!slot) return false;
+    memcpy(slot, elem, ring->elem_size);
+    ring_commit_write(ring);
+    return true;
+}
+
+bool ring_pop(ring_buffer_t *ring, void *elem)
+{
+    void *slot = ring_claim_read(ring);
+    if (!slot) return false;
+    memcpy(elem, slot, ring->elem_size);
+    ring_release_read(ring);
+    return true;
+}
+
+uint32_t ring_count(const ring_buffer_t *ring)
+{
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    return head - tail;
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "esp_err.h"
+#include "esp_attr.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// 单生产者/单消费者无锁环形缓冲区
+// head 只由生产者写、tail 只由消费者写，通过 release/acquire 保证槽位内容先于索引可见
+// 容量必须为 2 的幂，索引自由递增，用掩码取槽位
+typedef struct {
+    uint8_t *storage;
+    size_t elem_size;
+    uint32_t mask;
+    _Atomic uint32_t head;
+    _Atomic uint32_t tail;
+    uint32_t overruns;     // 生产者遇到缓冲区满的次数
+    uint32_t high_water;   // 历史最大占用
+} ring_buffer_t;
+
+esp_err_t ring_init(ring_buffer_t *ring, void *storage, size_t elem_size, uint32_t capacity);
+
+// 生产者：取得下一个空槽位直接填写，填完后 commit；缓冲区满时返回 NULL 并计入 overruns
+void *ring_claim_write(ring_buffer_t *ring);
+void ring_commit_write(ring_buffer_t *ring);
+
+// 消费者：取得最早的数据槽位直接读取，用完后 release；为空时返回 NULL
+void *ring_claim_read(ring_buffer_t *ring);
+void ring_release_read(ring_buffer_t *ring);
+
+// 拷贝式接口
+bool ring_push(ring_buffer_t *ring, const void *elem);
+bool ring_pop(ring_buffer_t *ring, void *elem);
+
+uint32_t ring_count(const ring_buffer_t *ring);
\ No newline at end of file
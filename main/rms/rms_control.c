@@ -0,0 +1,131 @@
+#include "rms_control.h"
+#include <math.h>
+#include <string.h>
+
+void rms_init(rms_handle_t *rms, const rms_config_t *cfg)
+{
+    if (!rms || !cfg) return;
+    memset(rms, 0, sizeof(*rms));
+    rms->cfg = *cfg;
+    if (rms->cfg.window == 0) rms->cfg.window = 1;
+    if (rms->cfg.cycles == 0) rms->cfg.cycles = 1;
+    if (rms->cfg.hysteresis <= 0) rms->cfg.hysteresis = RMS_DEFAULT_HYSTERESIS;
+    if (rms->cfg.max_window == 0) rms->cfg.max_window = RMS_DEFAULT_MAX_WINDOW;
+    if (rms->cfg.scale == 0.0f) rms->cfg.scale = 1.0f;
+    portMUX_INITIALIZE(&rms->lock);
+}
+
+static void rms_clear_sums(rms_handle_t *rms)
+{
+    rms->sum = 0;
+    rms->abs_sum = 0;
+    rms->sq_sum = 0;
+    rms->peak = 0;
+    rms->count = 0;
+    rms->cycle_count = 0;
+}
+
+void rms_reset(rms_handle_t *rms)
+{
+    if (!rms) return;
+    rms_clear_sums(rms);
+    rms->positive = false;
+    rms->started = false;
+}
+
+// 结算：整数累加量只在这里转为浮点，每个周期一次
+// 直流远大于交流时 Σx²/n 与 mean² 几乎相等，单精度相减会丢掉全部有效位，
+// 因此结算用双精度（Σx² 不超过 2^53 时转换无误差），每周期一次的软件双精度开销可忽略
+static void rms_finish(rms_handle_t *rms, bool synchronized)
+{
+    if (rms->count == 0) return;
+    double n = (double)rms->count;
+    float scale = rms->cfg.scale;
+    double mean = (double)rms->sum / n;
+    double mean_sq = (double)rms->sq_sum / n;
+    double ac_sq = mean_sq - mean * mean;
+
+    rms_result_t r;
+    r.rms = (float)sqrt(mean_sq) * scale;
+    r.ac_rms = (ac_sq > 0.0 ? (float)sqrt(ac_sq) : 0.0f) * scale;
+    r.mean = (float)mean * scale;
+    r.rectified_avg = (float)((double)rms->abs_sum / n) * scale;
+    r.peak = rms->peak * scale;
+    r.crest_factor = r.rms > 0.0f ? r.peak / r.rms : 0.0f;
+    r.frequency_hz = (synchronized && rms->cfg.sample_rate_hz > 0.0f)
+                   ? rms->cfg.sample_rate_hz * rms->cycle_count / (float)rms->count : 0.0f;
+    r.samples = rms->count;
+    r.synchronized = synchronized;
+
+    portENTER_CRITICAL_SAFE(&rms->lock);
+    r.sequence = rms->result.sequence + 1;
+    rms->result = r;
+    portEXIT_CRITICAL_SAFE(&rms->lock);
+
+    rms_clear_sums(rms);
+}
+
+bool rms_process_sample(rms_handle_t *rms, int32_t code)
+{
+    int32_t x = code - rms->cfg.offset;
+    bool done = false;
+
+    if (rms->cfg.mode == RMS_MODE_ZERO_CROSS) {
+        // 带迟滞的正向过零：先低于 -h 再高于 +h 才算一次
+        bool rising = false;
+        if (rms->positive) {
+            if (x < -rms->cfg.hysteresis) rms->positive = false;
+        } else if (x > rms->cfg.hysteresis) {
+            rms->positive = true;
+            rising = true;
+        }
+        if (rising) {
+            if (!rms->started) {
+                // 第一次过零之前的样本不计入，保证结算区间是整周期
+                rms->started = true;
+                rms_clear_sums(rms);
+            } else if (++rms->cycle_count >= rms->cfg.cycles) {
+                rms_finish(rms, true);
+                done = true;
+            }
+        }
+    }
+
+    uint32_t a = (uint32_t)(x < 0 ? -x : x);
+    rms->sum += x;
+    rms->abs_sum += a;
+    rms->sq_sum += (uint64_t)a * a;
+    if (a > rms->peak) rms->peak = a;
+    rms->count++;
+
+    if (rms->cfg.mode == RMS_MODE_WINDOW) {
+        if (rms->count >= rms->cfg.window) {
+            rms_finish(rms, false);
+            done = true;
+        }
+    } else if (rms->count >= rms->cfg.max_window) {
+        // 直流或频率过低时没有过零，按最大窗口结算并重新等待过零
+        rms_finish(rms, false);
+        rms->started = false;
+        done = true;
+    }
+    return done;
+}
+
+int rms_process_block(rms_handle_t *rms, const uint16_t *samples, int count, int stride)
+{
+    if (!rms || !samples || stride <= 0) return 0;
+    int results = 0;
+    for (int i = 0; i < count; i += stride) {
+        if (rms_process_sample(rms, samples[i])) results++;
+    }
+    return results;
+}
+
+void rms_get_result(rms_handle_t *rms, rms_result_t *result)
+{
+    if (!rms || !result) return;
+    portENTER_CRITICAL_SAFE(&rms->lock);
+    *result = rms->result;
+    portEXIT_CRITICAL_SAFE(&rms->lock);
+}
@@ -0,0 +1,67 @@
+// 流式真有效值检波模块头文件
+// 逐样本以整数累加 Σx、Σ|x|、Σx²，每个周期（过零同步）或固定窗口结束时以双精度结算一次
+
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define RMS_DEFAULT_HYSTERESIS   16      // 过零检测迟滞（码值），抑制零点附近噪声造成的误触发
+#define RMS_DEFAULT_MAX_WINDOW   65536   // 过零模式下无过零时强制结算的样本数
+
+typedef enum {
+    RMS_MODE_WINDOW = 0,     // 每 window 个样本结算一次
+    RMS_MODE_ZERO_CROSS,     // 每 cycles 个完整周期结算一次（正向过零到正向过零）
+} rms_mode_t;
+
+typedef struct {
+    rms_mode_t mode;
+    uint32_t window;         // 窗口模式的样本数
+    uint32_t cycles;         // 过零模式每次结算的周期数，0 视为 1
+    int32_t offset;          // 零点对应的码值，例如双极性 ADC 的中点
+    int32_t hysteresis;      // 0 使用 RMS_DEFAULT_HYSTERESIS
+    uint32_t max_window;     // 0 使用 RMS_DEFAULT_MAX_WINDOW
+    float scale;             // 每个码值对应的物理量，例如 V/LSB
+    float sample_rate_hz;    // 用于估算信号频率，0 时不计算
+} rms_config_t;
+
+typedef struct {
+    float rms;               // 真有效值（含直流）
+    float ac_rms;            // 去除直流后的有效值
+    float mean;              // 平均值（直流分量）
+    float rectified_avg;     // 整流平均值
+    float peak;              // 绝对值峰值
+    float crest_factor;      // 峰值 / 有效值
+    float frequency_hz;      // 过零模式下的信号频率，窗口模式或未同步时为 0
+    uint32_t samples;        // 参与本次结算的样本数
+    uint32_t sequence;       // 每次结算加一，用于判断是否有新结果
+    bool synchronized;       // 过零模式下本次结算是否由过零触发
+} rms_result_t;
+
+typedef struct {
+    rms_config_t cfg;
+    // 当前周期的累加量
+    int64_t sum;
+    uint64_t abs_sum;
+    uint64_t sq_sum;
+    uint32_t peak;
+    uint32_t count;
+    // 过零状态
+    bool positive;           // 带迟滞的符号
+    bool started;            // 已遇到第一次正向过零
+    uint32_t cycle_count;
+    rms_result_t result;
+    portMUX_TYPE lock;
+} rms_handle_t;
+
+void rms_init(rms_handle_t *rms, const rms_config_t *cfg);
+void rms_reset(rms_handle_t *rms);
+
+// 处理一个样本；返回 true 表示产生了新结果
+bool rms_process_sample(rms_handle_t *rms, int32_t code);
+// 处理交错样本块：从 samples[0] 开始每隔 stride 取一个，可直接消费多通道 ADC 块
+int rms_process_block(rms_handle_t *rms, const uint16_t *samples, int count, int stride);
+
+// 取最近一次结算结果（与处理任务并发调用安全）
+void rms_get_result(rms_handle_t *rms, rms_result_t *result);
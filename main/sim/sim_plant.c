@@ -0,0 +1,95 @@
+#include "sim_plant.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include <stdlib.h>
+#include <sys/stat.h>
+
+static portMUX_TYPE s_plant_lock = portMUX_INITIALIZER_UNLOCKED;
+static float s_duty = 0.0f;          // 0 ~ 1
+static uint32_t s_freq_hz = 20000;
+static float s_load_ohms = SIM_PLANT_LOAD_OHMS;
+static float s_vin = SIM_PLANT_VIN_V;
+static float s_il = 0.0f;            // 电感电流
+static float s_vc = 0.0f;            // 电容电压
+static int64_t s_last_us = 0;
+
+static float sim_plant_noise(void)
+{
+    return SIM_PLANT_NOISE_V * (2.0f * rand() / (float)RAND_MAX - 1.0f);
+}
+
+// 半隐式欧拉积分，调用方持有锁
+static void sim_plant_advance(void)
+{
+    int64_t now = esp_timer_get_time();
+    if (s_last_us == 0) s_last_us = now;
+    int64_t elapsed = now - s_last_us;
+    if (elapsed > SIM_PLANT_MAX_CATCHUP_US) elapsed = SIM_PLANT_MAX_CATCHUP_US;
+    const float dt = SIM_PLANT_STEP_US * 1e-6f;
+    for (int64_t t = 0; t < elapsed; t += SIM_PLANT_STEP_US) {
+        s_il += dt * (s_duty * s_vin - s_vc) / SIM_PLANT_L_H;
+        if (s_il < 0.0f) s_il = 0.0f;   // 断续模式下电感电流不反向
+        s_vc += dt * (s_il - s_vc / s_load_ohms) / SIM_PLANT_C_F;
+    }
+    s_last_us = now;
+}
+
+void sim_plant_set_duty(float duty_percent)
+{
+    if (duty_percent < 0.0f) duty_percent = 0.0f;
+    if (duty_percent > 100.0f) duty_percent = 100.0f;
+    portENTER_CRITICAL(&s_plant_lock);
+    sim_plant_advance();
+    s_duty = duty_percent / 100.0f;
+    portEXIT_CRITICAL(&s_plant_lock);
+}
+
+void sim_plant_set_freq(uint32_t freq_hz)
+{
+    if (freq_hz > 0) s_freq_hz = freq_hz;
+}
+
+void sim_plant_set_load(float ohms)
+{
+    if (ohms <= 0.0f) return;
+    portENTER_CRITICAL(&s_plant_lock);
+    sim_plant_advance();
+    s_load_ohms = ohms;
+    portEXIT_CRITICAL(&s_plant_lock);
+}
+
+void sim_plant_set_vin(float volts)
+{
+    if (volts < 0.0f) return;
+    portENTER_CRITICAL(&s_plant_lock);
+    sim_plant_advance();
+    s_vin = volts;
+    portEXIT_CRITICAL(&s_plant_lock);
+}
+
+void sim_plant_get(float *v_out, float *i_out)
+{
+    portENTER_CRITICAL(&s_plant_lock);
+    sim_plant_advance();
+    float v = s_vc;
+    float r = s_load_ohms;
+    portEXIT_CRITICAL(&s_plant_lock);
+    if (v_out) *v_out = v + sim_plant_noise();
+    if (i_out) *i_out = v / r;
+}
+
+float sim_plant_ripple_v(void)
+{
+    float f = (float)s_freq_hz;
+    return (1.0f - s_duty) * s_vc / (8.0f * SIM_PLANT_L_H * SIM_PLANT_C_F * f * f);
+}
+
+uint32_t sim_plant_freq(void)
+{
+    return s_freq_hz;
+}
+
+void sim_output_dir_init(void)
+{
+    mkdir(SIM_OUTPUT_DIR, 0755);
+}
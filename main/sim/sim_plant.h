@@ -0,0 +1,30 @@
+// Linux 主机仿真用的被控对象：同步 Buck 变换器带电阻负载的平均值模型
+// PWM 仿真写入占空比与开关频率，INA226 / ADC 仿真读出输出电压与电流，构成闭环
+
+#pragma once
+
+#include <stdint.h>
+
+// 仿真外设的输出目录：UART 管道、OLED 截图等
+#define SIM_OUTPUT_DIR          "/tmp/power-test-modules"
+
+#define SIM_PLANT_VIN_V         24.0f
+#define SIM_PLANT_L_H           47e-6f
+#define SIM_PLANT_C_F           220e-6f
+#define SIM_PLANT_LOAD_OHMS     10.0f
+#define SIM_PLANT_NOISE_V       0.002f     // 测量噪声幅度，用于检验滤波
+#define SIM_PLANT_STEP_US       2          // 积分步长
+#define SIM_PLANT_MAX_CATCHUP_US 50000     // 单次最多追赶的仿真时间，避免调试暂停后长时间卡住
+
+void sim_plant_set_duty(float duty_percent);
+void sim_plant_set_freq(uint32_t freq_hz);
+void sim_plant_set_load(float ohms);
+// 改变输入电压，用于检验前馈对输入阶跃的响应
+void sim_plant_set_vin(float volts);
+// 推进模型到当前时刻并返回输出电压 / 电流（含测量噪声）
+void sim_plant_get(float *v_out, float *i_out);
+// 输出电压纹波的峰峰值估计：ΔV = (1 - D) V / (8 L C f²)
+float sim_plant_ripple_v(void);
+uint32_t sim_plant_freq(void);
+// 创建 SIM_OUTPUT_DIR，可重复调用
+void sim_output_dir_init(void);
@@ -0,0 +1,34 @@
+// SPI 主机硬件抽象层：ESP-IDF 实现见 hal_spi_esp.c，Linux 主机仿真实现见 hal_spi_linux.c
+// Linux 下每个设备都是回环设备：MISO 返回 MOSI 的数据，队列事务入队即完成
+
+#pragma once
+
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if CONFIG_IDF_TARGET_LINUX
+typedef struct hal_spi_device *spi_device_handle_t;
+
+typedef struct {
+    const uint8_t *tx;
+    uint8_t *rx;
+    size_t len;
+    void *user;
+} hal_spi_trans_t;
+#else
+#include "driver/spi_master.h"
+
+typedef spi_transaction_t hal_spi_trans_t;
+#endif
+
+esp_err_t hal_spi_bus_init(int host, int sclk_io, int mosi_io, int miso_io, size_t max_transfer_size);
+esp_err_t hal_spi_device_add(int host, int cs_io, int clock_hz, uint8_t mode, int queue_size, spi_device_handle_t *handle);
+// 阻塞事务；polling 为真时忙等完成，不经过中断
+esp_err_t hal_spi_transfer(spi_device_handle_t handle, const uint8_t *tx, uint8_t *rx, size_t len, bool polling);
+// 队列事务：t 由调用方提供，保持有效直到 hal_spi_get_result 把它交回
+esp_err_t hal_spi_queue(spi_device_handle_t handle, hal_spi_trans_t *t, const uint8_t *tx, uint8_t *rx, size_t len, void *user);
+esp_err_t hal_spi_get_result(spi_device_handle_t handle, hal_spi_trans_t **t, void **user, TickType_t timeout);
@@ -0,0 +1,65 @@
+#include "hal_spi.h"
+#include <string.h>
+
+esp_err_t hal_spi_bus_init(int host, int sclk_io, int mosi_io, int miso_io, size_t max_transfer_size)
+{
+    spi_bus_config_t buscfg = {
+        .mosi_io_num = mosi_io,
+        .miso_io_num = miso_io,
+        .sclk_io_num = sclk_io,
+        .quadwp_io_num = -1,
+        .quadhd_io_num = -1,
+        .max_transfer_sz = max_transfer_size,
+    };
+    return spi_bus_initialize(host, &buscfg, SPI_DMA_CH_AUTO);
+}
+
+esp_err_t hal_spi_device_add(int host, int cs_io, int clock_hz, uint8_t mode, int queue_size, spi_device_handle_t *handle)
+{
+    spi_device_interface_config_t devcfg = {
+        .clock_speed_hz = clock_hz,
+        .mode = mode,
+        .spics_io_num = cs_io,
+        .queue_size = queue_size,
+    };
+    return spi_bus_add_device(host, &devcfg, handle);
+}
+
+esp_err_t hal_spi_transfer(spi_device_handle_t handle, const uint8_t *tx, uint8_t *rx, size_t len, bool polling)
+{
+    spi_transaction_t t = {
+        .length = len * 8,
+    };
+    if (len <= 4) {
+        // 数据直接放在事务结构体内，省去 DMA 描述符与缓冲区对齐
+        t.flags = (tx ? SPI_TRANS_USE_TXDATA : 0) | (rx ? SPI_TRANS_USE_RXDATA : 0);
+        if (tx) memcpy(t.tx_data, tx, len);
+    } else {
+        t.tx_buffer = tx;
+        t.rx_buffer = rx;
+    }
+    esp_err_t ret = polling ? spi_device_polling_transmit(handle, &t) : spi_device_transmit(handle, &t);
+    if (ret != ESP_OK) return ret;
+    if (rx && len <= 4) memcpy(rx, t.rx_data, len);
+    return ESP_OK;
+}
+
+esp_err_t hal_spi_queue(spi_device_handle_t handle, hal_spi_trans_t *t, const uint8_t *tx, uint8_t *rx, size_t len, void *user)
+{
+    memset(t, 0, sizeof(*t));
+    t->length = len * 8;
+    t->tx_buffer = tx;
+    t->rx_buffer = rx;
+    t->user = user;
+    return spi_device_queue_trans(handle, t, 0);
+}
+
+esp_err_t hal_spi_get_result(spi_device_handle_t handle, hal_spi_trans_t **t, void **user, TickType_t timeout)
+{
+    spi_transaction_t *done = NULL;
+    esp_err_t ret = spi_device_get_trans_result(handle, &done, timeout);
+    if (ret != ESP_OK) return ret;
+    *t = done;
+    if (user) *user = done->user;
+    return ESP_OK;
+}
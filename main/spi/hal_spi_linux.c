@@ -0,0 +1,76 @@
+#include "hal_spi.h"
+#include "esp_log.h"
+#include <string.h>
+
+#define HAL_SPI_SIM_DEVICES  8
+#define HAL_SPI_SIM_QUEUE    8   // 必须为 2 的幂
+
+static const char *TAG = "hal_spi";
+
+struct hal_spi_device {
+    int host;
+    int cs_io;
+    int queue_size;
+    hal_spi_trans_t *done[HAL_SPI_SIM_QUEUE];   // 已完成待取回的事务
+    uint32_t head;
+    uint32_t tail;
+};
+
+static struct hal_spi_device s_devices[HAL_SPI_SIM_DEVICES];
+static int s_device_count = 0;
+
+// 回环：有发送数据时原样返回，否则读到全 1（MISO 上拉）
+static void hal_spi_loopback(const uint8_t *tx, uint8_t *rx, size_t len)
+{
+    if (!rx) return;
+    if (tx) {
+        memmove(rx, tx, len);
+    } else {
+        memset(rx, 0xFF, len);
+    }
+}
+
+esp_err_t hal_spi_bus_init(int host, int sclk_io, int mosi_io, int miso_io, size_t max_transfer_size)
+{
+    ESP_LOGI(TAG, "Simulated SPI host %d (loopback)", host);
+    return ESP_OK;
+}
+
+esp_err_t hal_spi_device_add(int host, int cs_io, int clock_hz, uint8_t mode, int queue_size, spi_device_handle_t *handle)
+{
+    if (s_device_count >= HAL_SPI_SIM_DEVICES || queue_size > HAL_SPI_SIM_QUEUE) return ESP_ERR_NO_MEM;
+    struct hal_spi_device *dev = &s_devices[s_device_count++];
+    memset(dev, 0, sizeof(*dev));
+    dev->host = host;
+    dev->cs_io = cs_io;
+    dev->queue_size = queue_size;
+    *handle = dev;
+    return ESP_OK;
+}
+
+esp_err_t hal_spi_transfer(spi_device_handle_t handle, const uint8_t *tx, uint8_t *rx, size_t len, bool polling)
+{
+    if (!handle) return ESP_ERR_INVALID_ARG;
+    hal_spi_loopback(tx, rx, len);
+    return ESP_OK;
+}
+
+esp_err_t hal_spi_queue(spi_device_handle_t handle, hal_spi_trans_t *t, const uint8_t *tx, uint8_t *rx, size_t len, void *user)
+{
+    if (!handle) return ESP_ERR_INVALID_ARG;
+    if (handle->head - handle->tail >= (uint32_t)handle->queue_size) return ESP_ERR_TIMEOUT;
+    *t = (hal_spi_trans_t){ .tx = tx, .rx = rx, .len = len, .user = user };
+    hal_spi_loopback(tx, rx, len);
+    handle->done[handle->head++ & (HAL_SPI_SIM_QUEUE - 1)] = t;
+    return ESP_OK;
+}
+
+esp_err_t hal_spi_get_result(spi_device_handle_t handle, hal_spi_trans_t **t, void **user, TickType_t timeout)
+{
+    if (!handle) return ESP_ERR_INVALID_ARG;
+    // 事务入队即完成，队列为空说明没有在途事务，等待也不会有结果
+    if (handle->head == handle->tail) return ESP_ERR_TIMEOUT;
+    *t = handle->done[handle->tail++ & (HAL_SPI_SIM_QUEUE - 1)];
+    if (user) *user = (*t)->user;
+    return ESP_OK;
+}
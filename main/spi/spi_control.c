@@ -3,58 +3,132 @@
 #include "esp_timer.h"
 #include <string.h>
 
-#define SPI_CONTENT_BUFFER_SIZE 10
+#define SPI_CONTENT_BUFFER_SIZE 8   // 必须为 2 的幂
 
 static const char *TAG = "spi_control";
 static spi_content_t spi_content_buffer[SPI_CONTENT_BUFFER_SIZE];
-static volatile int spi_write_index = 0;
-static volatile int spi_read_index = 0;
-static volatile int spi_content_count = 0;
+static ring_buffer_t spi_content_ring;
+static bool spi_content_reading = false;
 
 static spi_device_handle_t opened_spi_handles[SPI_PORTS_MAX];
 static volatile int opened_spi_count = 0;
 static esp_timer_handle_t spi_timer;
 
+typedef struct {
+    spi_device_handle_t handle;
+    hal_spi_trans_t trans[SPI_QUEUE_DEPTH];
+    uint32_t free_mask;   // 空闲的事务槽位
+    int in_flight;
+} spi_device_ctx_t;
+
+static spi_device_ctx_t spi_devices[SPI_DEVICES_MAX];
+static int spi_device_count = 0;
+
+static spi_device_ctx_t *spi_find_device(spi_device_handle_t handle)
+{
+    for (int i = 0; i < spi_device_count; ++i) {
+        if (spi_devices[i].handle == handle) return &spi_devices[i];
+    }
+    return NULL;
+}
+
+void spi_bus_init(int host, int sclk_io, int mosi_io, int miso_io)
+{
+    ESP_ERROR_CHECK(hal_spi_bus_init(host, sclk_io, mosi_io, miso_io, SPI_MAX_TRANSFER_SIZE));
+}
+
+esp_err_t spi_device_add(int host, const spi_device_config_t *cfg, spi_device_handle_t *handle)
+{
+    if (!cfg || !handle || cfg->mode > 3) return ESP_ERR_INVALID_ARG;
+    if (spi_device_count >= SPI_DEVICES_MAX) {
+        ESP_LOGE(TAG, "Too many SPI devices");
+        return ESP_ERR_NO_MEM;
+    }
+    int queue_size = cfg->queue_size > 0 ? cfg->queue_size : SPI_QUEUE_DEPTH;
+    if (queue_size > SPI_QUEUE_DEPTH) queue_size = SPI_QUEUE_DEPTH;
+    int clock_hz = cfg->clock_speed_hz > 0 ? cfg->clock_speed_hz : SPI_DEFAULT_CLOCK_HZ;
+    esp_err_t ret = hal_spi_device_add(host, cfg->cs_io, clock_hz, cfg->mode, queue_size, handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to add SPI device: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    spi_device_ctx_t *ctx = &spi_devices[spi_device_count++];
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->handle = *handle;
+    ctx->free_mask = (1u << queue_size) - 1;
+    ESP_LOGI(TAG, "SPI device added: host=%d cs=%d clk=%d mode=%d queue=%d", host, cfg->cs_io, clock_hz, cfg->mode, queue_size);
+    return ESP_OK;
+}
+
 void spi_init(int host, int sclk_io, int mosi_io, int miso_io, int cs_io, spi_device_handle_t *handle)
 {
-    spi_bus_config_t buscfg = {
-        .mosi_io_num = mosi_io,
-        .miso_io_num = miso_io,
-        .sclk_io_num = sclk_io,
-        .quadwp_io_num = -1,
-        .quadhd_io_num = -1,
-        .max_transfer_sz = SPI_BUF_SIZE,
+    spi_bus_init(host, sclk_io, mosi_io, miso_io);
+    spi_device_config_t cfg = {
+        .cs_io = cs_io,
+        .clock_speed_hz = SPI_DEFAULT_CLOCK_HZ,
+        .mode = SPI_DEFAULT_MODE,
     };
-    ESP_ERROR_CHECK(spi_bus_initialize(host, &buscfg, SPI_DMA_CH_AUTO));
-    spi_device_interface_config_t devcfg = {
-        .clock_speed_hz = 10 * 1000 * 1000,
-        .mode = 0,
-        .spics_io_num = cs_io,
-        .queue_size = 3,
-    };
-    ESP_ERROR_CHECK(spi_bus_add_device(host, &devcfg, handle));
+    ESP_ERROR_CHECK(spi_device_add(host, &cfg, handle));
+}
+
+int spi_transfer_polling(spi_device_handle_t handle, const uint8_t *tx, uint8_t *rx, size_t len)
+{
+    esp_err_t ret = hal_spi_transfer(handle, tx, rx, len, true);
+    return (ret == ESP_OK) ? (int)len : -1;
+}
+
+// 设备有在途的队列事务时，阻塞/轮询事务会打乱结果顺序，直接拒绝
+static int spi_transfer_blocking(spi_device_handle_t handle, const uint8_t *tx, uint8_t *rx, size_t len)
+{
+    spi_device_ctx_t *ctx = spi_find_device(handle);
+    if (ctx && ctx->in_flight > 0) return -1;
+    if (len <= SPI_POLLING_MAX_BYTES) {
+        return spi_transfer_polling(handle, tx, rx, len);
+    }
+    esp_err_t ret = hal_spi_transfer(handle, tx, rx, len, false);
+    return (ret == ESP_OK) ? (int)len : -1;
 }
 
 int spi_write(spi_device_handle_t handle, const uint8_t *data, size_t len)
 {
-    spi_transaction_t t = {
-        .length = len * 8,
-        .tx_buffer = data,
-        .rx_buffer = NULL,
-    };
-    esp_err_t ret = spi_device_transmit(handle, &t);
-    return (ret == ESP_OK) ? len : -1;
+    return spi_transfer_blocking(handle, data, NULL, len);
 }
 
 int spi_read(spi_device_handle_t handle, uint8_t *data, size_t len)
 {
-    spi_transaction_t t = {
-        .length = len * 8,
-        .tx_buffer = NULL,
-        .rx_buffer = data,
-    };
-    esp_err_t ret = spi_device_transmit(handle, &t);
-    return (ret == ESP_OK) ? len : -1;
+    return spi_transfer_blocking(handle, NULL, data, len);
+}
+
+esp_err_t spi_queue_transfer(spi_device_handle_t handle, const uint8_t *tx, uint8_t *rx, size_t len, void *user)
+{
+    spi_device_ctx_t *ctx = spi_find_device(handle);
+    if (!ctx || len == 0 || len > SPI_MAX_TRANSFER_SIZE) return ESP_ERR_INVALID_ARG;
+    if (ctx->free_mask == 0) return ESP_ERR_NO_MEM;
+
+    int slot = __builtin_ctz(ctx->free_mask);
+    esp_err_t ret = hal_spi_queue(handle, &ctx->trans[slot], tx, rx, len, user);
+    if (ret != ESP_OK) return ret;
+    ctx->free_mask &= ~(1u << slot);
+    ctx->in_flight++;
+    return ESP_OK;
+}
+
+esp_err_t spi_get_result(spi_device_handle_t handle, void **user, TickType_t timeout)
+{
+    spi_device_ctx_t *ctx = spi_find_device(handle);
+    if (!ctx) return ESP_ERR_INVALID_ARG;
+    hal_spi_trans_t *t = NULL;
+    esp_err_t ret = hal_spi_get_result(handle, &t, user, timeout);
+    if (ret != ESP_OK) return ret;
+    ctx->free_mask |= 1u << (t - ctx->trans);
+    ctx->in_flight--;
+    return ESP_OK;
+}
+
+int spi_in_flight(spi_device_handle_t handle)
+{
+    spi_device_ctx_t *ctx = spi_find_device(handle);
+    return ctx ? ctx->in_flight : 0;
 }
 
 void spi_add_device(spi_device_handle_t handle)
@@ -68,20 +142,23 @@ void spi_timer_callback(void* arg)
 {
     for (int i = 0; i < opened_spi_count; ++i) {
         spi_device_handle_t handle = opened_spi_handles[i];
-        uint8_t data[SPI_BUF_SIZE] = {0};
-        int len = spi_read(handle, data, SPI_BUF_SIZE);
-        if (len > 0 && spi_content_count < SPI_CONTENT_BUFFER_SIZE) {
-            memcpy(spi_content_buffer[spi_write_index].data, data, len);
-            spi_content_buffer[spi_write_index].handle = handle;
-            spi_content_buffer[spi_write_index].length = len;
-            spi_write_index = (spi_write_index + 1) % SPI_CONTENT_BUFFER_SIZE;
-            spi_content_count++;
+        // 直接读入空槽位，读取失败时槽位不提交，下次复用
+        spi_content_t *slot = ring_claim_write(&spi_content_ring);
+        if (!slot) {
+            break;
+        }
+        int len = spi_read(handle, slot->data, SPI_BUF_SIZE);
+        if (len > 0) {
+            slot->handle = handle;
+            slot->length = len;
+            ring_commit_write(&spi_content_ring);
         }
     }
 }
 
 void spi_timer_service_start(void)
 {
+    ring_init(&spi_content_ring, spi_content_buffer, sizeof(spi_content_t), SPI_CONTENT_BUFFER_SIZE);
     const esp_timer_create_args_t timer_args = {
         .callback = &spi_timer_callback,
         .name = "spi_timer"
@@ -92,11 +169,11 @@ void spi_timer_service_start(void)
 
 spi_content_t* spi_read_buffer(void)
 {
-    if (spi_content_count <= 0) {
-        return NULL;
+    // 上一次返回的槽位此时才归还给生产者
+    if (spi_content_reading) {
+        ring_release_read(&spi_content_ring);
     }
-    spi_content_t* content = &spi_content_buffer[spi_read_index];
-    spi_read_index = (spi_read_index + 1) % SPI_CONTENT_BUFFER_SIZE;
-    spi_content_count--;
+    spi_content_t* content = ring_claim_read(&spi_content_ring);
+    spi_content_reading = (content != NULL);
     return content;
 }
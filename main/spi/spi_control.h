@@ -1,11 +1,25 @@
 #pragma once
 
-#include "driver/spi_master.h"
+#include "spi/hal_spi.h"
 #include <stdint.h>
 #include <stddef.h>
+#include "ring/ring_buffer.h"
 
 #define SPI_BUF_SIZE 256
 #define SPI_PORTS_MAX 2
+#define SPI_DEVICES_MAX 4
+#define SPI_MAX_TRANSFER_SIZE 4092      // 单次 DMA 事务上限
+#define SPI_QUEUE_DEPTH 4               // 每个设备同时在途的事务数
+#define SPI_POLLING_MAX_BYTES 32        // 不超过该长度的 spi_write/spi_read 走轮询路径
+#define SPI_DEFAULT_CLOCK_HZ (10 * 1000 * 1000)
+#define SPI_DEFAULT_MODE 0
+
+typedef struct {
+    int cs_io;
+    int clock_speed_hz;
+    uint8_t mode;        // SPI 模式 0~3（CPOL/CPHA）
+    int queue_size;      // 0 表示使用 SPI_QUEUE_DEPTH
+} spi_device_config_t;
 
 typedef struct {
     spi_device_handle_t handle;
@@ -13,9 +27,24 @@ typedef struct {
     int length;
 } spi_content_t;
 
+// 初始化总线并以默认时钟/模式挂载一个设备
 void spi_init(int host, int sclk_io, int mosi_io, int miso_io, int cs_io, spi_device_handle_t *handle);
+// 分开初始化总线与设备，同一总线可挂载多个不同时钟、模式的设备
+void spi_bus_init(int host, int sclk_io, int mosi_io, int miso_io);
+esp_err_t spi_device_add(int host, const spi_device_config_t *cfg, spi_device_handle_t *handle);
+
+// 阻塞读写，短事务自动走轮询路径以避免中断开销；设备有在途的队列事务时返回 -1
 int spi_write(spi_device_handle_t handle, const uint8_t *data, size_t len);
 int spi_read(spi_device_handle_t handle, uint8_t *data, size_t len);
+// 全双工轮询事务，len 不超过 4 字节时不使用 DMA 缓冲区
+int spi_transfer_polling(spi_device_handle_t handle, const uint8_t *tx, uint8_t *rx, size_t len);
+
+// 流水线事务：入队后立即返回，tx/rx 必须是 DMA 可访问内存，并保持有效直到取回结果
+// user 用于在 spi_get_result 中识别是哪一个事务完成
+esp_err_t spi_queue_transfer(spi_device_handle_t handle, const uint8_t *tx, uint8_t *rx, size_t len, void *user);
+esp_err_t spi_get_result(spi_device_handle_t handle, void **user, TickType_t timeout);
+int spi_in_flight(spi_device_handle_t handle);
 void spi_add_device(spi_device_handle_t handle);
 void spi_timer_service_start(void);
+// 返回的指针在下一次调用 spi_read_buffer 之前有效，只能由一个任务调用
 spi_content_t* spi_read_buffer(void);
@@ -0,0 +1,214 @@
+#include "spi_ads8688_driver.h"
+#include <inttypes.h>
+#include <math.h>
+#include <string.h>
+
+static const char *TAG = "ADS8688";
+
+static spi_device_handle_t s_ads8688_dev;
+static ads8688_config_t s_ads8688_cfg;
+static uint8_t s_seq[ADS8688_CHANNELS];   // 自动序列中的通道顺序
+static int s_seq_len = 0;
+static int s_seq_pos = 0;                 // 下一帧读出结果所属的序列位置
+
+static TaskHandle_t s_ads8688_task = NULL;
+static pwm_instance_t *s_ads8688_pwm = NULL;
+static ads8688_block_cb_t s_block_cb = NULL;
+static void *s_block_cb_arg = NULL;
+static volatile uint32_t s_trigger_count = 0;
+static volatile int64_t s_trigger_time_us = 0;
+// 上一帧结束（CS 上升沿）的时刻：ADS8688 在该沿采样，结果在下一帧读出，因此它就是下一帧读出结果的采样时刻
+static int64_t s_sample_time_us = 0;
+
+static uint16_t s_blocks[2][ADS8688_BLOCK_SIZE];
+static int s_block_index = 0;
+static int s_block_fill = 0;
+static int64_t s_block_time_us = 0;
+
+static uint16_t s_latest[ADS8688_CHANNELS];
+static int64_t s_latest_time_us[ADS8688_CHANNELS];
+static ads8688_stats_t s_stats;
+
+#if ADS8688_SIMULATED
+// 软件替身：各通道为不同频率的正弦加上开关纹波，幅度落在输入范围中部
+static uint16_t ads8688_sim_sample(int channel, int64_t t_us)
+{
+    float t = t_us * 1e-6f;
+    float v = 0.5f + 0.3f * sinf(2.0f * (float)M_PI * 50.0f * (channel + 1) * t)
+                   + 0.02f * sinf(2.0f * (float)M_PI * 20000.0f * t);
+    return (uint16_t)(v * 65535.0f);
+}
+#endif
+
+// 发送一帧 32 位命令，返回上一帧启动的转换结果
+static esp_err_t ads8688_frame(uint16_t cmd, uint16_t *result)
+{
+#if ADS8688_SIMULATED
+    if (result) *result = ads8688_sim_sample(s_seq[s_seq_pos], s_sample_time_us);
+    return ESP_OK;
+#else
+    uint8_t tx[4] = { cmd >> 8, cmd & 0xFF, 0, 0 };
+    uint8_t rx[4] = {0};
+    if (spi_transfer_polling(s_ads8688_dev, tx, rx, 4) != 4) {
+        return ESP_FAIL;
+    }
+    if (result) *result = ((uint16_t)rx[2] << 8) | rx[3];
+    return ESP_OK;
+#endif
+}
+
+static esp_err_t ads8688_write_reg(uint8_t reg, uint8_t value)
+{
+    return ads8688_frame(((uint16_t)reg << 9) | (1 << 8) | value, NULL);
+}
+
+esp_err_t ads8688_init(const ads8688_config_t *cfg)
+{
+    if (!cfg || cfg->channel_mask == 0) return ESP_ERR_INVALID_ARG;
+    s_ads8688_cfg = *cfg;
+    if (s_ads8688_cfg.trigger_divider == 0) s_ads8688_cfg.trigger_divider = 1;
+
+    s_seq_len = 0;
+    for (int ch = 0; ch < ADS8688_CHANNELS; ++ch) {
+        if (cfg->channel_mask & (1 << ch)) s_seq[s_seq_len++] = ch;
+    }
+
+#if !ADS8688_SIMULATED
+    spi_device_config_t dev_cfg = {
+        .cs_io = cfg->cs_io,
+        .clock_speed_hz = ADS8688_SPI_CLOCK_HZ,
+        .mode = ADS8688_SPI_MODE,
+    };
+    esp_err_t ret = spi_device_add(cfg->host, &dev_cfg, &s_ads8688_dev);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to add SPI device: %s", esp_err_to_name(ret));
+        return ret;
+    }
+#endif
+
+    esp_err_t err = ads8688_frame(ADS8688_CMD_RST, NULL);
+    if (err == ESP_OK) err = ads8688_write_reg(ADS8688_REG_AUTO_SEQ_EN, cfg->channel_mask);
+    for (int i = 0; i < s_seq_len && err == ESP_OK; ++i) {
+        err = ads8688_write_reg(ADS8688_REG_RANGE_CH(s_seq[i]), cfg->range);
+    }
+    // 进入自动序列模式，本帧启动序列中第一个通道的转换
+    if (err == ESP_OK) err = ads8688_frame(ADS8688_CMD_AUTO_RST, NULL);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to configure ADS8688");
+        return err;
+    }
+    s_sample_time_us = esp_timer_get_time();
+    s_seq_pos = 0;
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_stats.latency_min_us = UINT32_MAX;
+    ESP_LOGI(TAG, "ADS8688 initialized: channels=0x%02X range=%u divider=%" PRIu32 "%s",
+             cfg->channel_mask, cfg->range, s_ads8688_cfg.trigger_divider, ADS8688_SIMULATED ? " (simulated)" : "");
+    return ESP_OK;
+}
+
+// PWM 周期起点中断：分频后唤醒采集任务，并记录触发时刻作为样本时间戳
+static void IRAM_ATTR ads8688_pwm_trigger(void *arg)
+{
+    if (++s_trigger_count < s_ads8688_cfg.trigger_divider) return;
+    s_trigger_count = 0;
+    s_trigger_time_us = esp_timer_get_time();
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(s_ads8688_task, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+// 采样发生在每帧结束的 CS 上升沿，由任务发起，距触发的延迟含任务调度，逐帧测量计入统计
+static void ads8688_task(void *arg)
+{
+    while (1) {
+        uint32_t pending = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (pending > 1) s_stats.missed_triggers += pending - 1;
+        int64_t trigger_us = s_trigger_time_us;
+
+        // 每帧读出上一帧启动的转换结果，同时启动序列中下一个通道的转换；读出的结果在上一帧的 CS 上升沿采样
+        uint16_t code;
+        esp_err_t ret = ads8688_frame(ADS8688_CMD_NO_OP, &code);
+        int64_t edge_us = esp_timer_get_time();
+        int64_t t_us = s_sample_time_us;
+        s_sample_time_us = edge_us;
+        if (ret != ESP_OK) {
+            s_stats.spi_errors++;
+            continue;
+        }
+        uint32_t latency = (uint32_t)(edge_us - trigger_us);
+        if (latency < s_stats.latency_min_us) s_stats.latency_min_us = latency;
+        if (latency > s_stats.latency_max_us) s_stats.latency_max_us = latency;
+        s_stats.frames++;
+        int ch = s_seq[s_seq_pos];
+        s_seq_pos = (s_seq_pos + 1) % s_seq_len;
+        s_latest[ch] = code;
+        s_latest_time_us[ch] = t_us;
+
+        if (s_block_fill == 0) s_block_time_us = t_us;
+        s_blocks[s_block_index][s_block_fill++] = code;
+        if (s_block_fill == ADS8688_BLOCK_SIZE) {
+            // 交换缓冲区后再回调，回调期间新样本写入另一块
+            const uint16_t *done = s_blocks[s_block_index];
+            s_block_index ^= 1;
+            s_block_fill = 0;
+            s_stats.blocks++;
+            if (s_block_cb) s_block_cb(done, ADS8688_BLOCK_SIZE, s_block_time_us, s_block_cb_arg);
+        }
+    }
+}
+
+esp_err_t ads8688_start(pwm_instance_t *pwm, ads8688_block_cb_t cb, void *arg)
+{
+    if (!pwm || s_seq_len == 0) return ESP_ERR_INVALID_STATE;
+    s_block_cb = cb;
+    s_block_cb_arg = arg;
+    s_block_index = 0;
+    s_block_fill = 0;
+    if (!s_ads8688_task) {
+        xTaskCreatePinnedToCore(ads8688_task, "ads8688", ADS8688_TASK_STACK_SIZE, NULL, ADS8688_TASK_PRIORITY, &s_ads8688_task, APP_CORE_CONTROL);
+    }
+    s_ads8688_pwm = pwm;
+    pwm_set_period_callback(pwm, ads8688_pwm_trigger, NULL);
+    return ESP_OK;
+}
+
+void ads8688_stop(void)
+{
+    if (s_ads8688_pwm) {
+        pwm_set_period_callback(s_ads8688_pwm, NULL, NULL);
+        s_ads8688_pwm = NULL;
+    }
+}
+
+uint16_t ads8688_get_latest(int channel, int64_t *timestamp_us)
+{
+    if (channel < 0 || channel >= ADS8688_CHANNELS) return 0;
+    if (timestamp_us) *timestamp_us = s_latest_time_us[channel];
+    return s_latest[channel];
+}
+
+uint32_t ads8688_latency_us(void)
+{
+    if (!s_ads8688_pwm || s_ads8688_pwm->period_ticks == 0) return 0;
+    uint32_t period_us = (uint32_t)((uint64_t)s_ads8688_pwm->period_ticks * s_ads8688_cfg.trigger_divider * 1000000 / MCPWM_RESOLUTION_HZ);
+    uint32_t frame_us = 32 * 1000000 / ADS8688_SPI_CLOCK_HZ + 1;
+    // 采样沿之后还要等一个触发周期，下一帧才把结果读出
+    return period_us + s_stats.latency_max_us + frame_us;
+}
+
+float ads8688_code_to_volts(uint16_t code)
+{
+    switch (s_ads8688_cfg.range) {
+        case ADS8688_RANGE_BIPOLAR_2_5:   return ((int32_t)code - 32768) * (2.5f * ADS8688_VREF_V / 32768.0f);
+        case ADS8688_RANGE_BIPOLAR_1_25:  return ((int32_t)code - 32768) * (1.25f * ADS8688_VREF_V / 32768.0f);
+        case ADS8688_RANGE_BIPOLAR_0_625: return ((int32_t)code - 32768) * (0.625f * ADS8688_VREF_V / 32768.0f);
+        case ADS8688_RANGE_UNIPOLAR_2_5:  return code * (2.5f * ADS8688_VREF_V / 65536.0f);
+        case ADS8688_RANGE_UNIPOLAR_1_25: return code * (1.25f * ADS8688_VREF_V / 65536.0f);
+        default: return 0.0f;
+    }
+}
+
+void ads8688_get_stats(ads8688_stats_t *stats)
+{
+    if (stats) *stats = s_stats;
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+// ESP32 ADS8688 高速 SPI ADC 驱动头文件
+// ADS8688：16 位、8 通道、500 kSPS SAR ADC，SPI 模式 1，最高 17 MHz
+
+#pragma once
+
+#include "spi/spi_control.h"
+#include "pwm/pwm_control.h"
+#include "esp_log.h"
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdint.h>
+
+// 为 1 时不访问 SPI，由软件替身产生合成波形，便于在没有 ADC 硬件时验证采样链路；Linux 主机构建默认开启
+#ifndef ADS8688_SIMULATED
+#if CONFIG_IDF_TARGET_LINUX
+#define ADS8688_SIMULATED 1
+#else
+#define ADS8688_SIMULATED 0
+#endif
+#endif
+
+#define ADS8688_SPI_CLOCK_HZ   (17 * 1000 * 1000)
+#define ADS8688_SPI_MODE       1
+#define ADS8688_CHANNELS       8
+
+// 每帧 32 位：前 16 位为命令，后 16 位输出上一帧启动的转换结果
+#define ADS8688_CMD_NO_OP      0x0000  // 自动序列模式下继续转换下一个通道
+#define ADS8688_CMD_AUTO_RST   0xA000  // 进入自动序列模式，从序列中最小的通道开始
+#define ADS8688_CMD_RST        0x8500  // 软件复位
+#define ADS8688_CMD_MAN_CH(n)  (0xC000 | ((n) << 10))  // 手动选择通道 n
+
+// 程序寄存器：帧格式为 addr[15:9] WR[8] data[7:0]
+#define ADS8688_REG_AUTO_SEQ_EN  0x01  // 自动序列通道使能位图
+#define ADS8688_REG_RANGE_CH(n)  (0x05 + (n))  // 通道 n 输入范围
+
+// 输入范围编码（内部基准 Vref = 4.096 V）
+#define ADS8688_RANGE_BIPOLAR_2_5   0x00  // ±2.5 × Vref  = ±10.24 V
+#define ADS8688_RANGE_BIPOLAR_1_25  0x01  // ±1.25 × Vref = ±5.12 V
+#define ADS8688_RANGE_BIPOLAR_0_625 0x02  // ±0.625 × Vref = ±2.56 V
+#define ADS8688_RANGE_UNIPOLAR_2_5  0x05  // 0 ~ 2.5 × Vref = 10.24 V
+#define ADS8688_RANGE_UNIPOLAR_1_25 0x06  // 0 ~ 1.25 × Vref = 5.12 V
+#define ADS8688_VREF_V              4.096f
+
+#define ADS8688_BLOCK_SIZE      256   // 每块样本数（按通道交错），双缓冲
+#define ADS8688_TASK_STACK_SIZE 4096
+// 低于控制任务（configMAX_PRIORITIES - 3）：分频为 1、20 kHz 时每 50 us 唤醒一次，不能抢占 1 kHz 控制环；
+// 控制环运行期间到达的触发合并处理，计入 missed_triggers，样本时间戳仍按实际采样沿标记
+#define ADS8688_TASK_PRIORITY   (configMAX_PRIORITIES - 4)
+
+typedef struct {
+    int host;
+    int cs_io;
+    uint8_t channel_mask;     // 参与自动序列的通道
+    uint8_t range;            // 所有通道使用同一输入范围
+    uint32_t trigger_divider; // 每 N 个 PWM 周期触发一次转换，0 视为 1
+} ads8688_config_t;
+
+// 一块样本采满后在采集任务中调用：samples 按序列顺序交错，块在下一块采满前有效
+typedef void (*ads8688_block_cb_t)(const uint16_t *samples, int count, int64_t first_timestamp_us, void *arg);
+
+typedef struct {
+    uint32_t frames;          // 已完成的 SPI 帧
+    uint32_t missed_triggers; // 采集任务来不及处理而合并的触发
+    uint32_t spi_errors;
+    uint32_t blocks;
+    uint32_t latency_min_us;  // PWM 触发到采样沿（帧结束）的延迟，含采集任务的调度抖动
+    uint32_t latency_max_us;
+} ads8688_stats_t;
+
+esp_err_t ads8688_init(const ads8688_config_t *cfg);
+// 以 pwm 的周期起点为触发源开始连续采样，样本按块送给 cb
+// 触发中断唤醒采集任务发起 SPI 帧：ESP-IDF 的 SPI 主机驱动没有可在中断中调用的启动接口，采样沿相对触发
+// 有任务调度带来的抖动（见 latency_min_us/latency_max_us），但每个样本都标记实际的采样沿时刻
+esp_err_t ads8688_start(pwm_instance_t *pwm, ads8688_block_cb_t cb, void *arg);
+void ads8688_stop(void);
+
+// 最近一次转换结果及其采样时刻（启动该转换的那一帧的 CS 上升沿，而非读出时刻）
+uint16_t ads8688_get_latest(int channel, int64_t *timestamp_us);
+// 从触发到结果可用的最坏延迟：实测的最大触发-采样延迟、一个触发周期与一帧 SPI 传输
+uint32_t ads8688_latency_us(void);
+float ads8688_code_to_volts(uint16_t code);
+void ads8688_get_stats(ads8688_stats_t *stats);
\ No newline at end of file
@@ -0,0 +1,178 @@
+#include "stats_control.h"
+#include "i2c/i2c_control.h"
+#include "uart/uart_control.h"
+#include "esp_timer.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    const char *name;
+    const volatile uint32_t *counter;
+    bool rate;
+    uint32_t last;
+} stats_counter_t;
+
+static stats_counter_t s_counters[STATS_COUNTERS_MAX];
+static int s_counter_count = 0;
+static int64_t s_last_report_us = 0;
+// 最近一次 "stats" 生成的完整报告，后续页从这里取，不重新计算增量
+static char s_report[STATS_REPORT_SIZE];
+static size_t s_report_len = 0;
+
+#if configUSE_TRACE_FACILITY && configGENERATE_RUN_TIME_STATS
+#ifdef configRUN_TIME_COUNTER_TYPE
+typedef configRUN_TIME_COUNTER_TYPE stats_runtime_t;
+#else
+typedef uint32_t stats_runtime_t;
+#endif
+
+typedef struct {
+    UBaseType_t number;
+    stats_runtime_t runtime;
+} stats_task_prev_t;
+
+static TaskStatus_t s_tasks[STATS_TASKS_MAX];
+static stats_task_prev_t s_task_prev[STATS_TASKS_MAX];
+static int s_task_prev_count = 0;
+static stats_runtime_t s_total_prev = 0;
+#endif
+
+esp_err_t stats_register_counter(const char *name, const volatile uint32_t *counter, bool rate)
+{
+    if (!name || !counter) return ESP_ERR_INVALID_ARG;
+    if (s_counter_count >= STATS_COUNTERS_MAX) return ESP_ERR_NO_MEM;
+    s_counters[s_counter_count++] = (stats_counter_t){ .name = name, .counter = counter, .rate = rate };
+    return ESP_OK;
+}
+
+// 追加格式化文本，缓冲区写满后不再追加
+#define STATS_APPEND(...) do { \
+        if (len < size) { int n = snprintf(buf + len, size - len, __VA_ARGS__); if (n > 0) len += n; } \
+    } while (0)
+
+static void stats_report_tasks(char *buf, size_t size, size_t len)
+{
+#if configUSE_TRACE_FACILITY && configGENERATE_RUN_TIME_STATS
+    stats_runtime_t total = 0;
+    UBaseType_t count = uxTaskGetSystemState(s_tasks, STATS_TASKS_MAX, &total);
+    if (count == 0) {
+        STATS_APPEND("\r\ncpu n/a (more than %d tasks)", STATS_TASKS_MAX);
+        return;
+    }
+    // 运行时间计数器是单调的时间基准，不随核数累加，百分比以单个核心为 100%
+    stats_runtime_t elapsed = total - s_total_prev;
+    STATS_APPEND("\r\ncpu");
+    for (UBaseType_t i = 0; i < count; ++i) {
+        stats_runtime_t prev = 0;
+        for (int k = 0; k < s_task_prev_count; ++k) {
+            if (s_task_prev[k].number == s_tasks[i].xTaskNumber) {
+                prev = s_task_prev[k].runtime;
+                break;
+            }
+        }
+        float pct = elapsed ? 100.0f * (float)(s_tasks[i].ulRunTimeCounter - prev) / (float)elapsed : 0.0f;
+        STATS_APPEND(" %s=%.1f%%", s_tasks[i].pcTaskName, pct);
+    }
+    for (UBaseType_t i = 0; i < count; ++i) {
+        s_task_prev[i] = (stats_task_prev_t){ s_tasks[i].xTaskNumber, s_tasks[i].ulRunTimeCounter };
+    }
+    s_task_prev_count = count;
+    s_total_prev = total;
+#else
+    STATS_APPEND("\r\ncpu n/a (run-time stats disabled)");
+#endif
+}
+
+void stats_report(char *buf, size_t size)
+{
+    if (!buf || size == 0) return;
+    size_t len = 0;
+    buf[0] = '\0';
+    int64_t now = esp_timer_get_time();
+    float interval_s = (now - s_last_report_us) / 1e6f;
+    s_last_report_us = now;
+
+    STATS_APPEND("up=%.1fs dt=%.1fs", now / 1e6f, interval_s);
+    for (int i = 0; i < s_counter_count; ++i) {
+        stats_counter_t *c = &s_counters[i];
+        uint32_t value = *c->counter;
+        if (c->rate) {
+            STATS_APPEND(" %s=%.1fHz", c->name, interval_s > 0.0f ? (uint32_t)(value - c->last) / interval_s : 0.0f);
+        } else {
+            STATS_APPEND(" %s=%" PRIu32, c->name, value);
+        }
+        c->last = value;
+    }
+
+    i2c_stats_t i2c;
+    STATS_APPEND("\r\ni2c");
+    for (int i = 0; i2c_get_stats(i, &i2c); ++i) {
+        STATS_APPEND(" %d:0x%02X n=%" PRIu32 " err=%" PRIu32 " tmo=%" PRIu32, (int)i2c.i2c_num, i2c.addr, i2c.transactions,
+                     i2c.failures, i2c.timeouts);
+        if (i2c.failures) STATS_APPEND(" last=%s", esp_err_to_name(i2c.last_error));
+    }
+
+    uart_port_stats_t uart;
+    STATS_APPEND("\r\nuart");
+    for (int i = 0; uart_get_port_stats(i, &uart); ++i) {
+        STATS_APPEND(" %d:rx=%" PRIu32 " tx=%" PRIu32 " ovr=%" PRIu32 " drop=%" PRIu32, (int)uart.uart_num, uart.rx_bytes,
+                     uart.tx_bytes, uart.overruns, uart.dropped_lines);
+    }
+    uart_telemetry_stats_t tlm;
+    uart_telemetry_get_stats(&tlm);
+    STATS_APPEND(" tlm:pkt=%" PRIu32 " drop=%" PRIu32 "/%" PRIu32, tlm.packets_sent, tlm.samples_dropped,
+                 tlm.packets_dropped);
+
+    stats_report_tasks(buf, size, len);
+}
+
+// 从 start 起取一页，在空格或换行处断开，不把一项拆到两页；返回页尾，*next 为下一页起点
+static size_t stats_page_end(size_t start, size_t max, size_t *next)
+{
+    if (s_report_len - start <= max) {
+        *next = s_report_len;
+        return s_report_len;
+    }
+    size_t end = start + max;
+    while (end > start && s_report[end] != ' ' && s_report[end] != '\r') end--;
+    if (end == start) end = start + max;   // 单项超过一页，只能硬断开
+    *next = end;
+    while (*next < s_report_len && (s_report[*next] == ' ' || s_report[*next] == '\r' || s_report[*next] == '\n')) (*next)++;
+    return end;
+}
+
+// stats [页]：输出运行统计，频率与 CPU 占用为距上次查询的平均值；报告超过一页时分页返回
+static void cmd_stats(const char *args, char *reply, size_t reply_size)
+{
+    int page = atoi(args);
+    if (page <= 1 || s_report_len == 0) {
+        page = 1;
+        stats_report(s_report, sizeof(s_report));
+        s_report_len = strlen(s_report);
+    }
+    // 预留页码前缀的位置
+    const size_t max = reply_size > 32 ? reply_size - 32 : reply_size;
+    int pages = 0;
+    size_t start = 0, end = 0, next = 0, page_start = 0, page_end = 0;
+    while (start < s_report_len) {
+        end = stats_page_end(start, max, &next);
+        if (++pages == page) {
+            page_start = start;
+            page_end = end;
+        }
+        start = next;
+    }
+    if (page > pages) {
+        snprintf(reply, reply_size, "ERR page %d of %d", page, pages);
+        return;
+    }
+    int len = pages > 1 ? snprintf(reply, reply_size, "page %d/%d\r\n", page, pages) : 0;
+    snprintf(reply + len, reply_size - len, "%.*s", (int)(page_end - page_start), s_report + page_start);
+}
+
+void stats_register_commands(void)
+{
+    cmd_register_command("stats", cmd_stats);
+}
@@ -0,0 +1,28 @@
+// 运行统计模块头文件：把各模块的计数汇总成一份紧凑报告，经 "stats" 命令查询
+// 内容包括控制环与 PID 的实际频率、各 I2C 设备的事务/失败/超时、UART 收发字节与溢出，
+// 以及由 FreeRTOS 运行时间统计得到的各任务 CPU 占用；频率与占用都按两次查询之间的增量计算，
+// 现场只需隔一段时间查询两次即可判断板子是否异常，不需要调试器
+
+#pragma once
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "cmd/cmd_registry.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define STATS_COUNTERS_MAX   8
+#define STATS_TASKS_MAX      32    // uxTaskGetSystemState 的数组容量，任务数超过时不输出 CPU 占用
+#define STATS_REPORT_SIZE    2048  // 完整报告的缓冲区，"stats" 命令按 CMD_REPLY_SIZE 分页返回
+
+// 登记一个由其他模块维护的单调递增计数器；rate 为真时报告自上次查询以来的频率，否则报告累计值
+// name 与 counter 的生命周期须覆盖整个程序
+esp_err_t stats_register_counter(const char *name, const volatile uint32_t *counter, bool rate);
+
+// 生成报告，多行以 "\r\n" 分隔；同时更新频率与 CPU 占用的基准，只能由一个任务调用
+void stats_report(char *buf, size_t size);
+
+// 注册 "stats [页]" 命令：第 1 页（或不带参数）重新生成报告，其余页取同一份报告的后续部分
+void stats_register_commands(void);
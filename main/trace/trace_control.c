@@ -0,0 +1,198 @@
+#include "trace_control.h"
+
+#if CONFIG_APP_TRACE
+
+#include "cmd/cmd_registry.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#if CONFIG_IDF_TARGET_LINUX
+#include <time.h>
+#else
+#include "esp_cpu.h"
+#include "esp_private/esp_clk.h"
+#endif
+
+static const char *TAG = "TRACE";
+
+// 每个核心只有本核心的任务和中断写入，原子自增保证中断打断任务时各自拿到不同的槽位
+typedef struct {
+    _Atomic uint32_t head;
+    trace_event_t events[TRACE_RING_EVENTS];
+} trace_ring_t;
+
+static trace_ring_t s_rings[TRACE_CORES_MAX];
+static volatile bool s_enabled = true;
+// 任务编号表：第 n 个槽位对应编号 n + 1，只增不减（本工程的任务创建后不删除）
+static TaskHandle_t s_tasks[TRACE_TASKS_MAX];
+static _Atomic uint32_t s_task_count;
+
+static const char *const s_event_names[TRACE_EV_COUNT] = {
+#define TRACE_EVENT_NAME(id, name) [TRACE_EV_##id] = name,
+    TRACE_EVENT_LIST(TRACE_EVENT_NAME)
+#undef TRACE_EVENT_NAME
+};
+
+static inline uint32_t trace_cycles(void)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec);
+#else
+    return esp_cpu_get_cycle_count();
+#endif
+}
+
+static inline int trace_core_id(void)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    return 0;
+#else
+    return esp_cpu_get_core_id();
+#endif
+}
+
+static uint32_t trace_cycles_per_us(void)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    return 1000;
+#else
+    return esp_clk_cpu_freq() / 1000000;
+#endif
+}
+
+// 当前执行上下文的任务编号；任务数很少，线性查找只有几次比较。可能不被内联，因此同样放在 IRAM
+static inline IRAM_ATTR uint8_t trace_task_id(void)
+{
+#if !CONFIG_IDF_TARGET_LINUX
+    if (xPortInIsrContext()) return TRACE_TASK_ISR;
+#endif
+    TaskHandle_t cur = xTaskGetCurrentTaskHandle();
+    uint32_t n = atomic_load_explicit(&s_task_count, memory_order_acquire);
+    if (n >= TRACE_TASKS_MAX) n = TRACE_TASKS_MAX;
+    for (uint32_t i = 0; i < n; ++i) {
+        if (s_tasks[i] == cur) return (uint8_t)(i + 1);
+    }
+    if (n >= TRACE_TASKS_MAX) return TRACE_TASK_OTHER;
+    // 同一任务不会同时在两个核上运行，两个核同时登记的必然是不同任务，各自拿到不同的槽位
+    uint32_t slot = atomic_fetch_add_explicit(&s_task_count, 1, memory_order_relaxed);
+    if (slot >= TRACE_TASKS_MAX) return TRACE_TASK_OTHER;
+    s_tasks[slot] = cur;
+    return (uint8_t)(slot + 1);
+}
+
+void IRAM_ATTR trace_emit(uint16_t id, uint8_t type, int32_t value)
+{
+    if (!s_enabled) return;
+    uint8_t task = trace_task_id();
+    trace_ring_t *ring = &s_rings[trace_core_id()];
+    uint32_t seq = atomic_fetch_add_explicit(&ring->head, 1, memory_order_relaxed);
+    trace_event_t *e = &ring->events[seq & (TRACE_RING_EVENTS - 1)];
+    if ((seq & (TRACE_SYNC_INTERVAL - 1)) == 0) {
+        // 对时事件：主机端据此把周期计数换算到 esp_timer 时基，并对齐两个核心
+        e->cycles = trace_cycles();
+        e->id = TRACE_EV_SYNC;
+        e->type = TRACE_TYPE_SYNC;
+        e->task = task;
+        e->value = (int32_t)esp_timer_get_time();
+        seq = atomic_fetch_add_explicit(&ring->head, 1, memory_order_relaxed);
+        e = &ring->events[seq & (TRACE_RING_EVENTS - 1)];
+    }
+    e->cycles = trace_cycles();
+    e->id = id;
+    e->type = type;
+    e->task = task;
+    e->value = value;
+}
+
+void trace_enable(bool enable)
+{
+    s_enabled = enable;
+}
+
+void trace_clear(void)
+{
+    bool was_enabled = s_enabled;
+    s_enabled = false;
+    vTaskDelay(1);
+    for (int c = 0; c < TRACE_CORES_MAX; ++c) {
+        atomic_store(&s_rings[c].head, 0);
+    }
+    s_enabled = was_enabled;
+}
+
+int trace_dump(void)
+{
+    bool was_enabled = s_enabled;
+    s_enabled = false;
+    // 等正在写入的事件完成
+    vTaskDelay(1);
+
+    int total = 0;
+    printf("TRACE BEGIN cores=%d cycles_per_us=%" PRIu32 "\n", TRACE_CORES_MAX, trace_cycles_per_us());
+    for (int i = 0; i < TRACE_EV_COUNT; ++i) {
+        printf("TRACE NAME %d %s\n", i, s_event_names[i]);
+    }
+    uint32_t tasks = atomic_load(&s_task_count);
+    if (tasks > TRACE_TASKS_MAX) tasks = TRACE_TASKS_MAX;
+    printf("TRACE TASK %d isr\n", TRACE_TASK_ISR);
+    for (uint32_t i = 0; i < tasks; ++i) {
+        printf("TRACE TASK %" PRIu32 " %s\n", i + 1, s_tasks[i] ? pcTaskGetName(s_tasks[i]) : "?");
+    }
+    printf("TRACE TASK %d other\n", TRACE_TASK_OTHER);
+    for (int c = 0; c < TRACE_CORES_MAX; ++c) {
+        trace_ring_t *ring = &s_rings[c];
+        uint32_t head = atomic_load(&ring->head);
+        uint32_t count = head < TRACE_RING_EVENTS ? head : TRACE_RING_EVENTS;
+        // 每行：核心 序号 周期 类型 编号 值 任务
+        for (uint32_t seq = head - count; seq != head; ++seq) {
+            const trace_event_t *e = &ring->events[seq & (TRACE_RING_EVENTS - 1)];
+            printf("TRACE EV %d %" PRIu32 " %" PRIu32 " %u %u %" PRId32 " %u\n", c, seq, e->cycles,
+                   e->type, e->id, e->value, e->task);
+        }
+        total += count;
+    }
+    printf("TRACE END events=%d\n", total);
+    fflush(stdout);
+
+    s_enabled = was_enabled;
+    return total;
+}
+
+static void cmd_trace(const char *args, char *reply, size_t reply_size)
+{
+    while (*args == ' ') args++;
+    if (strncmp(args, "on", 2) == 0) {
+        trace_enable(true);
+        snprintf(reply, reply_size, "OK trace on");
+    } else if (strncmp(args, "off", 3) == 0) {
+        trace_enable(false);
+        snprintf(reply, reply_size, "OK trace off");
+    } else if (strncmp(args, "clear", 5) == 0) {
+        trace_clear();
+        snprintf(reply, reply_size, "OK trace cleared");
+    } else if (strncmp(args, "dump", 4) == 0) {
+        int n = trace_dump();
+        snprintf(reply, reply_size, "OK %d events", n);
+    } else {
+        int len = snprintf(reply, reply_size, "on=%d size=%d", s_enabled, TRACE_RING_EVENTS);
+        for (int c = 0; c < TRACE_CORES_MAX && len > 0 && (size_t)len < reply_size; ++c) {
+            len += snprintf(reply + len, reply_size - len, " core%d=%" PRIu32, c, atomic_load(&s_rings[c].head));
+        }
+    }
+}
+
+void trace_register_commands(void)
+{
+    ESP_LOGI(TAG, "Trace recorder: %d events/core, %u bytes", TRACE_RING_EVENTS, (unsigned)sizeof(s_rings));
+    cmd_register_command("trace", cmd_trace);
+}
+
+#endif
@@ -0,0 +1,90 @@
+// 事件追踪模块头文件
+// 各模块在关键路径上记录带时间戳的开始/结束/计数事件，写入按核心划分的无锁环形缓冲区，
+// 每个事件只是一次原子自增加几次存储（几十个周期）；缓冲区写满后覆盖最旧的事件，保留最近一段历史
+// "trace dump" 命令经控制台 UART 输出文本转储，用 tools/trace_to_chrome.py 转换为 Chrome trace JSON，
+// 可在 chrome://tracing 或 Perfetto 中查看
+// 未开启 CONFIG_APP_TRACE 时所有 TRACE_* 宏展开为空语句，不产生任何代码
+
+#pragma once
+
+#include "sdkconfig.h"
+#include "esp_attr.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define TRACE_RING_EVENTS     1024   // 每个核心的事件数，必须为 2 的幂
+#define TRACE_SYNC_INTERVAL   256    // 每隔多少个事件插入一次周期计数与 esp_timer 的对时事件，必须为 2 的幂
+#define TRACE_CORES_MAX       2
+#define TRACE_TASKS_MAX       14     // 按首次出现的顺序编号的任务数，超出的任务共用一个编号
+
+// 事件中的任务编号：中断上下文为 0，任务从 1 开始，超出 TRACE_TASKS_MAX 的任务记为 TRACE_TASK_OTHER
+#define TRACE_TASK_ISR        0
+#define TRACE_TASK_OTHER      (TRACE_TASKS_MAX + 1)
+
+// 事件编号与名称，新增追踪点时在此追加
+#define TRACE_EVENT_LIST(X)                      \
+    X(CONTROL,       "control_cycle")            \
+    X(PID,           "pid_tick")                 \
+    X(INA226_READ,   "ina226_read_all")          \
+    X(I2C,           "i2c_xfer")                 \
+    X(OLED_UPDATE,   "oled_update")              \
+    X(UART_CMD,      "uart_cmd")                 \
+    X(ADC_BLOCK,     "adc_block")                \
+    X(HARMONIC,      "harmonic_analyze")         \
+    X(DUTY,          "duty_pct_x100")            \
+    X(VBUS,          "vbus_mv")                  \
+    X(OVERRUN,       "control_overrun")          \
+    X(FAULT,         "protect_trip")
+
+typedef enum {
+#define TRACE_EVENT_ENUM(id, name) TRACE_EV_##id,
+    TRACE_EVENT_LIST(TRACE_EVENT_ENUM)
+#undef TRACE_EVENT_ENUM
+    TRACE_EV_COUNT,
+    TRACE_EV_SYNC = 0xFFFF,
+} trace_event_id_t;
+
+typedef enum {
+    TRACE_TYPE_BEGIN = 0,
+    TRACE_TYPE_END,
+    TRACE_TYPE_COUNTER,
+    TRACE_TYPE_INSTANT,
+    TRACE_TYPE_SYNC,       // value 为 esp_timer_get_time() 的低 32 位
+} trace_event_type_t;
+
+typedef struct {
+    uint32_t cycles;       // CPU 周期计数（Linux 主机构建为纳秒）
+    uint16_t id;
+    uint8_t type;
+    uint8_t task;          // 记录事件的任务编号，见 TRACE_TASK_ISR
+    int32_t value;
+} trace_event_t;
+
+#if CONFIG_APP_TRACE
+
+// 可在中断中调用；追踪关闭时立即返回
+void trace_emit(uint16_t id, uint8_t type, int32_t value);
+void trace_enable(bool enable);
+void trace_clear(void);
+// 暂停记录并把所有核心的事件以文本形式写到标准输出，完成后恢复原来的状态，返回事件数
+int trace_dump(void);
+// 注册 "trace" 命令：trace on|off|clear|dump，不带参数时输出状态
+void trace_register_commands(void);
+
+#define TRACE_BEGIN(ev)           trace_emit(TRACE_EV_##ev, TRACE_TYPE_BEGIN, 0)
+#define TRACE_BEGIN_ARG(ev, v)    trace_emit(TRACE_EV_##ev, TRACE_TYPE_BEGIN, (int32_t)(v))
+#define TRACE_END(ev)             trace_emit(TRACE_EV_##ev, TRACE_TYPE_END, 0)
+#define TRACE_COUNTER(ev, v)      trace_emit(TRACE_EV_##ev, TRACE_TYPE_COUNTER, (int32_t)(v))
+#define TRACE_INSTANT(ev, v)      trace_emit(TRACE_EV_##ev, TRACE_TYPE_INSTANT, (int32_t)(v))
+
+#else
+
+static inline void trace_register_commands(void) {}
+
+#define TRACE_BEGIN(ev)           do { } while (0)
+#define TRACE_BEGIN_ARG(ev, v)    do { } while (0)
+#define TRACE_END(ev)             do { } while (0)
+#define TRACE_COUNTER(ev, v)      do { } while (0)
+#define TRACE_INSTANT(ev, v)      do { } while (0)
+
+#endif
@@ -0,0 +1,40 @@
+// UART 硬件抽象层：ESP-IDF 实现见 hal_uart_esp.c，Linux 主机仿真实现见 hal_uart_linux.c
+// Linux 下 UART0 对应进程的标准输入输出，其余端口对应 SIM_OUTPUT_DIR 下的命名管道 uartN.rx / uartN.tx
+
+#pragma once
+
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if CONFIG_IDF_TARGET_LINUX
+typedef enum {
+    UART_NUM_0 = 0,
+    UART_NUM_1,
+    UART_NUM_2,
+    UART_NUM_3,
+    UART_NUM_4,
+    UART_NUM_MAX,
+} uart_port_t;
+#else
+#include "driver/uart.h"
+#endif
+
+#define HAL_UART_OVERFLOW  (-2)   // hal_uart_receive：接收溢出，已丢弃未读数据
+
+// 8N1 无流控；tx_io < 0 时不改引脚；tx_buf_size 为 0 时写入阻塞直到进入 FIFO；
+// line_events 为真时行结束符到达即唤醒接收方，不必等 RX 超时
+esp_err_t hal_uart_open(uart_port_t port, uint32_t baud, int tx_io, size_t tx_buf_size, bool line_events);
+// 等待数据到达，返回读到的字节数，超时返回 0，溢出返回 HAL_UART_OVERFLOW
+int hal_uart_receive(uart_port_t port, uint8_t *buf, size_t len, TickType_t timeout);
+int hal_uart_write(uart_port_t port, const uint8_t *data, size_t len);
+// 发送缓冲区剩余空间
+size_t hal_uart_tx_free(uart_port_t port);
+
+#if CONFIG_IDF_TARGET_LINUX
+// 仿真接收溢出：下一次 hal_uart_receive 返回 HAL_UART_OVERFLOW，用于测试上层的重新同步
+void hal_uart_sim_overflow(uart_port_t port);
+#endif
@@ -0,0 +1,78 @@
+#include "hal_uart.h"
+#include "freertos/queue.h"
+
+#define HAL_UART_RX_BUF_SIZE     512
+#define HAL_UART_EVENT_QUEUE_SIZE 20
+#define HAL_UART_LINE_TERMINATOR '\n'
+
+static QueueHandle_t s_event_queues[UART_NUM_MAX];
+
+esp_err_t hal_uart_open(uart_port_t port, uint32_t baud, int tx_io, size_t tx_buf_size, bool line_events)
+{
+    uart_config_t uart_config = {
+        .baud_rate = baud,
+        .data_bits = UART_DATA_8_BITS,
+        .parity    = UART_PARITY_DISABLE,
+        .stop_bits = UART_STOP_BITS_1,
+        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+        .source_clk = UART_SCLK_DEFAULT,
+    };
+    QueueHandle_t *queue = line_events ? &s_event_queues[port] : NULL;
+    esp_err_t ret = uart_driver_install(port, HAL_UART_RX_BUF_SIZE, tx_buf_size,
+                                        line_events ? HAL_UART_EVENT_QUEUE_SIZE : 0, queue, 0);
+    if (ret != ESP_OK) return ret;
+    ret = uart_param_config(port, &uart_config);
+    if (ret != ESP_OK) return ret;
+    ret = uart_set_pin(port, tx_io >= 0 ? tx_io : UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
+    if (ret != ESP_OK || !line_events) return ret;
+
+    // 行结束符触发模式检测中断
+    ret = uart_enable_pattern_det_baud_intr(port, HAL_UART_LINE_TERMINATOR, 1, 1, 0, 0);
+    if (ret != ESP_OK) return ret;
+    return uart_pattern_queue_reset(port, HAL_UART_EVENT_QUEUE_SIZE);
+}
+
+int hal_uart_receive(uart_port_t port, uint8_t *buf, size_t len, TickType_t timeout)
+{
+    QueueHandle_t queue = s_event_queues[port];
+    if (!queue) {
+        return uart_read_bytes(port, buf, len, timeout);
+    }
+    // 上次没读完的数据直接取走，不再等事件
+    size_t buffered = 0;
+    uart_get_buffered_data_len(port, &buffered);
+    if (buffered == 0) {
+        uart_event_t event;
+        if (xQueueReceive(queue, &event, timeout) != pdTRUE) return 0;
+        switch (event.type) {
+        case UART_PATTERN_DET:
+            // 位置队列只用于触发事件，行拼接由上层扫描
+            uart_pattern_pop_pos(port);
+            break;
+        case UART_DATA:
+            break;
+        case UART_FIFO_OVF:
+        case UART_BUFFER_FULL:
+            uart_flush_input(port);
+            xQueueReset(queue);
+            return HAL_UART_OVERFLOW;
+        default:
+            return 0;
+        }
+        uart_get_buffered_data_len(port, &buffered);
+    }
+    if (buffered == 0) return 0;
+    return uart_read_bytes(port, buf, buffered < len ? buffered : len, 0);
+}
+
+int hal_uart_write(uart_port_t port, const uint8_t *data, size_t len)
+{
+    return uart_write_bytes(port, data, len);
+}
+
+size_t hal_uart_tx_free(uart_port_t port)
+{
+    size_t tx_free = 0;
+    uart_get_tx_buffer_free_size(port, &tx_free);
+    return tx_free;
+}
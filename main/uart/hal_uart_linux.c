@@ -0,0 +1,98 @@
+#define _GNU_SOURCE
+#include "hal_uart.h"
+#include "sim/sim_plant.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char *TAG = "hal_uart";
+
+typedef struct {
+    int rx_fd;
+    int tx_fd;
+    size_t tx_buf_size;
+    volatile bool overflow;     // hal_uart_sim_overflow 置位，下一次接收时报告
+} hal_uart_port_t;
+
+static hal_uart_port_t s_ports[UART_NUM_MAX] = {
+    [0 ... UART_NUM_MAX - 1] = { .rx_fd = -1, .tx_fd = -1 },
+};
+
+// 以读写方式打开命名管道：自己也是写端，对端关闭后读取不会一直返回 EOF
+static int hal_uart_open_fifo(uart_port_t port, const char *dir)
+{
+    char path[96];
+    snprintf(path, sizeof(path), SIM_OUTPUT_DIR "/uart%d.%s", port, dir);
+    if (mkfifo(path, 0666) != 0 && errno != EEXIST) {
+        ESP_LOGE(TAG, "mkfifo %s: %d", path, errno);
+        return -1;
+    }
+    int fd = open(path, O_RDWR | O_NONBLOCK);
+    if (fd < 0) ESP_LOGE(TAG, "open %s: %d", path, errno);
+    return fd;
+}
+
+esp_err_t hal_uart_open(uart_port_t port, uint32_t baud, int tx_io, size_t tx_buf_size, bool line_events)
+{
+    if (port < 0 || port >= UART_NUM_MAX) return ESP_ERR_INVALID_ARG;
+    hal_uart_port_t *p = &s_ports[port];
+    if (p->rx_fd >= 0) return ESP_ERR_INVALID_STATE;
+    if (port == UART_NUM_0) {
+        p->rx_fd = STDIN_FILENO;
+        p->tx_fd = STDOUT_FILENO;
+        fcntl(p->rx_fd, F_SETFL, fcntl(p->rx_fd, F_GETFL) | O_NONBLOCK);
+    } else {
+        sim_output_dir_init();
+        p->rx_fd = hal_uart_open_fifo(port, "rx");
+        p->tx_fd = hal_uart_open_fifo(port, "tx");
+        if (p->rx_fd < 0 || p->tx_fd < 0) return ESP_FAIL;
+        ESP_LOGI(TAG, "UART%d -> %s/uart%d.{rx,tx}", port, SIM_OUTPUT_DIR, port);
+    }
+    p->tx_buf_size = tx_buf_size;
+    return ESP_OK;
+}
+
+int hal_uart_receive(uart_port_t port, uint8_t *buf, size_t len, TickType_t timeout)
+{
+    if (port < 0 || port >= UART_NUM_MAX || s_ports[port].rx_fd < 0) return -1;
+    // FreeRTOS 仿真层下任务不能阻塞在系统调用里，轮询并让出 CPU
+    TickType_t start = xTaskGetTickCount();
+    while (1) {
+        if (s_ports[port].overflow) {
+            s_ports[port].overflow = false;
+            return HAL_UART_OVERFLOW;
+        }
+        ssize_t n = read(s_ports[port].rx_fd, buf, len);
+        if (n > 0) return (int)n;
+        if (timeout != portMAX_DELAY && xTaskGetTickCount() - start >= timeout) return 0;
+        vTaskDelay(1);
+    }
+}
+
+int hal_uart_write(uart_port_t port, const uint8_t *data, size_t len)
+{
+    if (port < 0 || port >= UART_NUM_MAX || s_ports[port].tx_fd < 0) return -1;
+    ssize_t n = write(s_ports[port].tx_fd, data, len);
+    return n < 0 ? 0 : (int)n;   // 管道满（无人读取）时丢弃
+}
+
+void hal_uart_sim_overflow(uart_port_t port)
+{
+    if (port < 0 || port >= UART_NUM_MAX) return;
+    s_ports[port].overflow = true;
+}
+
+size_t hal_uart_tx_free(uart_port_t port)
+{
+    if (port < 0 || port >= UART_NUM_MAX || s_ports[port].tx_fd < 0) return 0;
+    if (port == UART_NUM_0) return s_ports[port].tx_buf_size;
+    int pending = 0;
+    int capacity = fcntl(s_ports[port].tx_fd, F_GETPIPE_SZ);
+    ioctl(s_ports[port].tx_fd, FIONREAD, &pending);
+    return capacity > pending ? (size_t)(capacity - pending) : 0;
+}
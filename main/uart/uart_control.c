@@ -1,67 +1,250 @@
 #include "uart_control.h"
 
-esp_timer_handle_t uart_timer;
-uint8_t *uart_data;
-uart_content_t uart_content_buffer[UART_CONTENT_BUFFER_SIZE];
-volatile int write_index = 0;
-volatile int read_index = 0;
-volatile int content_count = 0;
+static uart_port_ctx_t opened_uart_ports[UART_PORTS_MAX];
+static volatile int opened_uart_count = 0;
+static TaskHandle_t uart_notify_task = NULL;
+static uart_port_ctx_t *uart_reading_ctx = NULL;  // 上一次 uart_read 返回的槽位所属端口
+static int uart_read_port = 0;
 
-uart_port_t opened_uart_ports[UART_PORTS_MAX];
-volatile int opened_uart_count = 0;
+static uart_telemetry_sample_t telemetry_buffer[UART_TELEMETRY_QUEUE_SIZE];
+static ring_buffer_t telemetry_ring;
+static uart_port_t telemetry_uart_num;
+static TaskHandle_t telemetry_task = NULL;
+static uart_telemetry_stats_t telemetry_stats;
 
-void uart_timer_callback(void* arg)
+static void uart_feed_line(uart_port_ctx_t *ctx, const uint8_t *data, int len)
 {
-    for (int i = 0; i < opened_uart_count; ++i) {
-        uart_port_t uart_num = opened_uart_ports[i];
-        int len = uart_read_bytes(uart_num, uart_data, UART_BUF_SIZE - 1, 0);
-        if (len > 0 && content_count < UART_CONTENT_BUFFER_SIZE) {
-            memcpy(uart_content_buffer[write_index].data, uart_data, len);
-            uart_content_buffer[write_index].uart_num = uart_num;
-            uart_content_buffer[write_index].data[len] = '\0';
-            uart_content_buffer[write_index].length = len;
-            write_index = (write_index + 1) % UART_CONTENT_BUFFER_SIZE;
-            content_count++;
+    for (int i = 0; i < len; ++i) {
+        uint8_t c = data[i];
+        if (c == UART_LINE_TERMINATOR || c == '\r') {
+            // 兼容 \r\n，空行直接忽略；过长或无槽位可用的行整体丢弃
+            if (ctx->line_overflow) {
+                ctx->dropped_lines++;
+                if (ctx->line_slot) ctx->line_slot->length = 0;
+            } else if (ctx->line_slot && ctx->line_slot->length > 0) {
+                ctx->line_slot->data[ctx->line_slot->length] = '\0';
+                ctx->line_slot->uart_num = ctx->uart_num;
+                ring_commit_write(&ctx->rx_ring);
+                ctx->line_slot = NULL;
+                if (uart_notify_task) {
+                    xTaskNotifyGive(uart_notify_task);
+                }
+            }
+            ctx->line_overflow = false;
+            continue;
+        }
+        if (ctx->line_overflow) continue;
+        if (!ctx->line_slot) {
+            ctx->line_slot = ring_claim_write(&ctx->rx_ring);
+            if (!ctx->line_slot) {
+                ctx->line_overflow = true;
+                continue;
+            }
+            ctx->line_slot->length = 0;
+        }
+        if (ctx->line_slot->length < UART_BUF_SIZE - 1) {
+            ctx->line_slot->data[ctx->line_slot->length++] = c;
+        } else {
+            ctx->line_overflow = true;
         }
     }
 }
 
-void uart_timer_service_init(void)
+static void uart_rx_task(void *arg)
 {
-    uart_data = (uint8_t *) malloc(UART_BUF_SIZE);
-    const esp_timer_create_args_t timer_args = {
-        .callback = &uart_timer_callback,
-        .name = "uart_timer"
-    };
-    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &uart_timer));
-    ESP_ERROR_CHECK(esp_timer_start_periodic(uart_timer, UART_TIMER_INTERVAL_US));
+    uart_port_ctx_t *ctx = (uart_port_ctx_t *)arg;
+    uint8_t chunk[UART_BUF_SIZE];
+
+    while (1) {
+        int len = hal_uart_receive(ctx->uart_num, chunk, sizeof(chunk), portMAX_DELAY);
+        if (len == HAL_UART_OVERFLOW) {
+            // 驱动丢掉了行中间的数据，已拼接的开头与之后到达的行尾都不完整：
+            // 清空当前行并丢弃到下一个行结束符，重新同步到下一行
+            if (ctx->line_slot) ctx->line_slot->length = 0;
+            ctx->line_overflow = true;
+            ctx->overruns++;
+            continue;
+        }
+        if (len > 0) {
+            ctx->rx_bytes += len;
+            uart_feed_line(ctx, chunk, len);
+        }
+    }
 }
 
 void uart_init(uart_port_t uart_num)
 {
-    uart_config_t uart_config = {
-        .baud_rate = 115200,
-        .data_bits = UART_DATA_8_BITS,
-        .parity    = UART_PARITY_DISABLE,
-        .stop_bits = UART_STOP_BITS_1,
-        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
-        .source_clk = UART_SCLK_DEFAULT,
-    };
-    ESP_ERROR_CHECK(uart_driver_install(uart_num, UART_BUF_SIZE * 2, 0, 0, NULL, 0));
-    ESP_ERROR_CHECK(uart_param_config(uart_num, &uart_config));
-    ESP_ERROR_CHECK(uart_set_pin(uart_num, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE));
-    if (opened_uart_count < UART_PORTS_MAX) {
-        opened_uart_ports[opened_uart_count++] = uart_num;
+    if (opened_uart_count >= UART_PORTS_MAX) {
+        return;
+    }
+    uart_port_ctx_t *ctx = &opened_uart_ports[opened_uart_count];
+    ESP_ERROR_CHECK(hal_uart_open(uart_num, 115200, -1, 0, true));
+
+    ctx->uart_num = uart_num;
+    ring_init(&ctx->rx_ring, ctx->rx_slots, sizeof(uart_content_t), UART_CONTENT_BUFFER_SIZE);
+    ctx->line_slot = NULL;
+    ctx->line_overflow = false;
+    ctx->overruns = 0;
+    ctx->dropped_lines = 0;
+    ctx->rx_bytes = 0;
+    atomic_store_explicit(&ctx->tx_bytes, 0, memory_order_relaxed);
+    xTaskCreatePinnedToCore(uart_rx_task, "uart_rx", UART_RX_TASK_STACK_SIZE, ctx, UART_RX_TASK_PRIORITY, &ctx->rx_task, APP_CORE_UI);
+    opened_uart_count++;
+}
+
+int uart_write(uart_port_t uart_num, const uint8_t *data, size_t len)
+{
+    int written = hal_uart_write(uart_num, data, len);
+    for (int i = 0; i < opened_uart_count && written > 0; ++i) {
+        if (opened_uart_ports[i].uart_num == uart_num) {
+            atomic_fetch_add_explicit(&opened_uart_ports[i].tx_bytes, (uint32_t)written, memory_order_relaxed);
+            break;
+        }
     }
+    return written;
+}
+
+bool uart_get_port_stats(int index, uart_port_stats_t *stats)
+{
+    if (!stats || index < 0 || index >= opened_uart_count) return false;
+    const uart_port_ctx_t *ctx = &opened_uart_ports[index];
+    *stats = (uart_port_stats_t){
+        .uart_num = ctx->uart_num,
+        .rx_bytes = ctx->rx_bytes,
+        .tx_bytes = atomic_load_explicit(&ctx->tx_bytes, memory_order_relaxed),
+        .overruns = ctx->overruns,
+        .dropped_lines = ctx->dropped_lines,
+    };
+    return true;
+}
+
+void uart_set_notify_task(TaskHandle_t task)
+{
+    uart_notify_task = task;
 }
 
 uart_content_t* uart_read(void)
 {
-    if (content_count <= 0) {
-        return NULL;
+    // 上一次返回的槽位此时才归还给生产者，保证调用方使用期间不会被覆盖
+    if (uart_reading_ctx) {
+        ring_release_read(&uart_reading_ctx->rx_ring);
+        uart_reading_ctx = NULL;
     }
-    uart_content_t* cmd = &uart_content_buffer[read_index];
-    read_index = (read_index + 1) % UART_CONTENT_BUFFER_SIZE;
-    content_count--;
-    return cmd;
+    int count = opened_uart_count;
+    for (int n = 0; n < count; ++n) {
+        int idx = (uart_read_port + n) % count;
+        uart_content_t *cmd = ring_claim_read(&opened_uart_ports[idx].rx_ring);
+        if (cmd) {
+            uart_reading_ctx = &opened_uart_ports[idx];
+            uart_read_port = (idx + 1) % count;
+            return cmd;
+        }
+    }
+    return NULL;
+}
+
+// CRC-16/CCITT-FALSE
+static uint16_t telemetry_crc16(const uint8_t *data, size_t len)
+{
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; ++i) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int b = 0; b < 8; ++b) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+// COBS 编码，输出不含 0x00，返回编码后长度（不含帧分隔符）
+static size_t telemetry_cobs_encode(const uint8_t *src, size_t len, uint8_t *dst)
+{
+    size_t code_pos = 0;
+    size_t out = 1;
+    uint8_t code = 1;
+    for (size_t i = 0; i < len; ++i) {
+        if (src[i] == 0) {
+            dst[code_pos] = code;
+            code_pos = out++;
+            code = 1;
+        } else {
+            dst[out++] = src[i];
+            if (++code == 0xFF) {
+                dst[code_pos] = code;
+                code_pos = out++;
+                code = 1;
+            }
+        }
+    }
+    dst[code_pos] = code;
+    return out;
+}
+
+static void uart_telemetry_task(void *arg)
+{
+    // 包格式：type(1) seq(2) count(1) samples(count * 12) crc16(2)
+    static uint8_t raw[4 + UART_TELEMETRY_SAMPLES_PER_PACKET * sizeof(uart_telemetry_sample_t) + 2];
+    static uint8_t frame[sizeof(raw) + sizeof(raw) / 254 + 2];
+    uint16_t seq = 0;
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(UART_TELEMETRY_FLUSH_MS));
+        int n;
+        while ((n = ring_count(&telemetry_ring)) > 0) {
+            if (n > UART_TELEMETRY_SAMPLES_PER_PACKET) n = UART_TELEMETRY_SAMPLES_PER_PACKET;
+
+            raw[0] = UART_TELEMETRY_PACKET_TYPE;
+            raw[1] = seq & 0xFF;
+            raw[2] = seq >> 8;
+            raw[3] = (uint8_t)n;
+            size_t pos = 4;
+            for (int i = 0; i < n; ++i) {
+                ring_pop(&telemetry_ring, &raw[pos]);
+                pos += sizeof(uart_telemetry_sample_t);
+            }
+            uint16_t crc = telemetry_crc16(raw, pos);
+            raw[pos++] = crc & 0xFF;
+            raw[pos++] = crc >> 8;
+
+            size_t frame_len = telemetry_cobs_encode(raw, pos, frame);
+            frame[frame_len++] = 0x00;
+            seq++;
+
+            // 发送缓冲区不够时丢包而不是阻塞，主机端通过 seq 断号发现丢包
+            if (hal_uart_tx_free(telemetry_uart_num) < frame_len) {
+                telemetry_stats.packets_dropped++;
+                continue;
+            }
+            hal_uart_write(telemetry_uart_num, frame, frame_len);
+            telemetry_stats.packets_sent++;
+        }
+    }
+}
+
+void uart_telemetry_init(uart_port_t uart_num, int tx_io)
+{
+    // 大容量 TX 环形缓冲区：写入只做拷贝，由驱动中断在后台搬运到 FIFO
+    ESP_ERROR_CHECK(hal_uart_open(uart_num, UART_TELEMETRY_BAUD, tx_io, UART_TELEMETRY_TX_BUF_SIZE, false));
+
+    telemetry_uart_num = uart_num;
+    memset(&telemetry_stats, 0, sizeof(telemetry_stats));
+    ring_init(&telemetry_ring, telemetry_buffer, sizeof(uart_telemetry_sample_t), UART_TELEMETRY_QUEUE_SIZE);
+    xTaskCreatePinnedToCore(uart_telemetry_task, "uart_telemetry", UART_TELEMETRY_TASK_STACK_SIZE, NULL, UART_TELEMETRY_TASK_PRIORITY, &telemetry_task, APP_CORE_UI);
+}
+
+void uart_telemetry_push(const uart_telemetry_sample_t *sample)
+{
+    if (!telemetry_task) return;
+    if (!ring_push(&telemetry_ring, sample)) return;
+    telemetry_stats.samples_queued++;
+    if (ring_count(&telemetry_ring) == UART_TELEMETRY_SAMPLES_PER_PACKET) {
+        xTaskNotifyGive(telemetry_task);
+    }
+}
+
+void uart_telemetry_get_stats(uart_telemetry_stats_t *stats)
+{
+    if (!stats) return;
+    *stats = telemetry_stats;
+    stats->samples_dropped = telemetry_ring.overruns;
 }
\ No newline at end of file
@@ -1,14 +1,32 @@
 #pragma once
 
-#include "driver/uart.h"
-#include "esp_timer.h"
+#include "uart/hal_uart.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include <string.h>
 #include "global_params.h"
+#include "ring/ring_buffer.h"
+#include <stdatomic.h>
 
 #define UART_BUF_SIZE 256
-#define UART_CONTENT_BUFFER_SIZE 10
-#define UART_TIMER_INTERVAL_US 50000
+#define UART_CONTENT_BUFFER_SIZE 8   // 每个端口的行缓冲深度，必须为 2 的幂
 #define UART_PORTS_MAX 6
+#define UART_RX_TASK_STACK_SIZE 3072
+#define UART_RX_TASK_PRIORITY 10
+#define UART_LINE_TERMINATOR '\n'   // 与 hal_uart 的模式检测字符一致
+
+// 二进制遥测通道：COBS 成帧，0x00 为帧分隔符
+// 样本由控制任务每个控制周期推送一次，实际速率等于控制频率（1 kHz），不是开关频率；其中电压、电流来自
+// INA226，新值的更新间隔为其转换周期（默认配置约 2.2 ms），相邻样本可能重复。2 Mbaud 链路约可承载
+// 16k 样本/s，瓶颈在数据源而不在串口
+#define UART_TELEMETRY_BAUD              2000000
+#define UART_TELEMETRY_TX_BUF_SIZE       8192
+#define UART_TELEMETRY_QUEUE_SIZE        256   // 样本缓冲深度，必须为 2 的幂
+#define UART_TELEMETRY_SAMPLES_PER_PACKET 16
+#define UART_TELEMETRY_PACKET_TYPE       0x01
+#define UART_TELEMETRY_FLUSH_MS          10    // 不满一包时的最长等待时间
+#define UART_TELEMETRY_TASK_STACK_SIZE   4096
+#define UART_TELEMETRY_TASK_PRIORITY     5
 
 typedef struct {
     uart_port_t uart_num;
@@ -16,7 +34,56 @@ typedef struct {
     int length;
 } uart_content_t;
 
-void uart_timer_callback(void* arg);
-void uart_timer_service_init(void);
+// 每个端口一个接收任务，阻塞在 hal_uart_receive 上，直接在环形缓冲区的槽位中拼接整行
+typedef struct {
+    uart_port_t uart_num;
+    TaskHandle_t rx_task;
+    ring_buffer_t rx_ring;
+    uart_content_t rx_slots[UART_CONTENT_BUFFER_SIZE];
+    uart_content_t *line_slot;  // 正在拼接的行所在槽位，尚未提交
+    bool line_overflow;
+    uint32_t overruns;       // 驱动 FIFO/缓冲区溢出次数
+    uint32_t dropped_lines;  // 行过长或命令缓冲区满而丢弃的行数
+    uint32_t rx_bytes;
+    _Atomic uint32_t tx_bytes;  // 经 uart_write 发出的字节数，多个任务都会写同一端口，原子累加
+} uart_port_ctx_t;
+
+typedef struct {
+    uart_port_t uart_num;
+    uint32_t rx_bytes;
+    uint32_t tx_bytes;
+    uint32_t overruns;
+    uint32_t dropped_lines;
+} uart_port_stats_t;
+
+// 一个遥测样本，小端序紧凑存储，主机端按相同布局解码（见 tools/telemetry_decode.py）
+typedef struct __attribute__((packed)) {
+    uint32_t timestamp_us;     // esp_timer_get_time() 低 32 位
+    uint16_t bus_voltage_mv;   // 总线电压，1 mV/bit
+    int16_t current_01ma;      // 电流，0.1 mA/bit，与 INA226 的 Current_LSB 一致
+    uint16_t duty_001;         // PWM 占空比，0.01 %/bit
+    uint16_t setpoint_mv;      // 目标电压，1 mV/bit
+} uart_telemetry_sample_t;
+
+typedef struct {
+    uint32_t samples_queued;
+    uint32_t samples_dropped;  // 样本缓冲区满而丢弃
+    uint32_t packets_sent;
+    uint32_t packets_dropped;  // 驱动发送缓冲区空间不足而丢弃
+} uart_telemetry_stats_t;
+
 void uart_init(uart_port_t uart_num);
-uart_content_t* uart_read(void);
\ No newline at end of file
+// 取出下一行命令，返回的指针在下一次调用 uart_read 之前有效，只能由一个任务调用
+uart_content_t* uart_read(void);
+int uart_write(uart_port_t uart_num, const uint8_t *data, size_t len);
+// 设置后每收到完整的一行就通知该任务，消费者可用 ulTaskNotifyTake 阻塞等待
+void uart_set_notify_task(TaskHandle_t task);
+
+// 取第 index 个命令端口的收发统计，不存在时返回 false
+bool uart_get_port_stats(int index, uart_port_stats_t *stats);
+
+// 在 uart_num 上开启遥测输出（只用 TX 引脚），后台任务打包并发送
+void uart_telemetry_init(uart_port_t uart_num, int tx_io);
+// 放入一个样本，不阻塞；缓冲区满时丢弃并计数
+void uart_telemetry_push(const uart_telemetry_sample_t *sample);
+void uart_telemetry_get_stats(uart_telemetry_stats_t *stats);
\ No newline at end of file
@@ -0,0 +1,68 @@
+#!/usr/bin/env python3
+"""提取并对比 bench_control 输出的基准结果。
+
+用法:
+    python tools/bench_compare.py run.log                       # 列出一次运行的结果
+    python tools/bench_compare.py base.log new.log              # 对比两次运行，中位数变慢超过阈值时返回 1
+    python tools/bench_compare.py base.log new.log --threshold 5
+
+输入为串口日志或 Linux 主机构建的标准输出，只解析以 "BENCH " 开头的行：
+    BENCH name=<用例> n=<次数> cyc_min= cyc_med= cyc_p99= us_min= us_med= us_p99= [sps=]
+sps 只出现在按块处理样本的用例中，为每秒样本数。
+"""
+
+import argparse
+import sys
+
+FIELDS = ("cyc_min", "cyc_med", "cyc_p99", "us_min", "us_med", "us_p99", "sps")
+
+
+def parse(path):
+    results = {}
+    with open(path, encoding="utf-8", errors="replace") as f:
+        for line in f:
+            pos = line.find("BENCH ")
+            if pos < 0:
+                continue
+            kv = dict(item.split("=", 1) for item in line[pos + 6:].split() if "=" in item)
+            if "name" not in kv:
+                continue
+            results[kv["name"]] = {k: int(kv[k]) for k in FIELDS if k in kv}
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("base", help="基准日志")
+    parser.add_argument("new", nargs="?", help="待对比的日志")
+    parser.add_argument("--threshold", type=float, default=10.0, help="判定为退化的中位数增幅（%%），默认 10")
+    args = parser.parse_args()
+
+    base = parse(args.base)
+    if not base:
+        sys.exit("no BENCH lines in " + args.base)
+    if args.new is None:
+        print("name," + ",".join(FIELDS))
+        for name, r in base.items():
+            print(name + "," + ",".join(str(r.get(k, "")) for k in FIELDS))
+        return 0
+
+    new = parse(args.new)
+    regressed = False
+    print(f"{'name':<20} {'base_med':>10} {'new_med':>10} {'delta':>8} {'base_p99':>10} {'new_p99':>10}")
+    for name in sorted(set(base) | set(new)):
+        b, n = base.get(name), new.get(name)
+        if not b or not n:
+            print(f"{name:<20} {'missing in ' + ('new' if b else 'base'):>10}")
+            continue
+        delta = (n["cyc_med"] - b["cyc_med"]) * 100.0 / b["cyc_med"] if b["cyc_med"] else 0.0
+        flag = ""
+        if delta > args.threshold:
+            flag = "  REGRESSION"
+            regressed = True
+        print(f"{name:<20} {b['cyc_med']:>10} {n['cyc_med']:>10} {delta:>7.1f}% {b['cyc_p99']:>10} {n['cyc_p99']:>10}{flag}")
+    return 1 if regressed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+"""解码 uart_telemetry 二进制遥测流并输出 CSV。
+
+用法:
+    python tools/telemetry_decode.py /dev/ttyUSB1 -o run.csv            # 直接读串口（需要 pyserial）
+    python tools/telemetry_decode.py capture.bin -o run.csv --file      # 解码已保存的原始数据
+
+帧格式与 main/uart/uart_control.c 保持一致：
+    COBS(type:u8 seq:u16 count:u8 samples[count] crc16:u16) 0x00
+    sample = timestamp_us:u32 bus_voltage_mv:u16 current_01ma:i16 duty_001:u16 setpoint_mv:u16
+
+固件每个控制周期推送一个样本（1 kHz）；电压与电流来自 INA226，只在每个转换周期（默认约 2.2 ms）
+更新一次，相邻样本可能重复。
+"""
+
+import argparse
+import csv
+import struct
+import sys
+
+PACKET_TYPE = 0x01
+HEADER = struct.Struct("<BHB")
+SAMPLE = struct.Struct("<IHhHH")
+BAUD = 2000000
+
+
+def crc16_ccitt(data):
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_decode(frame):
+    out = bytearray()
+    i = 0
+    while i < len(frame):
+        code = frame[i]
+        if code == 0 or i + code > len(frame) + 1:
+            raise ValueError("bad COBS frame")
+        out += frame[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(frame):
+            out.append(0)
+    return bytes(out)
+
+
+class Decoder:
+    def __init__(self, writer):
+        self.writer = writer
+        self.pending = bytearray()
+        self.last_seq = None
+        self.packets = 0
+        self.samples = 0
+        self.lost_packets = 0
+        self.bad_frames = 0
+
+    def feed(self, data):
+        self.pending += data
+        while True:
+            end = self.pending.find(b"\x00")
+            if end < 0:
+                return
+            frame = bytes(self.pending[:end])
+            del self.pending[:end + 1]
+            if frame:
+                self._handle(frame)
+
+    def _handle(self, frame):
+        try:
+            raw = cobs_decode(frame)
+        except ValueError:
+            self.bad_frames += 1
+            return
+        if len(raw) < HEADER.size + 2 or crc16_ccitt(raw[:-2]) != struct.unpack_from("<H", raw, len(raw) - 2)[0]:
+            self.bad_frames += 1
+            return
+        ptype, seq, count = HEADER.unpack_from(raw)
+        if ptype != PACKET_TYPE or len(raw) != HEADER.size + count * SAMPLE.size + 2:
+            self.bad_frames += 1
+            return
+        if self.last_seq is not None:
+            self.lost_packets += (seq - self.last_seq - 1) & 0xFFFF
+        self.last_seq = seq
+        self.packets += 1
+        for i in range(count):
+            ts, v_mv, i_01ma, duty, sp_mv = SAMPLE.unpack_from(raw, HEADER.size + i * SAMPLE.size)
+            self.writer.writerow([ts, v_mv / 1000.0, i_01ma / 10.0, duty / 100.0, sp_mv / 1000.0])
+            self.samples += 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("source", help="串口设备或原始数据文件")
+    parser.add_argument("-o", "--output", help="CSV 输出路径，默认 stdout")
+    parser.add_argument("--file", action="store_true", help="source 是文件而不是串口")
+    parser.add_argument("--baud", type=int, default=BAUD)
+    args = parser.parse_args()
+
+    out = open(args.output, "w", newline="") if args.output else sys.stdout
+    writer = csv.writer(out)
+    writer.writerow(["timestamp_us", "bus_voltage_v", "current_ma", "duty_percent", "setpoint_v"])
+    decoder = Decoder(writer)
+
+    try:
+        if args.file:
+            with open(args.source, "rb") as f:
+                while True:
+                    chunk = f.read(65536)
+                    if not chunk:
+                        break
+                    decoder.feed(chunk)
+        else:
+            import serial
+            with serial.Serial(args.source, args.baud, timeout=0.1) as port:
+                while True:
+                    decoder.feed(port.read(4096))
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if out is not sys.stdout:
+            out.close()
+        print(f"packets={decoder.packets} samples={decoder.samples} "
+              f"lost_packets={decoder.lost_packets} bad_frames={decoder.bad_frames}", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,157 @@
+#!/usr/bin/env python3
+"""把 "trace dump" 的文本转储转换为 Chrome trace JSON（chrome://tracing 或 https://ui.perfetto.dev 打开）。
+
+用法:
+    python tools/trace_to_chrome.py capture.log -o trace.json
+
+输入为包含转储的串口日志或 Linux 主机构建的标准输出，格式与 main/trace/trace_control.c 保持一致：
+    TRACE BEGIN cores=<n> cycles_per_us=<f>
+    TRACE NAME <id> <name>
+    TRACE TASK <task> <name>
+    TRACE EV <core> <seq> <cycles> <type> <id> <value> <task>
+    TRACE END events=<n>
+type: 0 开始 1 结束 2 计数 3 瞬时 4 对时（value 为 esp_timer 微秒的低 32 位）
+task: 0 为中断上下文，其余为按首次出现顺序编号的任务；每个任务一条时间线（tid），
+中断按核心各占一条，被抢占任务的开始/结束不会和抢占它的任务交错在同一条时间线上。
+旧格式没有 task 字段时退回按核心划分。
+"""
+
+import argparse
+import json
+import sys
+
+TYPE_BEGIN, TYPE_END, TYPE_COUNTER, TYPE_INSTANT, TYPE_SYNC = range(5)
+TASK_ISR = 0
+ISR_TID_BASE = 1000   # 中断时间线的 tid 为 ISR_TID_BASE + 核心号，与任务编号错开
+
+
+def wrap32(delta):
+    """32 位计数器差值按有符号数解释，容忍轻微乱序与一次回绕。"""
+    delta &= 0xFFFFFFFF
+    return delta - (1 << 32) if delta & 0x80000000 else delta
+
+
+def parse(lines):
+    names, tasks, events, cycles_per_us = {}, {}, {}, None
+    inside = False
+    for line in lines:
+        pos = line.find("TRACE ")
+        if pos < 0:
+            continue
+        parts = line[pos:].split()
+        if parts[1] == "BEGIN":
+            # 只保留最后一次转储
+            names, tasks, events, inside = {}, {}, {}, True
+            kv = dict(p.split("=", 1) for p in parts[2:] if "=" in p)
+            cycles_per_us = float(kv.get("cycles_per_us", 1))
+        elif not inside:
+            continue
+        elif parts[1] == "NAME":
+            names[int(parts[2])] = parts[3]
+        elif parts[1] == "TASK":
+            tasks[int(parts[2])] = parts[3] if len(parts) > 3 else "task%s" % parts[2]
+        elif parts[1] == "EV":
+            core, seq, cyc, typ, ev_id, value = (int(x) for x in parts[2:8])
+            task = int(parts[8]) if len(parts) > 8 else None
+            events.setdefault(core, []).append((seq, cyc, typ, ev_id, value, task))
+        elif parts[1] == "END":
+            inside = False
+    return names, tasks, events, cycles_per_us
+
+
+def core_timeline(raw, cycles_per_us):
+    """把一个核心的周期计数展开为连续值，再用对时事件换算到 esp_timer 微秒。"""
+    raw.sort()
+    timeline, syncs = [], []
+    abs_cyc = abs_us = None
+    for seq, cyc, typ, ev_id, value, task in raw:
+        abs_cyc = cyc if abs_cyc is None else abs_cyc + wrap32(cyc - prev_cyc)
+        prev_cyc = cyc
+        if typ == TYPE_SYNC:
+            abs_us = value & 0xFFFFFFFF if abs_us is None else abs_us + wrap32(value - prev_us)
+            prev_us = value
+            syncs.append((abs_cyc, abs_us))
+            continue
+        timeline.append((abs_cyc, typ, ev_id, value, task))
+
+    out = []
+    k = 0
+    for abs_cyc, typ, ev_id, value, task in timeline:
+        if syncs:
+            # 使用之前最近的对时点，开头没有对时点的事件向后取第一个
+            while k + 1 < len(syncs) and syncs[k + 1][0] <= abs_cyc:
+                k += 1
+            ref_cyc, ref_us = syncs[k]
+            ts = ref_us + (abs_cyc - ref_cyc) / cycles_per_us
+        else:
+            ts = abs_cyc / cycles_per_us
+        out.append((ts, typ, ev_id, value, task))
+    return out
+
+
+def thread_of(core, task, tasks):
+    """事件所属的时间线：任务按编号，中断按核心，旧格式按核心。"""
+    if task is None:
+        return core, "core%d" % core
+    if task == TASK_ISR:
+        return ISR_TID_BASE + core, "isr/core%d" % core
+    return task, tasks.get(task, "task%d" % task)
+
+
+def convert(names, tasks, events, cycles_per_us):
+    trace, threads, depth = [], {}, {}
+    for core, raw in sorted(events.items()):
+        for ts, typ, ev_id, value, task in core_timeline(raw, cycles_per_us):
+            name = names.get(ev_id, "ev%d" % ev_id)
+            tid, thread_name = thread_of(core, task, tasks)
+            threads[tid] = thread_name
+            base = {"name": name, "ts": ts, "pid": 0, "tid": tid}
+            key = (tid, ev_id)
+            if typ == TYPE_BEGIN:
+                depth[key] = depth.get(key, 0) + 1
+                base["ph"] = "B"
+                if value:
+                    base["args"] = {"arg": value}
+            elif typ == TYPE_END:
+                # 环形缓冲区覆盖掉了对应的开始事件
+                if depth.get(key, 0) == 0:
+                    continue
+                depth[key] -= 1
+                base["ph"] = "E"
+            elif typ == TYPE_COUNTER:
+                base.update(ph="C", args={name: value})
+            else:
+                base.update(ph="i", s="t", args={"value": value})
+            trace.append(base)
+    if trace:
+        t0 = min(e["ts"] for e in trace)
+        for e in trace:
+            e["ts"] = round(e["ts"] - t0, 3)
+    # 按 ts 排序：同一任务迁移到另一个核心后，它的事件分散在两个核心的缓冲区里
+    trace.sort(key=lambda e: e["ts"])
+    meta = [{"name": "thread_name", "ph": "M", "pid": 0, "tid": tid, "args": {"name": name}}
+            for tid, name in sorted(threads.items())]
+    return {"traceEvents": meta + trace, "displayTimeUnit": "ns"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("source", help="包含 trace dump 的日志文件")
+    parser.add_argument("-o", "--output", help="JSON 输出路径，默认 stdout")
+    args = parser.parse_args()
+
+    with open(args.source, encoding="utf-8", errors="replace") as f:
+        names, tasks, events, cycles_per_us = parse(f)
+    if not events:
+        sys.exit("no trace dump found in " + args.source)
+    result = convert(names, tasks, events, cycles_per_us)
+    out = open(args.output, "w", encoding="utf-8") if args.output else sys.stdout
+    json.dump(result, out)
+    if args.output:
+        out.close()
+        print("%d events -> %s" % (len(result["traceEvents"]), args.output), file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())